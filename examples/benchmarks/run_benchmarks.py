@@ -0,0 +1,193 @@
+#!/usr/bin/python3
+
+# Copyright Imperas Software Ltd
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http:#www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+#
+# Run the subsystem benchmarks, record simulated MIPS for each benchmark and
+# configuration in a JSON results file and compare with a stored baseline.
+# Exit status is non-zero if any benchmark fails its self-check or runs more
+# than the tolerance slower than the baseline.
+#
+
+import os
+import re
+import sys
+import json
+import time
+import argparse
+import platform
+import subprocess
+
+scriptDir = os.path.dirname(os.path.abspath(__file__))
+rootDir   = os.path.dirname(os.path.dirname(scriptDir))
+hostDir   = 'Windows64' if platform.system() == 'Windows' else 'Linux64'
+
+CPU = 'riscvOVPsim/cpu/'
+
+# options common to all benchmarks
+COMMON = [
+    '--variant', 'RVB64I',
+    '--customcontrol',
+    '--override', CPU + 'defaultsemihost=F',
+    '--override', CPU + 'simulateexceptions=T',
+]
+
+BASE   = ['--override', CPU + 'add_Extensions=MAFDCSU']
+VECTOR = ['--override', CPU + 'add_Extensions=MAFDCVSU',
+          '--override', CPU + 'vector_version=0.9']
+CLIC   = ['--override', CPU + 'CLICLEVELS=256',
+          '--override', CPU + 'mclicbase=0x0c000000']
+
+def vlen(bits):
+    return VECTOR + ['--override', CPU + 'VLEN=%d' % bits]
+
+# (benchmark, configuration, ELF file, simulator options)
+BENCHMARKS = [
+    ('tlb_storm',     'sv39',     'tlb_sv39.elf',      BASE),
+    ('tlb_storm',     'sv48',     'tlb_sv48.elf',      BASE),
+    ('pmp_reprogram', 'pmp16',    'pmp_reprogram.elf', BASE),
+    ('clic_storm',    'clic',     'clic_storm.elf',    BASE + CLIC),
+    ('vector_sew',    'vlen128',  'vector_sew.elf',    vlen(128)),
+    ('vector_sew',    'vlen256',  'vector_sew.elf',    vlen(256)),
+    ('vector_sew',    'vlen512',  'vector_sew.elf',    vlen(512)),
+    ('amo_lrsc',      'harts4',   'amo_lrsc.elf',      BASE + ['--override', CPU + 'numHarts=4']),
+    ('fp_flags',      'default',  'fp_flags.elf',      BASE),
+    ('csr_switch',    'default',  'csr_switch.elf',    BASE),
+    ('syscall_trap',  'mmode',    'syscall_m.elf',     BASE),
+    ('syscall_trap',  'delegate', 'syscall_s.elf',     BASE),
+]
+
+reInstructions = re.compile(r'Simulated instructions:\s*([\d,]+)')
+reMIPS         = re.compile(r'Simulated MIPS\s*:\s*([\d.]+)')
+reElapsed      = re.compile(r'Elapsed time\s*:\s*([\d.]+)')
+
+def parseArgs():
+    parser = argparse.ArgumentParser(description='Run subsystem benchmarks')
+    parser.add_argument('--simulator', default=os.path.join(rootDir, 'bin', hostDir, 'riscvOVPsim.exe'),
+                        help='simulator executable')
+    parser.add_argument('--results', default='results.json',
+                        help='JSON file to write results to')
+    parser.add_argument('--baseline', default=os.path.join(scriptDir, 'baseline.json'),
+                        help='JSON baseline file to compare with')
+    parser.add_argument('--update-baseline', action='store_true',
+                        help='write results to the baseline file as well')
+    parser.add_argument('--tolerance', type=float, default=0.10,
+                        help='allowed fractional MIPS reduction from baseline')
+    parser.add_argument('--repeat', type=int, default=1,
+                        help='runs per benchmark (best MIPS is recorded)')
+    parser.add_argument('--timeout', type=int, default=600,
+                        help='timeout per run in seconds')
+    parser.add_argument('--filter', default='.*',
+                        help='regular expression selecting benchmark/config names')
+    return parser.parse_args()
+
+def runOne(args, elf, options):
+
+    path = os.path.join(scriptDir, elf)
+
+    # ELF files are not supplied and must be built first (see README.md)
+    if not os.path.exists(path):
+        print('%s not found - build the benchmarks using make' % elf)
+        return {'status': 'missing'}
+
+    cmd = [args.simulator] + COMMON + options + ['--program', path]
+
+    start = time.time()
+    try:
+        proc = subprocess.run(
+            cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+            universal_newlines=True, timeout=args.timeout
+        )
+        output = proc.stdout
+    except subprocess.TimeoutExpired:
+        return {'status': 'timeout'}
+    wall = time.time() - start
+
+    result = {'status': 'pass' if 'BENCH PASS' in output else 'fail', 'wall': round(wall, 3)}
+
+    m = reInstructions.search(output)
+    if m:
+        result['instructions'] = int(m.group(1).replace(',', ''))
+    m = reElapsed.search(output)
+    if m:
+        result['seconds'] = float(m.group(1))
+    m = reMIPS.search(output)
+    if m:
+        result['mips'] = float(m.group(1))
+    elif 'instructions' in result and wall > 0:
+        result['mips'] = round(result['instructions'] / wall / 1e6, 1)
+
+    return result
+
+def main():
+
+    args    = parseArgs()
+    select  = re.compile(args.filter)
+    results = {}
+
+    for (bench, config, elf, options) in BENCHMARKS:
+
+        key = bench + '/' + config
+        if not select.search(key):
+            continue
+
+        best = None
+        for i in range(args.repeat):
+            result = runOne(args, elf, options)
+            if result['status'] != 'pass':
+                best = result
+                break
+            if not best or result.get('mips', 0) > best.get('mips', 0):
+                best = result
+
+        results[key] = best
+        print('%-26s %-8s %10s MIPS' % (key, best['status'], best.get('mips', '-')))
+
+    report = {
+        'host'    : platform.node(),
+        'platform': platform.platform(),
+        'date'    : time.strftime('%Y-%m-%d %H:%M:%S'),
+        'results' : results,
+    }
+
+    with open(args.results, 'w') as f:
+        json.dump(report, f, indent=4, sort_keys=True)
+
+    if args.update_baseline:
+        with open(args.baseline, 'w') as f:
+            json.dump(report, f, indent=4, sort_keys=True)
+
+    # check self-check failures and regressions against baseline
+    errors = [k for k, r in results.items() if r['status'] != 'pass']
+    for k in errors:
+        print('FAILED     %s (%s)' % (k, results[k]['status']))
+
+    if os.path.exists(args.baseline) and not args.update_baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f).get('results', {})
+        for k, r in sorted(results.items()):
+            if k not in baseline or 'mips' not in baseline[k] or 'mips' not in r:
+                continue
+            old   = baseline[k]['mips']
+            new   = r['mips']
+            limit = old * (1.0 - args.tolerance)
+            if new < limit:
+                print('REGRESSION %s: %.1f MIPS (baseline %.1f)' % (k, new, old))
+                errors.append(k)
+
+    return 1 if errors else 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -72,11 +72,16 @@ typedef enum riscvTZE {
 } riscvTZ;
 
 //
-// This subdivides the polymorphic key into parts used by the vector extension
-// and transaction mode
+// This subdivides the polymorphic key into parts used by the vector extension,
+// Machine mode accesses with mstatus.MPRV set, function profiling and
+// transaction mode
 //
 typedef enum riscvPMKE {
     PMK_VECTOR      = 0x03ff,
+    PMK_MPRV_MODE   = 0x0c00,
+    PMK_MPRV_VM     = 0x1000,
+    PMK_MPRV        = 0x2000,
+    PMK_PROFILE     = 0x4000,
     PMK_TRANSACTION = 0x8000,
 } riscvPMK;
 
@@ -94,6 +99,14 @@ typedef struct riscvBlockStateS {
     riscvVLClassMt   VLClassMt;     // known active vector VL zero/non-zero/max
     Uns32            VZeroTopMt[2]; // known vector registers with zero top
     Bool             VStartZeroMt;  // vstart known to be zero?
+    Uns64            fetchLineMt;   // last cache line fetched in block
+    Bool             MPRVKeyMt;     // is mstatus.MPRV key validated in block?
+    Uns32            cosimXMaskMt;  // X registers written by last instruction
+    Uns32            cosimFMaskMt;  // F registers written by last instruction
+    Bool             cosimMaskMt;   // are last instruction masks known?
+    Uns32            morphInstrs;   // instructions morphed in block
+    Uns64            morphStartNs;  // host time at start of block translation
+    riscvMixBlockP   mixBlockMt;    // opcode mix record for block
 
 } riscvBlockState;
 
@@ -0,0 +1,1034 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// standard header files
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Imperas header files
+#include "hostapi/impAlloc.h"
+
+// VMI header files
+#include "vmi/vmiMessage.h"
+#include "vmi/vmiRt.h"
+
+// model header files
+#include "riscvBranch.h"
+#include "riscvMessage.h"
+#include "riscvParameters.h"
+#include "riscvStructure.h"
+#include "riscvVariant.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Number of trace bytes buffered before they are written to the trace file
+//
+#define BRANCH_BUFFER_SIZE  4096
+
+//
+// Depth of the return address stack used for implicit return compression
+//
+#define BRANCH_TRACE_RAS    32
+
+//
+// Number of branches shown in the predictor report
+//
+#define BRANCH_REPORT_NUM   32
+
+//
+// Simplified TAGE configuration (tagged tables use geometric history lengths)
+//
+#define TAGE_TABLES         3
+#define TAGE_TAG_BITS       9
+#define TAGE_HIST_BASE      8
+#define TAGE_TAG_INVALID    0xffff
+
+//
+// Branch trace packet headers
+//
+typedef enum branchPacketE {
+    BP_MAP      = 0x00,     // 0x00-0x1f: 1-32 outcome bits follow
+    BP_INDIRECT = 0x20,     // ULEB128 (target XOR previous target) follows
+    BP_SYNC     = 0x21,     // ULEB128 new PC follows
+    BP_TRAP     = 0x22,     // ULEB128 cause, EPC and tval follow
+} branchPacket;
+
+DEFINE_S(branchStats);
+DEFINE_S(branchTrace);
+DEFINE_S(tageEntry);
+
+//
+// Predictor statistics for one branch, identified by its address
+//
+typedef struct branchStatsS {
+    branchStatsP next;          // next branch in creation order
+    Uns64        PC;            // branch address
+    Uns64        execs;         // number of executions
+    Uns64        mispredicts;   // number of mispredictions
+} branchStats;
+
+//
+// Branch trace encoder state
+//
+typedef struct branchTraceS {
+    riscvP riscv;                       // hart (holds pending outcome bits)
+    FILE  *file;                        // trace file
+    char  *path;                        // trace file name
+    Uns64  written;                     // bytes written to trace file
+    Uns64  lastTarget;                  // last explicit target address
+    Uns32  rasNum;                      // valid return address stack entries
+    Uns32  rasTop;                      // return address stack top index
+    Uns32  used;                        // bytes used in buffer
+    Uns64  ras[BRANCH_TRACE_RAS];       // return address stack
+    Uns8   buffer[BRANCH_BUFFER_SIZE];  // trace buffer
+} branchTrace;
+
+//
+// Simplified TAGE tagged table entry
+//
+typedef struct tageEntryS {
+    Uns16 tag;                  // partial tag (TAGE_TAG_INVALID if unused)
+    Int8  ctr;                  // 3-bit signed prediction counter
+    Uns8  useful;               // 2-bit usefulness counter
+} tageEntry;
+
+//
+// Branch trace and predictor state for one hart
+//
+typedef struct riscvBranchS {
+
+    // branch trace
+    branchTraceP         trace;         // trace encoder (0 if disabled)
+
+    // predictor configuration
+    riscvBranchPredictor predictor;     // conditional predictor model
+    Uns32                indexBits;     // log2 predictor table entries
+    Uns32                rasDepth;      // return address stack depth
+
+    // predictor state
+    Uns64                history;       // global branch history
+    Uns8                *pht;           // 2-bit counters
+    Uns64               *btb;           // indirect target buffer
+    tageEntryP           tage[TAGE_TABLES];
+    Uns64               *ras;           // return address stack
+    Uns32                rasNum;        // valid return address stack entries
+    Uns32                rasTop;        // return address stack top index
+
+    // predictor statistics
+    vmiRangeTableP       statsTable;    // branches indexed by address
+    branchStatsP         statsFirst;    // first branch in creation order
+    branchStatsP         statsLast;     // last branch in creation order
+    Uns64                condExecs;     // conditional branches
+    Uns64                condMisses;    // mispredicted conditional branches
+    Uns64                indExecs;      // indirect jumps and calls
+    Uns64                indMisses;     // mispredicted indirect jumps and calls
+    Uns64                retExecs;      // returns
+    Uns64                retMisses;     // mispredicted returns
+
+} riscvBranch;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// BRANCH TRACE ENCODER
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Write buffered trace bytes to the trace file
+//
+static void flushTraceBuffer(branchTraceP trace) {
+
+    if(trace->used) {
+        fwrite(trace->buffer, 1, trace->used, trace->file);
+        trace->written += trace->used;
+        trace->used     = 0;
+    }
+}
+
+//
+// Ensure there is space for a packet of the given maximum size in the buffer
+//
+static void reserveTraceBuffer(branchTraceP trace, Uns32 bytes) {
+
+    if((trace->used+bytes) > BRANCH_BUFFER_SIZE) {
+        flushTraceBuffer(trace);
+    }
+}
+
+//
+// Append a byte to the trace buffer
+//
+inline static void putTraceByte(branchTraceP trace, Uns8 byte) {
+    trace->buffer[trace->used++] = byte;
+}
+
+//
+// Append an unsigned LEB128 value to the trace buffer
+//
+static void putTraceULEB(branchTraceP trace, Uns64 value) {
+
+    do {
+
+        Uns8 byte = value & 0x7f;
+
+        value >>= 7;
+
+        putTraceByte(trace, value ? (byte|0x80) : byte);
+
+    } while(value);
+}
+
+//
+// Emit any pending outcome bits as a branch map packet (outcome bits are held
+// in the processor structure so that JIT code can accumulate them inline)
+//
+static void flushTraceMap(branchTraceP trace) {
+
+    riscvP riscv = trace->riscv;
+    Uns32  num   = riscv->branchMapNum;
+
+    if(num) {
+
+        Uns32 bits = riscv->branchMapBits;
+        Uns32 i;
+
+        reserveTraceBuffer(trace, 1+(RISCV_BRANCH_MAP_MAX/8));
+
+        putTraceByte(trace, BP_MAP|(num-1));
+
+        for(i=0; i<num; i+=8) {
+            putTraceByte(trace, bits>>i);
+        }
+
+        riscv->branchMapBits = 0;
+        riscv->branchMapNum  = 0;
+    }
+}
+
+//
+// Record one outcome bit in the branch map
+//
+static void traceOutcome(branchTraceP trace, Bool outcome) {
+
+    riscvP riscv = trace->riscv;
+
+    riscv->branchMapBits |= (Uns32)outcome << riscv->branchMapNum;
+
+    if(++riscv->branchMapNum==RISCV_BRANCH_MAP_MAX) {
+        flushTraceMap(trace);
+    }
+}
+
+//
+// Emit a packet with an address operand, after any pending branch map
+//
+static void traceAddress(branchTraceP trace, branchPacket type, Uns64 value) {
+
+    flushTraceMap(trace);
+
+    reserveTraceBuffer(trace, 11);
+
+    putTraceByte(trace, type);
+    putTraceULEB(trace, value);
+}
+
+//
+// Emit an explicit indirect target
+//
+static void traceTarget(branchTraceP trace, Uns64 target) {
+
+    traceAddress(trace, BP_INDIRECT, target ^ trace->lastTarget);
+
+    trace->lastTarget = target;
+}
+
+//
+// Emit a new PC following a discontinuity
+//
+static void traceSync(branchTraceP trace, Uns64 PC) {
+
+    traceAddress(trace, BP_SYNC, PC);
+
+    trace->lastTarget = PC;
+}
+
+//
+// Emit the cause, EPC and tval of a trap (the handler address follows in a
+// separate sync packet)
+//
+static void traceTrap(branchTraceP trace, Uns64 cause, Uns64 EPC, Uns64 tval) {
+
+    flushTraceMap(trace);
+
+    reserveTraceBuffer(trace, 31);
+
+    putTraceByte(trace, BP_TRAP);
+    putTraceULEB(trace, cause);
+    putTraceULEB(trace, EPC);
+    putTraceULEB(trace, tval);
+}
+
+//
+// Push a link address on the trace return address stack
+//
+static void tracePush(branchTraceP trace, Uns64 linkPC) {
+
+    trace->rasTop = (trace->rasTop+1) % BRANCH_TRACE_RAS;
+    trace->ras[trace->rasTop] = linkPC;
+
+    if(trace->rasNum<BRANCH_TRACE_RAS) {
+        trace->rasNum++;
+    }
+}
+
+//
+// Record a return: the target is implicit (a single 1 outcome bit) if it
+// matches the trace return address stack, otherwise a 0 outcome bit is
+// followed by an explicit target
+//
+static void traceReturn(branchTraceP trace, Uns64 target) {
+
+    Bool implicit = trace->rasNum && (trace->ras[trace->rasTop]==target);
+
+    // pop the return address stack if it is not empty
+    if(trace->rasNum) {
+        trace->rasTop = (trace->rasTop+BRANCH_TRACE_RAS-1) % BRANCH_TRACE_RAS;
+        trace->rasNum--;
+    }
+
+    traceOutcome(trace, implicit);
+
+    if(!implicit) {
+        traceTarget(trace, target);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// BRANCH PREDICTOR MODELS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return predictor table index for the given address
+//
+inline static Uns32 getPCIndex(riscvBranchP branch, Uns64 PC) {
+    return (PC>>1) & ((1<<branch->indexBits)-1);
+}
+
+//
+// Update a 2-bit saturating counter
+//
+inline static void updateCounter2(Uns8 *ctr, Bool taken) {
+
+    if(taken) {
+        if(*ctr<3) (*ctr)++;
+    } else {
+        if(*ctr>0) (*ctr)--;
+    }
+}
+
+//
+// Fold the given number of history bits into a value of the given width
+//
+static Uns32 foldHistory(Uns64 history, Uns32 length, Uns32 bits) {
+
+    Uns32 result = 0;
+
+    if(length<64) {
+        history &= (1ULL<<length)-1;
+    }
+
+    while(history) {
+        result  ^= history & ((1<<bits)-1);
+        history >>= bits;
+    }
+
+    return result;
+}
+
+//
+// Return log2 of the number of entries in each TAGE tagged table
+//
+inline static Uns32 getTageBits(riscvBranchP branch) {
+    return branch->indexBits-1;
+}
+
+//
+// Return index into the given TAGE tagged table
+//
+static Uns32 getTageIndex(riscvBranchP branch, Uns32 t, Uns64 PC) {
+
+    Uns32 bits   = getTageBits(branch);
+    Uns32 length = TAGE_HIST_BASE<<t;
+
+    return ((PC>>1) ^ (PC>>(bits+1)) ^ foldHistory(branch->history, length, bits))
+        & ((1<<bits)-1);
+}
+
+//
+// Return tag for the given TAGE tagged table
+//
+static Uns16 getTageTag(riscvBranchP branch, Uns32 t, Uns64 PC) {
+
+    Uns32 length = TAGE_HIST_BASE<<t;
+    Uns32 tag    = (PC>>1) ^ foldHistory(branch->history, length, TAGE_TAG_BITS);
+
+    return tag & ((1<<TAGE_TAG_BITS)-1);
+}
+
+//
+// Predict and update a conditional branch using the simplified TAGE model,
+// returning the prediction
+//
+static Bool predictTAGE(riscvBranchP branch, Uns64 PC, Bool taken) {
+
+    Uns8      *base     = &branch->pht[getPCIndex(branch, PC)];
+    Bool       basePred = *base>=2;
+    tageEntryP entries[TAGE_TABLES];
+    Uns16      tags[TAGE_TABLES];
+    Int32      provider = -1;
+    Int32      alt      = -1;
+    Bool       pred;
+    Bool       altPred;
+    Int32      t;
+
+    // find the longest (provider) and next-longest (alternate) tag matches
+    for(t=TAGE_TABLES-1; t>=0; t--) {
+
+        entries[t] = &branch->tage[t][getTageIndex(branch, t, PC)];
+        tags[t]    = getTageTag(branch, t, PC);
+
+        if(entries[t]->tag!=tags[t]) {
+            // no match
+        } else if(provider<0) {
+            provider = t;
+        } else if(alt<0) {
+            alt = t;
+        }
+    }
+
+    altPred = (alt<0) ? basePred : (entries[alt]->ctr>=0);
+    pred    = (provider<0) ? basePred : (entries[provider]->ctr>=0);
+
+    if(provider<0) {
+
+        // base predictor provided the prediction
+        updateCounter2(base, taken);
+
+    } else {
+
+        tageEntryP entry = entries[provider];
+
+        // update usefulness when the provider differs from the alternate
+        if(pred==altPred) {
+            // no action
+        } else if(pred==taken) {
+            if(entry->useful<3) entry->useful++;
+        } else {
+            if(entry->useful>0) entry->useful--;
+        }
+
+        // update the provider counter
+        if(taken) {
+            if(entry->ctr<3) entry->ctr++;
+        } else {
+            if(entry->ctr>-4) entry->ctr--;
+        }
+    }
+
+    // allocate an entry in a longer-history table on a misprediction
+    if(pred!=taken) {
+
+        Bool allocated = False;
+
+        for(t=provider+1; !allocated && (t<TAGE_TABLES); t++) {
+
+            tageEntryP entry = entries[t];
+
+            if(!entry->useful) {
+                entry->tag = tags[t];
+                entry->ctr = taken ? 0 : -1;
+                allocated  = True;
+            }
+        }
+
+        // age usefulness if no entry could be allocated
+        for(t=provider+1; !allocated && (t<TAGE_TABLES); t++) {
+            entries[t]->useful--;
+        }
+    }
+
+    return pred;
+}
+
+//
+// Predict and update a conditional branch, returning the prediction
+//
+static Bool predictCond(riscvBranchP branch, Uns64 PC, Bool taken) {
+
+    Uns32 index = getPCIndex(branch, PC);
+    Bool  pred;
+
+    if(branch->predictor==RVBP_TAGE) {
+        return predictTAGE(branch, PC, taken);
+    } else if(branch->predictor==RVBP_GSHARE) {
+        index = (index ^ branch->history) & ((1<<branch->indexBits)-1);
+    }
+
+    pred = branch->pht[index]>=2;
+    updateCounter2(&branch->pht[index], taken);
+
+    return pred;
+}
+
+//
+// Push a link address on the predictor return address stack
+//
+static void predictPush(riscvBranchP branch, Uns64 linkPC) {
+
+    if(branch->rasDepth) {
+
+        branch->rasTop = (branch->rasTop+1) % branch->rasDepth;
+        branch->ras[branch->rasTop] = linkPC;
+
+        if(branch->rasNum<branch->rasDepth) {
+            branch->rasNum++;
+        }
+    }
+}
+
+//
+// Predict a return using the return address stack, returning a Boolean
+// indicating whether the prediction was correct
+//
+static Bool predictReturn(riscvBranchP branch, Uns64 target) {
+
+    Bool correct = branch->rasNum && (branch->ras[branch->rasTop]==target);
+
+    if(branch->rasNum) {
+        branch->rasTop = (branch->rasTop+branch->rasDepth-1) % branch->rasDepth;
+        branch->rasNum--;
+    }
+
+    return correct;
+}
+
+//
+// Predict an indirect jump or call using the target buffer, returning a
+// Boolean indicating whether the prediction was correct
+//
+static Bool predictIndirect(riscvBranchP branch, Uns64 PC, Uns64 target) {
+
+    Uns64 *entry   = &branch->btb[getPCIndex(branch, PC)];
+    Bool   correct = (*entry==target);
+
+    *entry = target;
+
+    return correct;
+}
+
+//
+// Return statistics for the branch at the given address, creating them if
+// required
+//
+static branchStatsP getBranchStats(riscvBranchP branch, Uns64 PC) {
+
+    vmiRangeTablePP tableP = &branch->statsTable;
+    vmiRangeEntryP  entry  = vmirtGetFirstRangeEntry(tableP, PC, PC);
+    branchStatsP    stats;
+
+    if(entry) {
+
+        stats = (branchStatsP)(UnsPS)vmirtGetRangeEntryUserData(entry);
+
+    } else {
+
+        stats = STYPE_CALLOC(branchStats);
+
+        stats->PC = PC;
+
+        // append to list in creation order
+        if(branch->statsLast) {
+            branch->statsLast->next = stats;
+        } else {
+            branch->statsFirst = stats;
+        }
+
+        branch->statsLast = stats;
+
+        vmirtInsertRangeEntry(tableP, PC, PC, (UnsPS)stats);
+    }
+
+    return stats;
+}
+
+//
+// Record the result of a prediction for a branch
+//
+static void recordPrediction(branchStatsP stats, Bool correct) {
+
+    stats->execs++;
+
+    if(!correct) {
+        stats->mispredicts++;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// JIT CODE CALLBACKS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return predictor statistics for the branch at the given address, or NULL if
+// there is no predictor model (called when code is translated, so that JIT
+// callbacks do not need to look up the branch)
+//
+riscvBranchStatsP riscvBranchGetStats(riscvP riscv, Uns64 PC) {
+
+    riscvBranchP branch = riscv->branch;
+
+    return branch->predictor ? getBranchStats(branch, PC) : 0;
+}
+
+//
+// Does the hart have a branch predictor model?
+//
+Bool riscvBranchHasPredictor(riscvP riscv) {
+    return riscv->branch->predictor && True;
+}
+
+//
+// Emit the branch map of conditional outcomes accumulated in JIT code (called
+// from JIT code when RISCV_BRANCH_MAP_MAX outcomes are pending)
+//
+void riscvBranchFlushMap(riscvP riscv) {
+    flushTraceMap(riscv->branch->trace);
+}
+
+//
+// Record a conditional branch outcome when there is a predictor model (called
+// from JIT code; without a predictor, outcomes are accumulated inline)
+//
+void riscvBranchCond(riscvP riscv, riscvBranchStatsP stats, Uns8 taken) {
+
+    riscvBranchP branch = riscv->branch;
+    Bool         isTaken = taken ? True : False;
+
+    if(branch->trace) {
+        traceOutcome(branch->trace, isTaken);
+    }
+
+    if(branch->predictor) {
+
+        Bool correct = predictCond(branch, stats->PC, isTaken)==isTaken;
+
+        branch->condExecs++;
+        branch->condMisses += !correct;
+        branch->history     = (branch->history<<1) | isTaken;
+
+        recordPrediction(stats, correct);
+    }
+}
+
+//
+// Record a direct call with the given link address (called from JIT code)
+//
+void riscvBranchCall(riscvP riscv, Uns64 linkPC) {
+
+    riscvBranchP branch = riscv->branch;
+
+    if(branch->trace) {
+        tracePush(branch->trace, linkPC);
+    }
+
+    if(branch->predictor) {
+        predictPush(branch, linkPC);
+    }
+}
+
+//
+// Record an indirect jump, call or return (called from JIT code)
+//
+void riscvBranchIndirect(
+    riscvP            riscv,
+    riscvBranchStatsP stats,
+    Uns64             target,
+    Uns64             linkPC,
+    riscvBranchKind   kind
+) {
+    riscvBranchP branch = riscv->branch;
+
+    target &= -2;
+
+    if(!branch->trace) {
+
+        // no action
+
+    } else if(kind==RVBK_RETURN) {
+
+        traceReturn(branch->trace, target);
+
+    } else {
+
+        traceTarget(branch->trace, target);
+
+        if(kind==RVBK_CALL) {
+            tracePush(branch->trace, linkPC);
+        }
+    }
+
+    if(!branch->predictor) {
+
+        // no action
+
+    } else if((kind==RVBK_RETURN) && branch->rasDepth) {
+
+        Bool correct = predictReturn(branch, target);
+
+        branch->retExecs++;
+        branch->retMisses += !correct;
+
+        recordPrediction(stats, correct);
+
+    } else {
+
+        Bool correct = predictIndirect(branch, stats->PC, target);
+
+        branch->indExecs++;
+        branch->indMisses += !correct;
+
+        recordPrediction(stats, correct);
+
+        if(kind==RVBK_CALL) {
+            predictPush(branch, linkPC);
+        }
+    }
+}
+
+//
+// Record a discontinuity in program flow caused by an exception, interrupt or
+// exception return
+//
+void riscvBranchSync(riscvP riscv, Uns64 newPC) {
+
+    riscvBranchP branch = riscv->branch;
+
+    if(branch->trace) {
+        traceSync(branch->trace, newPC);
+    }
+}
+
+//
+// Record the cause, EPC and tval of a trap (the handler address is recorded
+// by a following call to riscvBranchSync)
+//
+void riscvBranchTrap(
+    riscvP riscv,
+    Bool   isInt,
+    Uns32  ecode,
+    Uns64  EPC,
+    Uns64  tval
+) {
+    riscvBranchP branch = riscv->branch;
+
+    if(branch->trace) {
+        traceTrap(branch->trace, ((Uns64)ecode<<1) | isInt, EPC, tval);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// REPORTING
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Compare branches by misprediction count (descending)
+//
+static int compareBranchStats(const void *a, const void *b) {
+
+    branchStatsP statsA = *(branchStatsP*)a;
+    branchStatsP statsB = *(branchStatsP*)b;
+
+    return (statsA->mispredicts<statsB->mispredicts) -
+           (statsA->mispredicts>statsB->mispredicts);
+}
+
+//
+// Print one summary line of the predictor report
+//
+static void printBranchSummary(const char *name, Uns64 execs, Uns64 misses) {
+
+    char execStr[32];
+    char missStr[32];
+
+    snprintf(execStr, sizeof(execStr), FMT_64u, execs);
+    snprintf(missStr, sizeof(missStr), FMT_64u, misses);
+
+    vmiPrintf(
+        "  %-12s %16s  %16s  %6.2f%%\n",
+        name, execStr, missStr, execs ? (100.0*misses)/execs : 0.0
+    );
+}
+
+//
+// Print predictor statistics, including the branches with the most
+// mispredictions
+//
+static void printBranchStats(riscvP riscv) {
+
+    riscvBranchP branch = riscv->branch;
+    Uns32        num    = 0;
+    branchStatsP stats;
+    Uns32        i;
+
+    // count branches
+    for(stats=branch->statsFirst; stats; stats=stats->next) {
+        num++;
+    }
+
+    // sort branches by misprediction count
+    branchStatsP sorted[num ? : 1];
+
+    for(stats=branch->statsFirst, i=0; stats; stats=stats->next, i++) {
+        sorted[i] = stats;
+    }
+
+    qsort(sorted, num, sizeof(sorted[0]), compareBranchStats);
+
+    vmiPrintf(
+        "Branch predictor statistics for %s:\n"
+        "  type                    branches       mispredicts  miss rate\n",
+        vmirtProcessorName((vmiProcessorP)riscv)
+    );
+
+    printBranchSummary("conditional", branch->condExecs, branch->condMisses);
+    printBranchSummary("indirect",    branch->indExecs,  branch->indMisses);
+    printBranchSummary("return",      branch->retExecs,  branch->retMisses);
+
+    vmiPrintf(
+        "  PC                      branches       mispredicts  miss rate\n"
+    );
+
+    for(i=0; (i<num) && (i<BRANCH_REPORT_NUM) && sorted[i]->mispredicts; i++) {
+
+        char PC[32];
+
+        stats = sorted[i];
+
+        snprintf(PC, sizeof(PC), "0x"FMT_Ax, stats->PC);
+
+        printBranchSummary(PC, stats->execs, stats->mispredicts);
+    }
+}
+
+//
+// Print branch predictor statistics command
+//
+static VMIRT_COMMAND_PARSE_FN(branchReportCommand) {
+
+    printBranchStats((riscvP)processor);
+
+    return "1";
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION AND DESTRUCTION
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Allocate branch trace encoder, returning NULL if the trace file cannot be
+// opened
+//
+static branchTraceP newBranchTrace(riscvP riscv, const char *file) {
+
+    const char  *name  = vmirtProcessorName((vmiProcessorP)riscv);
+    Uns32        len   = strlen(file) + strlen(name) + 2;
+    branchTraceP trace = STYPE_CALLOC(branchTrace);
+
+    trace->riscv = riscv;
+
+    // construct per-hart file name
+    trace->path = STYPE_CALLOC_N(char, len);
+    snprintf(trace->path, len, "%s.%s", file, name);
+
+    if(!(trace->file=fopen(trace->path, "wb"))) {
+
+        vmiMessage("W", CPU_PREFIX"_BTO",
+            NO_SRCREF_FMT "Cannot open branch trace file '%s'",
+            NO_SRCREF_ARGS(riscv), trace->path
+        );
+
+        STYPE_FREE(trace->path);
+        STYPE_FREE(trace);
+
+        trace = 0;
+
+    } else {
+
+        // start trace from the current PC
+        traceSync(trace, vmirtGetPC((vmiProcessorP)riscv));
+    }
+
+    return trace;
+}
+
+//
+// Flush and free branch trace encoder
+//
+static void freeBranchTrace(riscvP riscv, branchTraceP trace) {
+
+    flushTraceMap(trace);
+    flushTraceBuffer(trace);
+    fclose(trace->file);
+
+    if(riscv->verbose) {
+        vmiMessage("I", CPU_PREFIX"_BTW",
+            NO_SRCREF_FMT "Branch trace of "FMT_64u" bytes written to '%s'",
+            NO_SRCREF_ARGS(riscv), trace->written, trace->path
+        );
+    }
+
+    STYPE_FREE(trace->path);
+    STYPE_FREE(trace);
+}
+
+//
+// Allocate branch trace and predictor structures if required
+//
+void riscvNewBranch(riscvP riscv, riscvParamValuesP params) {
+
+    const char *file = params->branch_trace;
+
+    if(file[0] || params->branch_predictor) {
+
+        riscvBranchP branch = STYPE_CALLOC(riscvBranch);
+
+        riscv->branch = branch;
+
+        // allocate trace encoder if required
+        if(file[0]) {
+            branch->trace = newBranchTrace(riscv, file);
+        }
+
+        // allocate predictor model if required
+        if(params->branch_predictor) {
+
+            Uns32 entries = 1<<params->branch_predictor_bits;
+            Uns32 i;
+
+            branch->predictor = params->branch_predictor;
+            branch->indexBits = params->branch_predictor_bits;
+            branch->rasDepth  = params->branch_ras_depth;
+            branch->pht       = STYPE_CALLOC_N(Uns8,  entries);
+            branch->btb       = STYPE_CALLOC_N(Uns64, entries);
+
+            // counters are initially weakly not-taken
+            for(i=0; i<entries; i++) {
+                branch->pht[i] = 1;
+            }
+
+            // allocate simplified TAGE tagged tables if required
+            if(branch->predictor==RVBP_TAGE) {
+                Uns32 tageEntries = 1<<getTageBits(branch);
+                Uns32 j;
+
+                for(i=0; i<TAGE_TABLES; i++) {
+
+                    branch->tage[i] = STYPE_CALLOC_N(tageEntry, tageEntries);
+
+                    // entries are initially unused and never match a tag
+                    for(j=0; j<tageEntries; j++) {
+                        branch->tage[i][j].tag = TAGE_TAG_INVALID;
+                    }
+                }
+            }
+
+            // allocate return address stack if required
+            if(branch->rasDepth) {
+                branch->ras = STYPE_CALLOC_N(Uns64, branch->rasDepth);
+            }
+
+            vmirtNewRangeTable(&branch->statsTable);
+
+            // install predictor report command
+            vmirtAddCommandParse(
+                (vmiProcessorP)riscv,
+                "branchReport",
+                "show branch predictor statistics",
+                branchReportCommand,
+                VMI_CT_QUERY|VMI_CO_DIAG|VMI_CA_REPORT
+            );
+        }
+    }
+}
+
+//
+// Flush any branch trace, report predictor statistics if required and free
+// branch trace and predictor structures
+//
+void riscvFreeBranch(riscvP riscv) {
+
+    riscvBranchP branch = riscv->branch;
+
+    if(branch) {
+
+        if(branch->trace) {
+            freeBranchTrace(riscv, branch->trace);
+        }
+
+        if(branch->predictor) {
+
+            branchStatsP stats;
+            branchStatsP next;
+            Uns32        i;
+
+            printBranchStats(riscv);
+
+            for(stats=branch->statsFirst; stats; stats=next) {
+                next = stats->next;
+                STYPE_FREE(stats);
+            }
+
+            for(i=0; i<TAGE_TABLES; i++) {
+                if(branch->tage[i]) {
+                    STYPE_FREE(branch->tage[i]);
+                }
+            }
+
+            if(branch->ras) {
+                STYPE_FREE(branch->ras);
+            }
+
+            vmirtFreeRangeTable(&branch->statsTable);
+            STYPE_FREE(branch->pht);
+            STYPE_FREE(branch->btb);
+        }
+
+        STYPE_FREE(branch);
+
+        riscv->branch = 0;
+    }
+}
+
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+// basic types
+#include "hostapi/impTypes.h"
+
+// model header files
+#include "riscvTypeRefs.h"
+
+
+//
+// Indirect control transfer types
+//
+typedef enum riscvBranchKindE {
+    RVBK_JUMP,                          // indirect jump
+    RVBK_CALL,                          // indirect call
+    RVBK_RETURN,                        // function return
+} riscvBranchKind;
+
+//
+// Maximum number of conditional outcomes in one branch map packet
+//
+#define RISCV_BRANCH_MAP_MAX 32
+
+//
+// Opaque predictor statistics for one branch
+//
+typedef struct branchStatsS *riscvBranchStatsP;
+
+//
+// Allocate branch trace and predictor structures if required
+//
+void riscvNewBranch(riscvP riscv, riscvParamValuesP params);
+
+//
+// Flush any branch trace, report predictor statistics if required and free
+// branch trace and predictor structures
+//
+void riscvFreeBranch(riscvP riscv);
+
+//
+// Return predictor statistics for the branch at the given address, or NULL if
+// there is no predictor model (called when code is translated)
+//
+riscvBranchStatsP riscvBranchGetStats(riscvP riscv, Uns64 PC);
+
+//
+// Does the hart have a branch predictor model?
+//
+Bool riscvBranchHasPredictor(riscvP riscv);
+
+//
+// Emit the branch map of conditional outcomes accumulated in JIT code (called
+// from JIT code when RISCV_BRANCH_MAP_MAX outcomes are pending)
+//
+void riscvBranchFlushMap(riscvP riscv);
+
+//
+// Record a conditional branch outcome (called from JIT code)
+//
+void riscvBranchCond(riscvP riscv, riscvBranchStatsP stats, Uns8 taken);
+
+//
+// Record a direct call with the given link address (called from JIT code)
+//
+void riscvBranchCall(riscvP riscv, Uns64 linkPC);
+
+//
+// Record an indirect jump, call or return (called from JIT code)
+//
+void riscvBranchIndirect(
+    riscvP            riscv,
+    riscvBranchStatsP stats,
+    Uns64             target,
+    Uns64             linkPC,
+    riscvBranchKind   kind
+);
+
+//
+// Record a discontinuity in program flow caused by an exception, interrupt or
+// exception return
+//
+void riscvBranchSync(riscvP riscv, Uns64 newPC);
+
+//
+// Record the cause, EPC and tval of a trap (the handler address is recorded
+// by a following call to riscvBranchSync)
+//
+void riscvBranchTrap(
+    riscvP riscv,
+    Bool   isInt,
+    Uns32  ecode,
+    Uns64  EPC,
+    Uns64  tval
+);
+
@@ -62,6 +62,13 @@ typedef union riscvCLICIntStateU {
     Uns32 value32;
 } riscvCLICIntState;
 
+//
+// Interrupt state is allocated in blocks of this many interrupts (one ipe
+// word) when any interrupt in the block is first configured; interrupts in
+// unallocated blocks share the default state held in the root
+//
+#define CLIC_BLOCK_INTS 64
+
 //
 // Return page type name
 //
@@ -243,11 +250,62 @@ static Uns32 getCLICIntCtl1Bits(riscvP hart) {
     return ((1<<(8-CLICINTCTLBITS))-1);
 }
 
+//
+// Return the state block holding the indexed interrupt, or NULL if all
+// interrupts in that block have default state
+//
+inline static riscvCLICIntStateP getCLICIntBlock(riscvP hart, Uns32 intIndex) {
+    return hart->clic.intBlocks[intIndex/CLIC_BLOCK_INTS];
+}
+
+//
+// Return the state of the indexed interrupt
+//
+inline static riscvCLICIntState getCLICIntState(riscvP hart, Uns32 intIndex) {
+
+    riscvCLICIntStateP block = getCLICIntBlock(hart, intIndex);
+
+    if(block) {
+        return block[intIndex%CLIC_BLOCK_INTS];
+    } else {
+        return (riscvCLICIntState){value32:hart->smpRoot->clic.intDefault};
+    }
+}
+
+//
+// Allocate the indexed interrupt state block, initialized to default state,
+// and add it to the ordered list of active blocks
+//
+static riscvCLICIntStateP newCLICIntBlock(riscvP hart, Uns32 blockIndex) {
+
+    Uns32 *activeBlocks = hart->clic.activeBlocks;
+    Uns32  i            = hart->clic.numActive++;
+
+    riscvCLICIntStateP block = STYPE_CALLOC_N(
+        riscvCLICIntState, CLIC_BLOCK_INTS
+    );
+
+    // insert block index in ascending order so that scans are in interrupt
+    // order
+    for(; i && (activeBlocks[i-1]>blockIndex); i--) {
+        activeBlocks[i] = activeBlocks[i-1];
+    }
+
+    activeBlocks[i] = blockIndex;
+
+    // initialize all interrupts in the block to default state
+    for(i=0; i<CLIC_BLOCK_INTS; i++) {
+        block[i].value32 = hart->smpRoot->clic.intDefault;
+    }
+
+    return hart->clic.intBlocks[blockIndex] = block;
+}
+
 //
 // Return the composed value for the indexed interrupt
 //
 inline static Uns32 getCLICInterruptValue(riscvP hart, Uns32 index) {
-    return hart->clic.intState[index].value32;
+    return getCLICIntState(hart, index).value32;
 }
 
 //
@@ -258,35 +316,46 @@ inline static Uns8 getCLICInterruptField(
     Uns32            intIndex,
     CLICIntFieldType type
 ) {
-    return hart->clic.intState[intIndex].fields[type];
+    return getCLICIntState(hart, intIndex).fields[type];
 }
 
 //
-// Set the indicated field for the indexed interrupt
+// Set the indicated field for the indexed interrupt (the state block is
+// allocated only when a field first takes a non-default value)
 //
-inline static void setCLICInterruptField(
+static void setCLICInterruptField(
     riscvP           hart,
     Uns32            intIndex,
     CLICIntFieldType type,
     Uns8             newValue
 ) {
-    hart->clic.intState[intIndex].fields[type] = newValue;
+    riscvCLICIntStateP block = getCLICIntBlock(hart, intIndex);
+
+    if(block) {
+        block[intIndex%CLIC_BLOCK_INTS].fields[type] = newValue;
+    } else if(getCLICInterruptField(hart, intIndex, type)!=newValue) {
+        block = newCLICIntBlock(hart, intIndex/CLIC_BLOCK_INTS);
+        block[intIndex%CLIC_BLOCK_INTS].fields[type] = newValue;
+    }
 }
 
 //
-// Update the indicated field for the indexed interrupt and refresh interrupt
-// stte f it has changed
+// Update the indicated field for the indexed interrupt, returning True if it
+// has changed (and interrupt state must be refreshed)
 //
-static void updateCLICInterruptField(
+static Bool updateCLICInterruptField(
     riscvP           hart,
     Uns32            intIndex,
     CLICIntFieldType type,
     Uns8             newValue
 ) {
-    if(getCLICInterruptField(hart, intIndex, type) != newValue) {
+    Bool changed = getCLICInterruptField(hart, intIndex, type) != newValue;
+
+    if(changed) {
         setCLICInterruptField(hart, intIndex, type, newValue);
-        riscvTestInterrupt(hart);
     }
+
+    return changed;
 }
 
 //
@@ -390,6 +459,7 @@ static Bool getCLICPendingEnable(riscvP hart, Uns32 intIndex) {
 
 //
 // Update state when CLIC pending+enabled state changes for the given interrupt
+// (interrupt state must be refreshed by the caller)
 //
 static void updateCLICPendingEnable(riscvP hart, Uns32 intIndex, Bool newIPE) {
 
@@ -401,14 +471,13 @@ static void updateCLICPendingEnable(riscvP hart, Uns32 intIndex, Bool newIPE) {
     } else {
         hart->clic.ipe[wordIndex] &= ~mask;
     }
-
-    riscvTestInterrupt(hart);
 }
 
 //
-// Write clicintip for the indexed interrupt
+// Write clicintip for the indexed interrupt, returning True if interrupt state
+// must be refreshed
 //
-static void writeCLICInterruptPending(
+static Bool writeCLICInterruptPending(
     riscvP hart,
     Uns32  intIndex,
     Uns8   newValue,
@@ -426,12 +495,15 @@ static void writeCLICInterruptPending(
     if(oldIPE!=newIPE) {
         updateCLICPendingEnable(hart, intIndex, newIPE);
     }
+
+    return oldIPE!=newIPE;
 }
 
 //
-// Write clicintie for the indexed interrupt
+// Write clicintie for the indexed interrupt, returning True if interrupt state
+// must be refreshed
 //
-static void writeCLICInterruptEnable(
+static Bool writeCLICInterruptEnable(
     riscvP hart,
     Uns32  intIndex,
     Uns8   newValue
@@ -448,12 +520,15 @@ static void writeCLICInterruptEnable(
     if(oldIPE!=newIPE) {
         updateCLICPendingEnable(hart, intIndex, newIPE);
     }
+
+    return oldIPE!=newIPE;
 }
 
 //
-// Write clicintattr for the indexed interrupt
+// Write clicintattr for the indexed interrupt, returning True if interrupt
+// state must be refreshed
 //
-static void writeCLICInterruptAttr(
+static Bool writeCLICInterruptAttr(
     riscvP    hart,
     Uns32     intIndex,
     Uns8      newValue,
@@ -492,13 +567,16 @@ static void writeCLICInterruptAttr(
     clicintattr.fields.mode = intMode;
 
     // update field with corrected attributes
-    updateCLICInterruptField(hart, intIndex, CIT_clicintattr, clicintattr.bits);
+    return updateCLICInterruptField(
+        hart, intIndex, CIT_clicintattr, clicintattr.bits
+    );
 }
 
 //
-// Write clicintctl for the indexed interrupt
+// Write clicintctl for the indexed interrupt, returning True if interrupt
+// state must be refreshed
 //
-static void writeCLICInterruptCtl(
+static Bool writeCLICInterruptCtl(
     riscvP hart,
     Uns32  intIndex,
     Uns8   newValue
@@ -506,7 +584,7 @@ static void writeCLICInterruptCtl(
     newValue |= getCLICIntCtl1Bits(hart);
 
     // update field with corrected value
-    updateCLICInterruptField(hart, intIndex, CIT_clicintctl, newValue);
+    return updateCLICInterruptField(hart, intIndex, CIT_clicintctl, newValue);
 }
 
 //
@@ -601,43 +679,113 @@ static Uns32 readCLICInterrupt(riscvP root, Uns32 offset) {
 }
 
 //
-// Update the visible state of an interrupt when accessed using the given
-// offset
+// Return the composed visible state of all fields of an interrupt when
+// accessed using the given word-aligned offset
 //
-static void writeCLICInterrupt(riscvP root, Uns32 offset, Uns8 newValue) {
+static Uns32 readCLICInterruptWord(riscvP root, Uns32 offset) {
+
+    Uns32 result = 0;
 
     if(accessCLICInterrupt(root, offset)) {
 
         riscvP hart     = getCLICHart(root, offset);
         Uns32  intIndex = getCLICIntIndex(offset);
 
-        switch(getCLICIntFieldType(offset)) {
+        // clicintip includes any unlatched level-triggered source
+        result  = getCLICInterruptValue(hart, intIndex) & ~0xff;
+        result |= getCLICInterruptPending(hart, intIndex);
+    }
 
-            case CIT_clicintip:
-                writeCLICInterruptPending(hart, intIndex, newValue, True);
-                break;
+    return result;
+}
 
-            case CIT_clicintie:
-                writeCLICInterruptEnable(hart, intIndex, newValue);
-                break;
+//
+// Update one field of an interrupt, returning True if interrupt state must be
+// refreshed
+//
+static Bool writeCLICInterruptField(
+    riscvP           hart,
+    Uns32            intIndex,
+    CLICIntFieldType type,
+    Uns8             newValue,
+    riscvMode        pageMode
+) {
+    Bool refresh = False;
 
-            case CIT_clicintattr: {
-                riscvMode pageMode = getCLICPageMode(root, offset);
-                writeCLICInterruptAttr(hart, intIndex, newValue, pageMode);
-                break;
-            }
+    switch(type) {
 
-            case CIT_clicintctl:
-                writeCLICInterruptCtl(hart, intIndex, newValue);
-                break;
+        case CIT_clicintip:
+            refresh = writeCLICInterruptPending(hart, intIndex, newValue, True);
+            break;
 
-            default:
-                VMI_ABORT("unimplemented case"); // LCOV_EXCL_LINE
-                break;
+        case CIT_clicintie:
+            refresh = writeCLICInterruptEnable(hart, intIndex, newValue);
+            break;
+
+        case CIT_clicintattr:
+            refresh = writeCLICInterruptAttr(hart, intIndex, newValue, pageMode);
+            break;
+
+        case CIT_clicintctl:
+            refresh = writeCLICInterruptCtl(hart, intIndex, newValue);
+            break;
+
+        default:
+            VMI_ABORT("unimplemented case"); // LCOV_EXCL_LINE
+            break;
+    }
+
+    return refresh;
+}
+
+//
+// Update the visible state of an interrupt when accessed using the given
+// offset
+//
+static void writeCLICInterrupt(riscvP root, Uns32 offset, Uns8 newValue) {
+
+    if(accessCLICInterrupt(root, offset)) {
+
+        riscvP           hart     = getCLICHart(root, offset);
+        Uns32            intIndex = getCLICIntIndex(offset);
+        CLICIntFieldType type     = getCLICIntFieldType(offset);
+        riscvMode        pageMode = getCLICPageMode(root, offset);
+
+        if(writeCLICInterruptField(hart, intIndex, type, newValue, pageMode)) {
+            riscvTestInterrupt(hart);
         }
     }
 }
 
+//
+// Update all fields of an interrupt when accessed using the given word-aligned
+// offset, returning True if interrupt state must be refreshed (fields are
+// updated in address order, as for a sequence of byte writes)
+//
+static Bool writeCLICInterruptWord(
+    riscvP      root,
+    Uns32       offset,
+    const Uns8 *value8
+) {
+    Bool refresh = False;
+
+    if(accessCLICInterrupt(root, offset)) {
+
+        riscvP           hart     = getCLICHart(root, offset);
+        Uns32            intIndex = getCLICIntIndex(offset);
+        riscvMode        pageMode = getCLICPageMode(root, offset);
+        CLICIntFieldType type;
+
+        for(type=0; type<CIT_LAST; type++) {
+            refresh |= writeCLICInterruptField(
+                hart, intIndex, type, value8[type], pageMode
+            );
+        }
+    }
+
+    return refresh;
+}
+
 //
 // Refresh state when CLIC is internally implemented
 //
@@ -646,7 +794,7 @@ void riscvRefreshPendingAndEnabledInternalCLIC(riscvP hart) {
     riscvP root    = hart->smpRoot;
     Uns32  maxRank = 0;
     Int32  id      = RV_NO_INT;
-    Uns32  wordIndex;
+    Uns32  active;
 
     // reset presented interrupt details
     hart->clic.sel.priv  = 0;
@@ -654,9 +802,11 @@ void riscvRefreshPendingAndEnabledInternalCLIC(riscvP hart) {
     hart->clic.sel.level = 0;
     hart->clic.sel.shv   = False;
 
-    // scan for pending+enabled interrupts
-    for(wordIndex=0; wordIndex<hart->ipDWords; wordIndex++) {
+    // scan for pending+enabled interrupts (only interrupts in allocated state
+    // blocks can be enabled)
+    for(active=0; active<hart->clic.numActive; active++) {
 
+        Uns32 wordIndex      = hart->clic.activeBlocks[active];
         Uns64 pendingEnabled = hart->clic.ipe[wordIndex];
 
         // select highest-priority pending-and-enabled interrupt
@@ -729,6 +879,7 @@ void riscvRefreshPendingAndEnabledInternalCLIC(riscvP hart) {
 static void refreshCLICIPE(riscvP hart) {
 
     Uns32 intNum = getIntNum(hart);
+    Uns32 active;
     Uns32 i;
 
     // clear current pending+enabled state
@@ -736,18 +887,27 @@ static void refreshCLICIPE(riscvP hart) {
         hart->clic.ipe[i] = 0;
     }
 
-    // reinstate pending+enabled state from interrupt state
-    for(i=0; i<intNum; i++) {
+    // reinstate pending+enabled state from interrupt state (only interrupts in
+    // allocated state blocks can be enabled)
+    for(active=0; active<hart->clic.numActive; active++) {
+
+        Uns32 wordIndex = hart->clic.activeBlocks[active];
+        Uns32 bitIndex;
 
-        if(
-            getCLICInterruptPending(hart, i) &&
-            getCLICInterruptEnable(hart, i)
-        ) {
-            Uns32 wordIndex = i/64;
-            Uns32 bitIndex  = i%64;
-            Uns64 mask      = (1ULL<<bitIndex);
+        for(bitIndex=0; bitIndex<CLIC_BLOCK_INTS; bitIndex++) {
+
+            Uns32 i = wordIndex*CLIC_BLOCK_INTS + bitIndex;
+
+            if(i>=intNum) {
+                break;
+            }
 
-            hart->clic.ipe[wordIndex] |= mask;
+            if(
+                getCLICInterruptPending(hart, i) &&
+                getCLICInterruptEnable(hart, i)
+            ) {
+                hart->clic.ipe[wordIndex] |= (1ULL<<bitIndex);
+            }
         }
     }
 }
@@ -759,7 +919,9 @@ void riscvAcknowledgeCLICInt(riscvP hart, Uns32 intIndex) {
 
     // deassert interrupt if edge triggered, or refresh pending state if not
     if(CLICInternal(hart) && isCLICInterruptEdge(hart, intIndex)) {
-        writeCLICInterruptPending(hart, intIndex, 0, False);
+        if(writeCLICInterruptPending(hart, intIndex, 0, False)) {
+            riscvTestInterrupt(hart);
+        }
     } else {
         riscvRefreshPendingAndEnabled(hart);
     }
@@ -778,8 +940,10 @@ void riscvUpdateCLICInput(riscvP hart, Uns32 intIndex, Bool newValue) {
     newValue ^= activeLow;
 
     // apply new value if either level triggered or edge triggered and asserted
-    if(!isEdge || newValue) {
-        writeCLICInterruptPending(hart, intIndex, newValue, False);
+    if((!isEdge || newValue) && writeCLICInterruptPending(
+        hart, intIndex, newValue, False
+    )) {
+        riscvTestInterrupt(hart);
     }
 }
 
@@ -878,18 +1042,54 @@ static void writeCLICInt(riscvP root, Uns32 offset, Uns8 newValue) {
     }
 }
 
+//
+// Can an access of the given size at the given offset be handled as a
+// sequence of whole clicint[i] words? This requires a naturally-aligned 32-bit
+// or 64-bit access to an interrupt page (so all words are in the same page and
+// refer to the same hart)
+//
+static Bool isCLICIntWordAccess(Uns32 offset, Uns32 bytes) {
+    return (
+        getCLICPage(offset) &&
+        ((bytes==4) || (bytes==8)) &&
+        !(offset & (bytes-1))
+    );
+}
+
 //
 // Read CLIC register
 //
 static VMI_MEM_READ_FN(readCLIC) {
 
-    riscvP root    = userData;
-    Uns8  *value8  = value;
-    Uns64  lowAddr = getCLICLow(root);
+    riscvP root   = userData;
+    Uns8  *value8 = value;
+    Uns32  offset = address-getCLICLow(root);
     Uns32  i;
 
-    for(i=0; i<bytes; i++) {
-        value8[i] = readCLICInt(root, address+i-lowAddr);
+    if(!isCLICIntWordAccess(offset, bytes)) {
+
+        // general case: assemble result one byte at a time
+        for(i=0; i<bytes; i++) {
+            value8[i] = readCLICInt(root, offset+i);
+        }
+
+    } else {
+
+        // debug access if required
+        if(RISCV_DEBUG_EXCEPT(root)) {
+            debugCLICAccess(root, offset, "READ");
+        }
+
+        // read all clicint[i] fields for each word
+        for(i=0; i<bytes; i+=4) {
+
+            Uns32 result = readCLICInterruptWord(root, offset+i);
+            Uns32 byte;
+
+            for(byte=0; byte<4; byte++) {
+                value8[i+byte] = result >> (byte*8);
+            }
+        }
     }
 }
 
@@ -898,13 +1098,36 @@ static VMI_MEM_READ_FN(readCLIC) {
 //
 static VMI_MEM_WRITE_FN(writeCLIC) {
 
-    riscvP      root    = userData;
-    const Uns8 *value8  = value;
-    Uns64       lowAddr = getCLICLow(root);
+    riscvP      root   = userData;
+    const Uns8 *value8 = value;
+    Uns32       offset = address-getCLICLow(root);
     Uns32       i;
 
-    for(i=0; i<bytes; i++) {
-        writeCLICInt(root, address+i-lowAddr, value8[i]);
+    if(!isCLICIntWordAccess(offset, bytes)) {
+
+        // general case: apply update one byte at a time
+        for(i=0; i<bytes; i++) {
+            writeCLICInt(root, offset+i, value8[i]);
+        }
+
+    } else {
+
+        Bool refresh = False;
+
+        // debug access if required
+        if(RISCV_DEBUG_EXCEPT(root)) {
+            debugCLICAccess(root, offset, "WRITE");
+        }
+
+        // update all clicint[i] fields for each word
+        for(i=0; i<bytes; i+=4) {
+            refresh |= writeCLICInterruptWord(root, offset+i, value8+i);
+        }
+
+        // refresh interrupt state once for the entire access
+        if(refresh) {
+            riscvTestInterrupt(getCLICHart(root, offset));
+        }
     }
 }
 
@@ -934,7 +1157,6 @@ void riscvNewCLIC(riscvP riscv, Uns32 index) {
     riscvPP table    = root->clic.harts;
     Uns32   numHarts = getNumHarts(root);
     Uns32   intNum   = riscvGetIntNum(riscv);
-    Uns32   i;
 
     // do actions required when first leaf hart is encountered
     if(!table) {
@@ -947,6 +1169,15 @@ void riscvNewCLIC(riscvP riscv, Uns32 index) {
         root->clic.clicinfo.fields.version        = root->configInfo.CLICVERSION;
         root->clic.clicinfo.fields.CLICINTCTLBITS = root->configInfo.CLICINTCTLBITS;
 
+        // define default values for interrupt control state
+        CLIC_REG_DECL(clicintattr) = {fields:{mode:RISCV_MODE_MACHINE}};
+        riscvCLICIntState intDefault = {value32:0};
+
+        intDefault.fields[CIT_clicintattr] = clicintattr.bits;
+        intDefault.fields[CIT_clicintctl]  = getCLICIntCtl1Bits(root);
+
+        root->clic.intDefault = intDefault.value32;
+
         // allocate hart table
         table = root->clic.harts = STYPE_CALLOC_N(riscvP, numHarts);
     }
@@ -969,19 +1200,13 @@ void riscvNewCLIC(riscvP riscv, Uns32 index) {
     // indicate internal CLIC is always enabled
     riscv->netValue.enableCLIC = True;
 
-    // allocate control state for interrupts
-    riscv->clic.intState = STYPE_CALLOC_N(riscvCLICIntState, intNum);
-    riscv->clic.ipe      = STYPE_CALLOC_N(Uns64, riscv->ipDWords);
-
-    // define default values for interrupt control state
-    CLIC_REG_DECL(clicintattr) = {fields:{mode:RISCV_MODE_MACHINE}};
-    Uns32         clicintctl   = getCLICIntCtl1Bits(riscv);
+    // allocate control state for interrupts (state blocks are allocated when
+    // interrupts are first configured)
+    Uns32 numBlocks = riscv->ipDWords;
 
-    // initialise control state for interrupts
-    for(i=0; i<intNum; i++) {
-        setCLICInterruptField(riscv, i, CIT_clicintattr, clicintattr.bits);
-        setCLICInterruptField(riscv, i, CIT_clicintctl, clicintctl);
-    }
+    riscv->clic.intBlocks    = STYPE_CALLOC_N(riscvCLICIntStateP, numBlocks);
+    riscv->clic.activeBlocks = STYPE_CALLOC_N(Uns32, numBlocks);
+    riscv->clic.ipe          = STYPE_CALLOC_N(Uns64, numBlocks);
 }
 
 //
@@ -996,8 +1221,19 @@ void riscvNewCLIC(riscvP riscv, Uns32 index) {
 // Free CLIC data structures
 //
 void riscvFreeCLIC(riscvP riscv) {
+
+    Uns32 active;
+
+    // free allocated interrupt state blocks
+    for(active=0; active<riscv->clic.numActive; active++) {
+        CLIC_FREE(riscv, intBlocks[riscv->clic.activeBlocks[active]]);
+    }
+
+    riscv->clic.numActive = 0;
+
     CLIC_FREE(riscv, harts);
-    CLIC_FREE(riscv, intState);
+    CLIC_FREE(riscv, intBlocks);
+    CLIC_FREE(riscv, activeBlocks);
     CLIC_FREE(riscv, ipe);
 }
 
@@ -1006,7 +1242,7 @@ void riscvFreeCLIC(riscvP riscv) {
 //
 void riscvResetCLIC(riscvP riscv) {
 
-    if(riscv->clic.intState) {
+    if(riscv->clic.intBlocks) {
         cliccfgW(riscv, 0);
     }
 }
@@ -1032,13 +1268,18 @@ void riscvSaveCLIC(
     // save CLIC configuration (root level)
     VMIRT_SAVE_FIELD(cxt, riscv->smpRoot, clic.cliccfg);
 
-    // save CLIC interrupt state
-    vmirtSave(
-        cxt,
-        RV_CLIC_INTSTATE,
-        riscv->clic.intState,
-        sizeof(*riscv->clic.intState)*getIntNum(riscv)
-    );
+    Uns32              intNum   = getIntNum(riscv);
+    riscvCLICIntStateP intState = STYPE_CALLOC_N(riscvCLICIntState, intNum);
+    Uns32              i;
+
+    // save CLIC interrupt state as a dense array of all interrupts
+    for(i=0; i<intNum; i++) {
+        intState[i] = getCLICIntState(riscv, i);
+    }
+
+    vmirtSave(cxt, RV_CLIC_INTSTATE, intState, sizeof(*intState)*intNum);
+
+    STYPE_FREE(intState);
 }
 
 //
@@ -1052,13 +1293,26 @@ void riscvRestoreCLIC(
     // restore CLIC configuration (root level)
     VMIRT_RESTORE_FIELD(cxt, riscv->smpRoot, clic.cliccfg);
 
-    // restore CLIC interrupt state
-    vmirtRestore(
-        cxt,
-        RV_CLIC_INTSTATE,
-        riscv->clic.intState,
-        sizeof(*riscv->clic.intState)*getIntNum(riscv)
-    );
+    Uns32              intNum   = getIntNum(riscv);
+    riscvCLICIntStateP intState = STYPE_CALLOC_N(riscvCLICIntState, intNum);
+    Uns32              i;
+
+    // restore CLIC interrupt state from a dense array of all interrupts
+    vmirtRestore(cxt, RV_CLIC_INTSTATE, intState, sizeof(*intState)*intNum);
+
+    for(i=0; i<intNum; i++) {
+
+        riscvCLICIntStateP block = getCLICIntBlock(riscv, i);
+
+        if(block) {
+            block[i%CLIC_BLOCK_INTS] = intState[i];
+        } else if(intState[i].value32!=riscv->smpRoot->clic.intDefault) {
+            block = newCLICIntBlock(riscv, i/CLIC_BLOCK_INTS);
+            block[i%CLIC_BLOCK_INTS] = intState[i];
+        }
+    }
+
+    STYPE_FREE(intState);
 
     // refresh CLIC pending+enable mask
     refreshCLICIPE(riscv);
@@ -116,12 +116,15 @@ typedef struct riscvCLICOutStateS {
 // This holds CLIC state
 //
 typedef struct riscvCLICS {
-    riscvCLICOutState  sel;         // selected interrupt state
-    CLIC_REG_DECL     (cliccfg);    // cliccfg register value
-    CLIC_REG_DECL     (clicinfo);   // clicinfo register value
-    riscvPP            harts;       // member harts
-    riscvCLICIntStateP intState;    // state for each interrupt
-    Uns64             *ipe;         // mask of pending-and-enabled interrupts
+    riscvCLICOutState   sel;            // selected interrupt state
+    CLIC_REG_DECL      (cliccfg);       // cliccfg register value
+    CLIC_REG_DECL      (clicinfo);      // clicinfo register value
+    riscvPP             harts;          // member harts
+    riscvCLICIntStatePP intBlocks;      // sparse blocks of interrupt state
+    Uns32              *activeBlocks;   // allocated block indices (ascending)
+    Uns32               numActive;      // number of allocated blocks
+    Uns32               intDefault;     // unconfigured interrupt state (root)
+    Uns64              *ipe;            // mask of pending-and-enabled interrupts
 } riscvCLIC;
 
 
@@ -31,7 +31,9 @@
 
 // model header files
 #include "riscvBus.h"
+#include "riscvCache.h"
 #include "riscvCLIC.h"
+#include "riscvCosim.h"
 #include "riscvCSR.h"
 #include "riscvCSRTypes.h"
 #include "riscvExceptions.h"
@@ -39,6 +41,7 @@
 #include "riscvMorph.h"
 #include "riscvRegisters.h"
 #include "riscvStructure.h"
+#include "riscvTrigger.h"
 #include "riscvVariant.h"
 #include "riscvUtils.h"
 #include "riscvVM.h"
@@ -2104,31 +2107,82 @@ static RISCV_CSR_WRITEFN(mcountinhibitW) {
     // refresh state after possible inhibit update
     riscvPostInhibit(riscv, &state, True);
 
+    // cache event counters are also inhibited by mcountinhibit
+    if(riscv->cache) {
+        riscvSetCacheInhibit(riscv, RD_CSR(riscv, mcountinhibit));
+    }
+
     return newValue;
 }
 
 //
-// Read unimplemented performance monitor register
+// Is the performance monitor register an event selector?
+//
+inline static Bool isHPMEvent(riscvCSRAttrsCP attrs) {
+    return (attrs->csrNum & ~31) == 0x320;
+}
+
+//
+// Is the performance monitor register the upper half of a counter?
+//
+inline static Bool isHPMUpper(riscvCSRAttrsCP attrs) {
+    return (attrs->csrNum & 0x80) && !isHPMEvent(attrs);
+}
+
+//
+// Read performance monitor register (implemented only if the cache model is
+// enabled, when cache events can be counted)
 //
 static RISCV_CSR_READFN(mhpmR) {
 
-    if(hpmAccessValid(attrs, riscv)) {
+    Uns32 index  = attrs->csrNum & 31;
+    Uns64 result = 0;
+
+    if(!hpmAccessValid(attrs, riscv) || !riscv->cache) {
         // no action
+    } else if(isHPMEvent(attrs)) {
+        result = riscvReadCacheEvent(riscv, index);
+    } else if(isHPMUpper(attrs)) {
+        result = riscvReadCacheCounter(riscv, index) >> 32;
+    } else {
+        result = getXLENValue(riscv, riscvReadCacheCounter(riscv, index));
     }
 
-    return 0;
+    return result;
 }
 
 //
-// Write unimplemented performance monitor register
+// Write performance monitor register (implemented only if the cache model is
+// enabled, when cache events can be counted)
 //
 static RISCV_CSR_WRITEFN(mhpmW) {
 
-    if(hpmAccessValid(attrs, riscv)) {
-        // no action
+    Uns32 index = attrs->csrNum & 31;
+
+    if(!hpmAccessValid(attrs, riscv) || !riscv->cache) {
+
+        newValue = 0;
+
+    } else if(isHPMEvent(attrs)) {
+
+        riscvWriteCacheEvent(riscv, index, newValue);
+
+    } else {
+
+        Uns64 value = riscvReadCacheCounter(riscv, index);
+
+        if(isHPMUpper(attrs)) {
+            value = setUpper(newValue, value);
+        } else if(RISCV_XLEN_IS_32(riscv)) {
+            value = setLower(newValue, value);
+        } else {
+            value = newValue;
+        }
+
+        riscvWriteCacheCounter(riscv, index, value);
     }
 
-    return 0;
+    return newValue;
 }
 
 
@@ -2181,6 +2235,9 @@ static RISCV_CSR_WRITEFN(satpW) {
 
         // change in SATP.ASID affects effective ASID
         riscvVMSetASID(riscv);
+
+        // artifact translations are discarded on any satp write
+        riscvVMInvalidateArtifact(riscv);
     }
 
     // return written value
@@ -2436,6 +2493,53 @@ static void resetVLVType(riscvP riscv) {
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+// TRIGGER REGISTERS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Are trigger registers present?
+//
+inline static RISCV_CSR_PRESENTFN(tdataP) {
+    return riscv->configInfo.trigger_num;
+}
+
+//
+// Return tdata register index (1-3)
+//
+inline static Uns32 tdataIndex(riscvCSRAttrsCP attrs) {
+    return getCSRId(attrs)-CSR_ID(tselect);
+}
+
+//
+// Read tselect
+//
+static RISCV_CSR_READFN(tselectR) {
+    return riscvTriggerReadTSelect(riscv);
+}
+
+//
+// Write tselect
+//
+static RISCV_CSR_WRITEFN(tselectW) {
+    return riscvTriggerWriteTSelect(riscv, newValue);
+}
+
+//
+// Read tdata1-tdata3
+//
+static RISCV_CSR_READFN(tdataR) {
+    return riscvTriggerReadTData(riscv, tdataIndex(attrs));
+}
+
+//
+// Write tdata1-tdata3
+//
+static RISCV_CSR_WRITEFN(tdataW) {
+    return riscvTriggerWriteTData(riscv, tdataIndex(attrs), newValue);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // DEBUG MODE REGISTERS
 ////////////////////////////////////////////////////////////////////////////////
@@ -2816,10 +2920,10 @@ static const riscvCSRAttrs csrs[CSR_ID(LAST)] = {
     CSR_ATTR_P__3_31 (mhpmevent,    0x320, 0,           0,          1_10,   0,0,0,0,0, "Machine Performance Monitor Event Select ",     0,           0,           mhpmR,        0,        mhpmW         ),
 
     //                name          num    arch         access      version   attrs    description                                      present      wState       rCB           rwCB      wCB
-    CSR_ATTR_NIP     (tselect,      0x7A0, 0,           0,          1_10,   0,0,0,0,0, "Debug/Trace Trigger Register Select"                                                                            ),
-    CSR_ATTR_NIP     (tdata1,       0x7A1, 0,           0,          1_10,   0,0,0,0,0, "Debug/Trace Trigger Data 1"                                                                                     ),
-    CSR_ATTR_NIP     (tdata2,       0x7A2, 0,           0,          1_10,   0,0,0,0,0, "Debug/Trace Trigger Data 2"                                                                                     ),
-    CSR_ATTR_NIP     (tdata3,       0x7A3, 0,           0,          1_10,   0,0,0,0,0, "Debug/Trace Trigger Data 3"                                                                                     ),
+    CSR_ATTR_P__     (tselect,      0x7A0, 0,           0,          1_10,   0,0,0,0,1, "Debug/Trace Trigger Register Select",           tdataP,      0,           tselectR,     0,        tselectW      ),
+    CSR_ATTR_P__     (tdata1,       0x7A1, 0,           0,          1_10,   1,0,0,0,1, "Debug/Trace Trigger Data 1",                    tdataP,      0,           tdataR,       0,        tdataW        ),
+    CSR_ATTR_P__     (tdata2,       0x7A2, 0,           0,          1_10,   1,0,0,0,1, "Debug/Trace Trigger Data 2",                    tdataP,      0,           tdataR,       0,        tdataW        ),
+    CSR_ATTR_P__     (tdata3,       0x7A3, 0,           0,          1_10,   0,0,0,0,1, "Debug/Trace Trigger Data 3",                    tdataP,      0,           tdataR,       0,        tdataW        ),
 
     //                name          num    arch         access      version   attrs    description                                      present      wState       rCB           rwCB      wCB
     CSR_ATTR_TV_     (dcsr,         0x7B0, 0,           0,          1_10,   0,0,0,0,0, "Debug Control and Status",                      debugP,      0,           0,            0,        dcsrW         ),
@@ -4524,6 +4628,21 @@ void riscvEmitCSRRead(
     }
 }
 
+//
+// Return True if a write to the CSR could change the mstatus.MPRV polymorphic
+// key used by loads and stores in the current block, in which case the block
+// must be terminated
+//
+static Bool mprvKeyMayChange(riscvCSRAttrsCP attrs, riscvP riscv) {
+    return (
+        riscvVMUseMPRVKey(riscv) && (
+            (attrs->csrNum==0x300) ||   // mstatus
+            (attrs->csrNum==0x180) ||   // satp
+            (attrs->csrNum==0x7B0)      // dcsr
+        )
+    );
+}
+
 //
 // Emit code to write a CSR
 //
@@ -4543,6 +4662,14 @@ void riscvEmitCSRWrite(
     // indicate that this register has been written
     vmimtRegWriteImpl(attrs->name);
 
+    // record CSR write for co-simulation if required (the new value is read
+    // when the instruction retires)
+    if(riscv->cosim) {
+        vmimtArgProcessor();
+        vmimtArgNatAddress(attrs);
+        vmimtCallAttrs((vmiCallFn)riscvCosimCSRWrite, VMCA_NO_INVALIDATE);
+    }
+
     if(writeCB) {
 
         // if CSR is implemented externally, mirror the result into any raw
@@ -4559,7 +4686,7 @@ void riscvEmitCSRWrite(
         vmimtCallResult((vmiCallFn)writeCB, bits, raw);
 
         // terminate the current block if required
-        if(attrs->wEndBlock) {
+        if(attrs->wEndBlock || mprvKeyMayChange(attrs, riscv)) {
             vmimtEndBlock();
         }
 
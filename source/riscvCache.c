@@ -0,0 +1,657 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// standard header files
+#include <stdio.h>
+
+// Imperas header files
+#include "hostapi/impAlloc.h"
+
+// VMI header files
+#include "vmi/vmiMessage.h"
+#include "vmi/vmiRt.h"
+
+// model header files
+#include "riscvCache.h"
+#include "riscvMessage.h"
+#include "riscvParameters.h"
+#include "riscvStructure.h"
+#include "riscvVariant.h"
+#include "riscvVM.h"
+#include "riscvVMConstants.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Number of accesses buffered before they are applied to the cache model
+//
+#define CACHE_BUFFER_SIZE   1024
+
+//
+// Tag value indicating an invalid cache line
+//
+#define CACHE_INVALID       ((Uns64)-1)
+
+DEFINE_S(cacheLevel);
+
+//
+// State for one cache level
+//
+typedef struct cacheLevelS {
+    const char *name;           // cache name
+    cacheLevelP next;           // next cache level (0 if none)
+    Uns64      *tags;           // line address held in each way
+    Uns64      *stamps;         // replacement stamp for each way
+    Uns64       stamp;          // current replacement stamp
+    Uns32       size;           // cache size in bytes
+    Uns32       ways;           // associativity (0 if cache absent)
+    Uns32       sets;           // number of sets
+    Uns64       accesses;       // number of line accesses
+    Uns64       misses;         // number of line misses
+} cacheLevel;
+
+//
+// Buffered memory access
+//
+typedef struct cacheAccessS {
+    Uns64                PA;    // access physical address
+    Uns32                bytes; // access size
+    riscvCacheAccessType type;  // access type
+} cacheAccess, *cacheAccessP;
+
+//
+// Cache model state for one hart
+//
+typedef struct riscvCacheS {
+    Uns32             lineShift;            // log2 line size
+    riscvCacheReplace replace;              // replacement policy
+    Uns32             random;               // random replacement state
+    cacheLevel        L1I;                  // L1 instruction cache
+    cacheLevel        L1D;                  // L1 data cache
+    cacheLevel        L2;                   // unified L2 cache
+    Uns8              hpmEvent[32];         // selected event per counter
+    Uns64             hpmBase[32];          // event count base per counter
+    Uns64             hpmFrozen[32];        // value of inhibited counters
+    Uns32             hpmInhibit;           // mask of inhibited counters
+    Uns32             bufferNum;            // number of buffered accesses
+    cacheAccess       buffer[CACHE_BUFFER_SIZE];
+} riscvCache;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// CACHE MODEL
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return the first present cache in the hierarchy starting at the given level
+//
+inline static cacheLevelP getPresentLevel(cacheLevelP level) {
+    return (level && !level->ways) ? level->next : level;
+}
+
+//
+// Return pseudo-random way index
+//
+static Uns32 getRandomWay(riscvCacheP cache, Uns32 ways) {
+
+    Uns32 x = cache->random;
+
+    x ^= x<<13;
+    x ^= x>>17;
+    x ^= x<<5;
+
+    cache->random = x;
+
+    return x % ways;
+}
+
+//
+// Access the given line in a cache level, propagating any miss to the next
+// level
+//
+static void accessLine(riscvCacheP cache, cacheLevelP level, Uns64 line) {
+
+    while(level) {
+
+        Uns32  ways   = level->ways;
+        Uns32  set    = line & (level->sets-1);
+        Uns64 *tags   = &level->tags[set*ways];
+        Uns64 *stamps = &level->stamps[set*ways];
+        Uns32  victim = 0;
+        Uns32  i;
+
+        level->accesses++;
+
+        // look for a hit, remembering the best replacement candidate
+        for(i=0; i<ways; i++) {
+
+            if(tags[i]==line) {
+
+                // update LRU state on a hit
+                if(cache->replace==RVCR_LRU) {
+                    stamps[i] = ++level->stamp;
+                }
+
+                return;
+
+            } else if(tags[victim]==CACHE_INVALID) {
+
+                // invalid way already selected
+
+            } else if(tags[i]==CACHE_INVALID) {
+
+                victim = i;
+
+            } else if(stamps[i]<stamps[victim]) {
+
+                victim = i;
+            }
+        }
+
+        // handle random replacement when the set is full
+        if((cache->replace==RVCR_RANDOM) && (tags[victim]!=CACHE_INVALID)) {
+            victim = getRandomWay(cache, ways);
+        }
+
+        // fill the line
+        level->misses++;
+        tags[victim]   = line;
+        stamps[victim] = ++level->stamp;
+
+        // continue with the next level
+        level = level->next;
+    }
+}
+
+//
+// Invalidate all lines in a cache level
+//
+static void invalidateLevel(cacheLevelP level) {
+
+    Uns32 lines = level->sets*level->ways;
+    Uns32 i;
+
+    for(i=0; i<lines; i++) {
+        level->tags[i] = CACHE_INVALID;
+    }
+}
+
+//
+// Apply all buffered accesses to the cache model
+//
+static void flushAccessBuffer(riscvP riscv) {
+
+    riscvCacheP cache = riscv->cache;
+    cacheLevelP data  = getPresentLevel(&cache->L1D);
+    Uns32       i;
+
+    // accesses filtered in JIT code hit the most-recently used data line, so
+    // they change only the access count of the first data cache level
+    if(data) {
+        data->accesses += riscv->cacheHits;
+    }
+
+    riscv->cacheHits = 0;
+
+    for(i=0; i<cache->bufferNum; i++) {
+
+        cacheAccessP access = &cache->buffer[i];
+        cacheLevelP  level  = &cache->L1D;
+        Uns64        first  = access->PA >> cache->lineShift;
+        Uns64        last   = (access->PA+access->bytes-1) >> cache->lineShift;
+        Uns64        line;
+
+        if(access->type==RVCA_FETCH) {
+            level = &cache->L1I;
+        }
+
+        // accesses that span lines access each line in turn
+        for(line=first; line<=last; line++) {
+            accessLine(cache, getPresentLevel(level), line);
+        }
+    }
+
+    cache->bufferNum = 0;
+}
+
+//
+// Return the current count for the given event
+//
+static Uns64 getEventCount(riscvP riscv, riscvCacheEvent event) {
+
+    riscvCacheP cache = riscv->cache;
+
+    flushAccessBuffer(riscv);
+
+    switch(event) {
+        case RVCE_L1I_ACCESS: return cache->L1I.accesses;
+        case RVCE_L1I_MISS:   return cache->L1I.misses;
+        case RVCE_L1D_ACCESS: return cache->L1D.accesses;
+        case RVCE_L1D_MISS:   return cache->L1D.misses;
+        case RVCE_L2_ACCESS:  return cache->L2.accesses;
+        case RVCE_L2_MISS:    return cache->L2.misses;
+        default:              return 0;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// JIT CODE CALLBACKS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Buffer an access to the given physical address
+//
+static void bufferAccess(
+    riscvP               riscv,
+    Uns64                PA,
+    Uns32                bytes,
+    riscvCacheAccessType type
+) {
+    riscvCacheP  cache  = riscv->cache;
+    cacheAccessP access = &cache->buffer[cache->bufferNum++];
+
+    access->PA    = PA;
+    access->bytes = bytes;
+    access->type  = type;
+
+    // apply buffered accesses in a batch when the buffer is full
+    if(cache->bufferNum==CACHE_BUFFER_SIZE) {
+        flushAccessBuffer(riscv);
+    }
+}
+
+//
+// Record a completed memory access using the given domain (or the processor
+// code or data domain if NULL) (called from JIT code)
+//
+void riscvCacheAccess(
+    riscvP               riscv,
+    memDomainP           domain,
+    Uns64                VA,
+    Uns32                bytes,
+    riscvCacheAccessType type
+) {
+    riscvCacheP cache  = riscv->cache;
+    Bool        isCode = (type==RVCA_FETCH);
+    Uns64       first  = VA >> cache->lineShift;
+    Uns64       last   = (VA+bytes-1) >> cache->lineShift;
+    Uns32       split  = RISCV_PAGE_SIZE - (VA & (RISCV_PAGE_SIZE-1));
+
+    // translate each page accessed separately (the access has completed, so
+    // any translation is held in the TLB)
+    if(bytes<=split) {
+
+        bufferAccess(
+            riscv, riscvVMGetPhysicalAddress(riscv, domain, VA, isCode),
+            bytes, type
+        );
+
+    } else {
+
+        bufferAccess(
+            riscv, riscvVMGetPhysicalAddress(riscv, domain, VA, isCode),
+            split, type
+        );
+        bufferAccess(
+            riscv, riscvVMGetPhysicalAddress(riscv, domain, VA+split, isCode),
+            bytes-split, type
+        );
+    }
+
+    // record the virtual line used by JIT code to filter repeated data
+    // accesses (a fetch may evict that line if fetches and data share the
+    // first level)
+    if(!isCode) {
+        riscv->cacheLine = (first==last) ? first : CACHE_INVALID;
+    } else if(!cache->L1D.ways) {
+        riscv->cacheLine = CACHE_INVALID;
+    }
+}
+
+//
+// Invalidate the instruction cache (called from JIT code for fence.i)
+//
+void riscvCacheInvalidateI(riscvP riscv) {
+
+    riscvCacheP cache = riscv->cache;
+
+    flushAccessBuffer(riscv);
+
+    if(cache->L1I.ways) {
+        invalidateLevel(&cache->L1I);
+    }
+}
+
+//
+// Discard state used to filter repeated accesses by virtual address (caches
+// are indexed and tagged by physical address, so are not affected) whenever
+// the address mapping may change
+//
+void riscvCacheRefreshMapping(riscvP riscv) {
+    riscv->cacheLine = CACHE_INVALID;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// PERFORMANCE MONITOR COUNTERS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return value of the cache event counter with the given index
+//
+Uns64 riscvReadCacheCounter(riscvP riscv, Uns32 index) {
+
+    riscvCacheP cache = riscv->cache;
+
+    if(cache->hpmInhibit & (1<<index)) {
+        return cache->hpmFrozen[index];
+    } else {
+        Uns64 count = getEventCount(riscv, cache->hpmEvent[index]);
+        return count - cache->hpmBase[index];
+    }
+}
+
+//
+// Update value of the cache event counter with the given index
+//
+void riscvWriteCacheCounter(riscvP riscv, Uns32 index, Uns64 newValue) {
+
+    riscvCacheP cache = riscv->cache;
+
+    if(cache->hpmInhibit & (1<<index)) {
+        cache->hpmFrozen[index] = newValue;
+    } else {
+        Uns64 count = getEventCount(riscv, cache->hpmEvent[index]);
+        cache->hpmBase[index] = count - newValue;
+    }
+}
+
+//
+// Update the mask of inhibited cache event counters (from mcountinhibit),
+// preserving the value of each counter that is stopped or restarted
+//
+void riscvSetCacheInhibit(riscvP riscv, Uns32 inhibit) {
+
+    riscvCacheP cache   = riscv->cache;
+    Uns32       changed = (inhibit ^ cache->hpmInhibit) & ~7;
+    Uns32       index;
+
+    for(index=3; index<32; index++) {
+
+        if(changed & (1<<index)) {
+
+            Uns64 value = riscvReadCacheCounter(riscv, index);
+
+            cache->hpmInhibit ^= (1<<index);
+
+            riscvWriteCacheCounter(riscv, index, value);
+        }
+    }
+}
+
+//
+// Return event selected for the cache event counter with the given index
+//
+Uns64 riscvReadCacheEvent(riscvP riscv, Uns32 index) {
+    return riscv->cache->hpmEvent[index];
+}
+
+//
+// Select event for the cache event counter with the given index (events that
+// are not supported are ignored)
+//
+void riscvWriteCacheEvent(riscvP riscv, Uns32 index, Uns64 newValue) {
+
+    riscvCacheP cache = riscv->cache;
+
+    if(newValue<RVCE_LAST) {
+
+        // preserve the current counter value
+        Uns64 oldValue = riscvReadCacheCounter(riscv, index);
+
+        cache->hpmEvent[index] = newValue;
+
+        riscvWriteCacheCounter(riscv, index, oldValue);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// REPORTING
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Print statistics for one cache level
+//
+static void printCacheLevel(cacheLevelP level) {
+
+    if(level->ways) {
+
+        char accesses[32];
+        char misses[32];
+
+        snprintf(accesses, sizeof(accesses), FMT_64u, level->accesses);
+        snprintf(misses,   sizeof(misses),   FMT_64u, level->misses);
+
+        vmiPrintf(
+            "  %-4s %8uK %3u-way  %16s  %16s  %6.2f%%\n",
+            level->name, level->size/1024, level->ways, accesses, misses,
+            level->accesses ? (100.0*level->misses)/level->accesses : 0.0
+        );
+    }
+}
+
+//
+// Print cache statistics
+//
+static void printCacheStats(riscvP riscv) {
+
+    riscvCacheP cache = riscv->cache;
+
+    flushAccessBuffer(riscv);
+
+    vmiPrintf(
+        "Cache statistics for %s (%u byte lines):\n"
+        "  name      size   assoc          accesses            misses  miss rate\n",
+        vmirtProcessorName((vmiProcessorP)riscv), 1<<cache->lineShift
+    );
+
+    printCacheLevel(&cache->L1I);
+    printCacheLevel(&cache->L1D);
+    printCacheLevel(&cache->L2);
+}
+
+//
+// Print cache statistics command
+//
+static VMIRT_COMMAND_PARSE_FN(cacheReportCommand) {
+
+    printCacheStats((riscvP)processor);
+
+    return "1";
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION AND DESTRUCTION
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return log2 of the given value if it is a power of two, or -1 if not
+//
+static Int32 getLog2(Uns32 value) {
+
+    Int32 result = 0;
+
+    if(!value || (value & (value-1))) {
+        return -1;
+    }
+
+    while(value>1) {
+        value >>= 1;
+        result++;
+    }
+
+    return result;
+}
+
+//
+// Initialize one cache level, validating its geometry
+//
+static void newCacheLevel(
+    riscvP      riscv,
+    cacheLevelP level,
+    const char *name,
+    Uns32       size,
+    Uns32       ways,
+    cacheLevelP next
+) {
+    Uns32 lineBytes = 1 << riscv->cache->lineShift;
+    Uns32 sets      = ways ? size/(ways*lineBytes) : 0;
+
+    level->name = name;
+    level->next = next;
+
+    if(!size) {
+
+        // cache absent
+
+    } else if(!sets || (sets*ways*lineBytes!=size) || (getLog2(sets)<0)) {
+
+        vmiMessage("W", CPU_PREFIX"_ICG",
+            NO_SRCREF_FMT "%s cache of %u bytes with %u ways and %u byte "
+            "lines does not have a power-of-two number of sets - ignored",
+            NO_SRCREF_ARGS(riscv), name, size, ways, lineBytes
+        );
+
+    } else {
+
+        Uns32 lines = sets*ways;
+        Uns32 i;
+
+        level->size   = size;
+        level->ways   = ways;
+        level->sets   = sets;
+        level->tags   = STYPE_CALLOC_N(Uns64, lines);
+        level->stamps = STYPE_CALLOC_N(Uns64, lines);
+
+        for(i=0; i<lines; i++) {
+            level->tags[i] = CACHE_INVALID;
+        }
+    }
+}
+
+//
+// Free one cache level
+//
+static void freeCacheLevel(cacheLevelP level) {
+
+    if(level->ways) {
+        STYPE_FREE(level->tags);
+        STYPE_FREE(level->stamps);
+    }
+}
+
+//
+// Allocate cache model structures if any cache is configured
+//
+void riscvNewCache(riscvP riscv, riscvParamValuesP params) {
+
+    Int32 lineShift = getLog2(params->cache_line);
+
+    if(!(params->L1I_size || params->L1D_size || params->L2_size)) {
+
+        // no cache configured
+
+    } else if(lineShift<0) {
+
+        vmiMessage("W", CPU_PREFIX"_ICL",
+            NO_SRCREF_FMT "Cache line size %u is not a power of two - cache "
+            "model disabled",
+            NO_SRCREF_ARGS(riscv), params->cache_line
+        );
+
+    } else {
+
+        riscvCacheP cache = STYPE_CALLOC(riscvCache);
+
+        riscv->cache     = cache;
+        cache->lineShift = lineShift;
+        cache->replace   = params->cache_replace;
+        cache->random    = 0x2545f491;
+        riscv->cacheLine = CACHE_INVALID;
+
+        // initialize cache hierarchy
+        newCacheLevel(
+            riscv, &cache->L2, "L2", params->L2_size, params->L2_ways, 0
+        );
+        newCacheLevel(
+            riscv, &cache->L1I, "L1I", params->L1I_size, params->L1I_ways,
+            getPresentLevel(&cache->L2)
+        );
+        newCacheLevel(
+            riscv, &cache->L1D, "L1D", params->L1D_size, params->L1D_ways,
+            getPresentLevel(&cache->L2)
+        );
+
+        // install cache report command
+        vmirtAddCommandParse(
+            (vmiProcessorP)riscv,
+            "cacheReport",
+            "show cache model statistics",
+            cacheReportCommand,
+            VMI_CT_QUERY|VMI_CO_DIAG|VMI_CA_REPORT
+        );
+    }
+}
+
+//
+// Report cache statistics if required and free cache model structures
+//
+void riscvFreeCache(riscvP riscv) {
+
+    riscvCacheP cache = riscv->cache;
+
+    if(cache) {
+
+        if(riscv->verbose) {
+            printCacheStats(riscv);
+        }
+
+        freeCacheLevel(&cache->L1I);
+        freeCacheLevel(&cache->L1D);
+        freeCacheLevel(&cache->L2);
+
+        STYPE_FREE(cache);
+
+        riscv->cache = 0;
+    }
+}
+
+//
+// Return log2 of the cache line size in bytes
+//
+Uns32 riscvGetCacheLineShift(riscvP riscv) {
+    return riscv->cache->lineShift;
+}
+
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+// basic types
+#include "hostapi/impTypes.h"
+
+// model header files
+#include "riscvTypeRefs.h"
+
+
+//
+// Memory access types recorded by the cache model
+//
+typedef enum riscvCacheAccessTypeE {
+    RVCA_FETCH,                         // instruction fetch
+    RVCA_LOAD,                          // data load
+    RVCA_STORE,                         // data store
+} riscvCacheAccessType;
+
+//
+// Cache events that can be selected using mhpmevent3-mhpmevent31
+//
+typedef enum riscvCacheEventE {
+    RVCE_NONE,                          // no event
+    RVCE_L1I_ACCESS,                    // L1 instruction cache access
+    RVCE_L1I_MISS,                      // L1 instruction cache miss
+    RVCE_L1D_ACCESS,                    // L1 data cache access
+    RVCE_L1D_MISS,                      // L1 data cache miss
+    RVCE_L2_ACCESS,                     // L2 cache access
+    RVCE_L2_MISS,                       // L2 cache miss
+    RVCE_LAST                           // KEEP LAST: for sizing
+} riscvCacheEvent;
+
+//
+// Allocate cache model structures if any cache is configured
+//
+void riscvNewCache(riscvP riscv, riscvParamValuesP params);
+
+//
+// Report cache statistics if required and free cache model structures
+//
+void riscvFreeCache(riscvP riscv);
+
+//
+// Return log2 of the cache line size in bytes
+//
+Uns32 riscvGetCacheLineShift(riscvP riscv);
+
+//
+// Record a completed memory access using the given domain (or the processor
+// code or data domain if NULL) (called from JIT code)
+//
+void riscvCacheAccess(
+    riscvP               riscv,
+    memDomainP           domain,
+    Uns64                VA,
+    Uns32                bytes,
+    riscvCacheAccessType type
+);
+
+//
+// Invalidate the instruction cache (called from JIT code for fence.i)
+//
+void riscvCacheInvalidateI(riscvP riscv);
+
+//
+// Discard state used to filter repeated accesses by virtual address (caches
+// are indexed and tagged by physical address, so are not affected) whenever
+// the address mapping may change
+//
+void riscvCacheRefreshMapping(riscvP riscv);
+
+//
+// Return value of the cache event counter with the given index
+//
+Uns64 riscvReadCacheCounter(riscvP riscv, Uns32 index);
+
+//
+// Update value of the cache event counter with the given index
+//
+void riscvWriteCacheCounter(riscvP riscv, Uns32 index, Uns64 newValue);
+
+//
+// Update the mask of inhibited cache event counters (from mcountinhibit),
+// preserving the value of each counter that is stopped or restarted
+//
+void riscvSetCacheInhibit(riscvP riscv, Uns32 inhibit);
+
+//
+// Return event selected for the cache event counter with the given index
+//
+Uns64 riscvReadCacheEvent(riscvP riscv, Uns32 index);
+
+//
+// Select event for the cache event counter with the given index (events that
+// are not supported are ignored)
+//
+void riscvWriteCacheEvent(riscvP riscv, Uns32 index, Uns64 newValue);
+
@@ -97,6 +97,7 @@ typedef struct riscvConfigS {
     Uns32             Sv_modes;         // bit mask of valid Sv modes
     Uns32             numHarts;         // number of hart contexts if MPCore
     Uns32             tvec_align;       // trap vector alignment (vectored mode)
+    Uns32             trigger_num;      // number of debug triggers
     Uns32             ELEN;             // ELEN (vector extension)
     Uns32             SLEN;             // SLEN (vector extension)
     Uns32             VLEN;             // VLEN (vector extension)
@@ -109,6 +110,7 @@ typedef struct riscvConfigS {
     Bool              noFaultOnlyFirst; // fault-only-first instructions absent?
     Bool              updatePTEA;       // hardware update of PTE A bit?
     Bool              updatePTED;       // hardware update of PTE D bit?
+    Bool              tlb_prefill;      // prefill TLB from neighbouring PTEs?
     Bool              unaligned;        // whether unaligned accesses supported
     Bool              unalignedAMO;     // whether AMO supports unaligned
     Bool              wfi_is_nop;       // whether WFI is treated as NOP
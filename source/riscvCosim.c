@@ -0,0 +1,849 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// standard header files
+#include <stdio.h>
+#include <string.h>
+
+// shared memory header files
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Imperas header files
+#include "hostapi/impAlloc.h"
+
+// VMI header files
+#include "vmi/vmiMessage.h"
+#include "vmi/vmiRt.h"
+
+// model header files
+#include "riscvCosim.h"
+#include "riscvCSR.h"
+#include "riscvExceptions.h"
+#include "riscvMessage.h"
+#include "riscvParameters.h"
+#include "riscvStructure.h"
+#include "riscvUtils.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Maximum number of mismatches reported individually by the local consumer
+//
+#define COSIM_MISMATCH_MAX  16
+
+DEFINE_S(cosimLocal);
+
+//
+// Local stand-in consumer state
+//
+typedef struct cosimLocalS {
+    FILE  *log;                         // record log file
+    FILE  *expect;                      // expected record file
+    Uns64  compared;                    // number of records compared
+    Uns64  mismatches;                  // number of mismatching records
+    Bool   expectEnd;                   // whether expected records exhausted
+} cosimLocal;
+
+//
+// Co-simulation state
+//
+typedef struct riscvCosimS {
+
+    // ring
+    riscvCosimRingP  ring;              // record ring
+    Uns32            ringBytes;         // record ring size in bytes
+    char            *shmName;           // shared memory object name
+    cosimLocalP      local;             // local consumer (if no shared memory)
+
+    // pending record
+    riscvCosimRecord pending;           // record for current instruction
+    Bool             pendingValid;      // whether pending record is valid
+    Bool             pendingMask;       // whether written masks are known
+    Uns32            pendingXMask;      // GPRs known to have been written
+    Uns32            pendingFMask;      // FPRs known to have been written
+    riscvCSRAttrsCP  csrs[RISCV_COSIM_CSRS];    // CSRs written
+    Uns64            seq;               // last allocated sequence number
+
+    // shadow register state
+    Uns64            x[32];             // GPR values after last record
+    Uns64            f[32];             // FPR values after last record
+    Uns32           *v;                 // vector register values (if present)
+    Uns32            vRegBytes;         // bytes per vector register
+
+} riscvCosim;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// SHARED STATE ACCESS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Read a field shared with the consumer
+//
+inline static Uns64 loadShared(Uns64 *field) {
+    return __atomic_load_n(field, __ATOMIC_ACQUIRE);
+}
+
+//
+// Write a field shared with the consumer
+//
+inline static void storeShared(Uns64 *field, Uns64 value) {
+    __atomic_store_n(field, value, __ATOMIC_RELEASE);
+}
+
+//
+// Yield while waiting for the external consumer
+//
+static void waitConsumer(void) {
+#if !defined(_WIN32)
+    sched_yield();
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// LOCAL CONSUMER
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Report a record field mismatch
+//
+static void reportMismatch(
+    riscvP            riscv,
+    riscvCosimRecordP actual,
+    const char       *field,
+    Uns64             expected,
+    Uns64             got
+) {
+    vmiMessage("W", CPU_PREFIX"_CSMM",
+        NO_SRCREF_FMT "Co-simulation mismatch at record "FMT_64u
+        " (PC 0x"FMT_6408x"): %s expected 0x"FMT_64x" got 0x"FMT_64x,
+        NO_SRCREF_ARGS(riscv), actual->seq, actual->PC, field, expected, got
+    );
+}
+
+//
+// Compare a record against the expected record, returning the number of
+// mismatching fields
+//
+static Uns32 compareRecord(
+    riscvP            riscv,
+    riscvCosimRecordP actual,
+    riscvCosimRecordP expect,
+    Bool              report
+) {
+    Uns32 errors = 0;
+    Uns32 i;
+
+    #define COMPARE_FIELD(_F, _NAME)                                    \
+        if(actual->_F != expect->_F) {                                  \
+            if(report) {                                                \
+                reportMismatch(                                         \
+                    riscv, actual, _NAME, expect->_F, actual->_F        \
+                );                                                      \
+            }                                                           \
+            errors++;                                                   \
+        }
+
+    COMPARE_FIELD(PC,         "PC");
+    COMPARE_FIELD(instr,      "instruction");
+    COMPARE_FIELD(flags,      "flags");
+    COMPARE_FIELD(cause,      "cause");
+    COMPARE_FIELD(tval,       "tval");
+    COMPARE_FIELD(xMask,      "GPR write mask");
+    COMPARE_FIELD(fMask,      "FPR write mask");
+    COMPARE_FIELD(vMask,      "vector write mask");
+    COMPARE_FIELD(csrCount,   "CSR write count");
+    COMPARE_FIELD(valueCount, "value count");
+    COMPARE_FIELD(mode,       "mode");
+
+    for(i=0; !errors && (i<actual->csrCount); i++) {
+        COMPARE_FIELD(csrNum[i], "CSR number");
+    }
+
+    for(i=0; !errors && (i<actual->valueCount); i++) {
+        COMPARE_FIELD(value[i], "value");
+    }
+
+    #undef COMPARE_FIELD
+
+    return errors;
+}
+
+//
+// Compare a record against the next expected record
+//
+static void checkRecord(
+    riscvP            riscv,
+    cosimLocalP       local,
+    riscvCosimRecordP record
+) {
+    riscvCosimRecord expect;
+
+    if(local->expectEnd) {
+
+        // no action once expected records are exhausted
+
+    } else if(fread(&expect, sizeof(expect), 1, local->expect)!=1) {
+
+        vmiMessage("W", CPU_PREFIX"_CSEE",
+            NO_SRCREF_FMT "Expected co-simulation records exhausted at record "
+            FMT_64u,
+            NO_SRCREF_ARGS(riscv), record->seq
+        );
+
+        local->expectEnd = True;
+
+    } else {
+
+        Bool report = (local->mismatches<COSIM_MISMATCH_MAX);
+
+        local->compared++;
+
+        if(compareRecord(riscv, record, &expect, report)) {
+
+            local->mismatches++;
+
+            if(local->mismatches==COSIM_MISMATCH_MAX) {
+                vmiMessage("W", CPU_PREFIX"_CSMS",
+                    NO_SRCREF_FMT "Further co-simulation mismatches suppressed",
+                    NO_SRCREF_ARGS(riscv)
+                );
+            }
+        }
+    }
+}
+
+//
+// Consume all published records using the local consumer
+//
+static void consumeLocal(riscvP riscv, riscvCosimP cosim) {
+
+    riscvCosimRingP ring  = cosim->ring;
+    cosimLocalP     local = cosim->local;
+    Uns64           tail  = ring->tail;
+
+    while(tail!=ring->head) {
+
+        riscvCosimRecordP record = &ring->records[tail & (ring->size-1)];
+
+        if(local->log) {
+            fwrite(record, sizeof(*record), 1, local->log);
+        }
+
+        if(local->expect) {
+            checkRecord(riscv, local, record);
+        }
+
+        tail++;
+    }
+
+    ring->tail = tail;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// RECORD PUBLICATION
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Publish a completed record to the ring
+//
+static void publishRecord(
+    riscvP            riscv,
+    riscvCosimP       cosim,
+    riscvCosimRecordP record
+) {
+    riscvCosimRingP ring = cosim->ring;
+    Uns64           head = ring->head;
+
+    // wait for the consumer to make space if the ring is full
+    while((head-loadShared(&ring->tail)) >= ring->size) {
+        waitConsumer();
+    }
+
+    ring->records[head & (ring->size-1)] = *record;
+    storeShared(&ring->head, head+1);
+
+    // local consumer handles the record immediately
+    if(cosim->local) {
+        consumeLocal(riscv, cosim);
+    }
+}
+
+//
+// Append a value to the record, indicating overflow if there is no space
+//
+static void addValue(riscvCosimRecordP record, Uns64 value) {
+
+    if(record->valueCount<RISCV_COSIM_VALUES) {
+        record->value[record->valueCount++] = value;
+    } else {
+        record->flags |= RVCF_OVERFLOW;
+    }
+}
+
+//
+// Return the byte offset of any deferred zero tail in the indexed vector
+// register (the register size if there is none)
+//
+static Uns32 getVZeroFrom(riscvP riscv, riscvCosimP cosim, Uns32 index) {
+
+    Bool pending = riscv->vZeroPending & (1<<index);
+
+    return pending ? riscv->vZeroFrom[index] : cosim->vRegBytes;
+}
+
+//
+// Does the architectural value of the indexed vector register differ from the
+// shadow copy? A deferred zero tail is compared as zero without completing it.
+//
+static Bool vRegChanged(riscvP riscv, riscvCosimP cosim, Uns32 index) {
+
+    Uns32  bytes   = cosim->vRegBytes;
+    Uns32  from    = getVZeroFrom(riscv, cosim, index);
+    Uns8  *current = (Uns8 *)&riscv->v[index*bytes/4];
+    Uns8  *shadow  = (Uns8 *)&cosim->v[index*bytes/4];
+    Bool   changed = memcmp(current, shadow, from);
+    Uns32  i;
+
+    for(i=from; !changed && (i<bytes); i++) {
+        changed = shadow[i];
+    }
+
+    return changed;
+}
+
+//
+// Copy the architectural value of the indexed vector register to the shadow
+// copy
+//
+static void syncVReg(riscvP riscv, riscvCosimP cosim, Uns32 index) {
+
+    Uns32  bytes   = cosim->vRegBytes;
+    Uns32  from    = getVZeroFrom(riscv, cosim, index);
+    Uns8  *current = (Uns8 *)&riscv->v[index*bytes/4];
+    Uns8  *shadow  = (Uns8 *)&cosim->v[index*bytes/4];
+
+    memcpy(shadow, current, from);
+    memset(&shadow[from], 0, bytes-from);
+}
+
+//
+// Copy current register state to the shadow copy. Only GPRs and FPRs in the
+// given masks and vector registers that could have been written since the last
+// record (indicated by cosimVMask, which is updated by JIT code) are copied.
+//
+static void syncShadow(
+    riscvP      riscv,
+    riscvCosimP cosim,
+    Uns32       xMask,
+    Uns32       fMask
+) {
+    Uns32 i;
+
+    if((xMask==-1) && (fMask==-1)) {
+
+        memcpy(cosim->x, riscv->x, sizeof(cosim->x));
+        memcpy(cosim->f, riscv->f, sizeof(cosim->f));
+
+    } else {
+
+        for(i=0; xMask; i++, xMask>>=1) {
+            if(xMask & 1) {cosim->x[i] = riscv->x[i];}
+        }
+        for(i=0; fMask; i++, fMask>>=1) {
+            if(fMask & 1) {cosim->f[i] = riscv->f[i];}
+        }
+    }
+
+    if(cosim->v) {
+
+        for(i=0; riscv->cosimVMask && (i<VREG_NUM); i++) {
+            if(riscv->cosimVMask & (1<<i)) {
+                syncVReg(riscv, cosim, i);
+            }
+        }
+    }
+
+    riscv->cosimVMask = 0;
+}
+
+//
+// Complete the pending record using register state changes since the last
+// record and publish it
+//
+static void commitPending(riscvP riscv, riscvCosimP cosim) {
+
+    riscvCosimRecordP record = &cosim->pending;
+    Uns32             xMask  = cosim->pendingXMask;
+    Uns32             fMask  = cosim->pendingFMask;
+    Uns32             vMask  = 0;
+    Uns32             i;
+
+    // find changed GPRs and FPRs by comparison with the shadow copy only if
+    // the registers written by the instruction are not known (it was the last
+    // instruction in its block)
+    if(!cosim->pendingMask) {
+        for(i=0; i<32; i++) {
+            if(riscv->x[i]!=cosim->x[i]) {xMask |= 1<<i;}
+            if(riscv->f[i]!=cosim->f[i]) {fMask |= 1<<i;}
+        }
+    }
+
+    // find changed vector registers among those that could have been written
+    if(cosim->v) {
+        for(i=0; i<VREG_NUM; i++) {
+            if(!(riscv->cosimVMask & (1<<i))) {
+                // not written
+            } else if(vRegChanged(riscv, cosim, i)) {
+                vMask |= 1<<i;
+            }
+        }
+    }
+
+    // x0 is never written
+    xMask &= ~1;
+
+    record->xMask = xMask;
+    record->fMask = fMask;
+    record->vMask = vMask;
+    record->mode  = getCurrentMode(riscv);
+
+    // append written GPR and FPR values
+    for(i=0; i<32; i++) {
+        if(xMask & (1<<i)) {addValue(record, riscv->x[i]);}
+    }
+    for(i=0; i<32; i++) {
+        if(fMask & (1<<i)) {addValue(record, riscv->f[i]);}
+    }
+
+    // append written CSR values (read as artifacts)
+    for(i=0; i<record->csrCount; i++) {
+
+        Bool  old   = riscv->artifactAccess;
+        Uns64 value = 0;
+
+        riscv->artifactAccess = True;
+        riscvReadCSR(cosim->csrs[i], riscv, &value);
+        riscv->artifactAccess = old;
+
+        addValue(record, value);
+    }
+
+    publishRecord(riscv, cosim, record);
+    syncShadow(riscv, cosim, xMask, fMask);
+
+    cosim->pendingValid = False;
+}
+
+//
+// Start a new record
+//
+static void startRecord(
+    riscvCosimP       cosim,
+    riscvCosimRecordP record,
+    Uns64             PC,
+    Uns32             instr
+) {
+    memset(record, 0, sizeof(*record));
+
+    record->seq   = ++cosim->seq;
+    record->PC    = PC;
+    record->instr = instr;
+}
+
+//
+// Wait until the testbench allows the record with the given sequence number
+// to start (stepping is never enabled for the local consumer)
+//
+static void waitStep(riscvCosimP cosim, Uns64 seq) {
+
+    riscvCosimRingP ring = cosim->ring;
+
+    while(loadShared(&ring->stepping) && (seq>loadShared(&ring->stepLimit))) {
+        waitConsumer();
+    }
+}
+
+//
+// Apply any interrupt change requested by the testbench after the record with
+// the given sequence number has retired, acknowledging it in a model-owned
+// field (irqSeq is written only by the testbench)
+//
+static void applyInterrupt(riscvP riscv, riscvCosimP cosim, Uns64 seq) {
+
+    riscvCosimRingP ring = cosim->ring;
+
+    if(loadShared(&ring->irqSeq)==seq) {
+
+        riscvSetInterruptPending(riscv, ring->irqIndex, ring->irqValue);
+
+        storeShared(&ring->irqAck, seq);
+    }
+}
+
+//
+// Publish the record for the previous instruction and start a new record for
+// the instruction at the given address (called from JIT code)
+//
+void riscvCosimRetire(
+    riscvP riscv,
+    Uns64  PC,
+    Uns32  instr,
+    Uns32  xMask,
+    Uns32  fMask,
+    Bool   maskValid
+) {
+    riscvCosimP cosim = riscv->cosim;
+
+    // publish the previous instruction record or discard register changes
+    // made since the last record (for example, by a trapped instruction)
+    if(cosim->pendingValid) {
+        cosim->pendingXMask = xMask;
+        cosim->pendingFMask = fMask;
+        cosim->pendingMask  = maskValid;
+        commitPending(riscv, cosim);
+    } else {
+        syncShadow(riscv, cosim, -1, -1);
+    }
+
+    // start a record for this instruction
+    startRecord(cosim, &cosim->pending, PC, instr);
+    cosim->pendingValid = True;
+    cosim->pendingXMask = 0;
+    cosim->pendingFMask = 0;
+    cosim->pendingMask  = False;
+
+    // wait for the testbench if stepping
+    waitStep(cosim, cosim->seq);
+
+    // interrupt state changes are applied while this instruction executes so
+    // that any resulting interrupt is taken when it retires
+    applyInterrupt(riscv, cosim, cosim->seq);
+}
+
+//
+// Record a CSR write by the current instruction (called from JIT code)
+//
+void riscvCosimCSRWrite(riscvP riscv, riscvCSRAttrsCP attrs) {
+
+    riscvCosimP       cosim  = riscv->cosim;
+    riscvCosimRecordP record = &cosim->pending;
+
+    if(!cosim->pendingValid) {
+
+        // no action if not executing a recorded instruction
+
+    } else if(record->csrCount<RISCV_COSIM_CSRS) {
+
+        cosim->csrs[record->csrCount]     = attrs;
+        record->csrNum[record->csrCount++] = attrs->csrNum;
+
+    } else {
+
+        record->flags |= RVCF_OVERFLOW;
+    }
+}
+
+//
+// Record an exception or interrupt before it is taken
+//
+void riscvCosimTrap(
+    riscvP         riscv,
+    riscvException exception,
+    Uns64          EPC,
+    Uns64          tval
+) {
+    riscvCosimP       cosim  = riscv->cosim;
+    riscvCosimRecordP record = &cosim->pending;
+    Bool              isInt  = isInterrupt(exception);
+    Uns64             cause  = getExceptionCode(exception);
+    riscvCosimRecord  trap;
+
+    if(!isInt && cosim->pendingValid && (record->PC==EPC)) {
+
+        // the pending instruction raised the exception (register writes are
+        // discarded and CSR writes are not reported)
+        record->csrCount = 0;
+        record->flags    = RVCF_TRAP;
+
+    } else {
+
+        // any pending instruction retired before the trap
+        if(cosim->pendingValid) {
+            commitPending(riscv, cosim);
+        }
+
+        // the trap is not associated with an executed instruction (interrupt
+        // or instruction fetch exception)
+        record = &trap;
+        startRecord(cosim, record, EPC, 0);
+        record->flags = isInt ? RVCF_INTERRUPT : RVCF_TRAP;
+    }
+
+    // interrupt causes have the most-significant bit set
+    record->cause = isInt ? (cause | (1ULL<<63)) : cause;
+    record->tval  = tval;
+    record->mode  = getCurrentMode(riscv);
+
+    publishRecord(riscv, cosim, record);
+
+    cosim->pendingValid = False;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION AND DESTRUCTION
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return the smallest power of two not less than the given value
+//
+static Uns32 ringRecords(Uns32 records) {
+
+    Uns32 result = 2;
+
+    while(result<records) {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+//
+// Open a local consumer file, returning NULL on failure
+//
+static FILE *openLocalFile(riscvP riscv, const char *file, const char *mode) {
+
+    FILE *result = fopen(file, mode);
+
+    if(!result) {
+        vmiMessage("W", CPU_PREFIX"_CSFO",
+            NO_SRCREF_FMT "Cannot open co-simulation file '%s'",
+            NO_SRCREF_ARGS(riscv), file
+        );
+    }
+
+    return result;
+}
+
+//
+// Allocate ring in shared memory, returning NULL on failure
+//
+static riscvCosimRingP newSharedRing(riscvP riscv, riscvCosimP cosim) {
+
+    riscvCosimRingP ring = 0;
+
+#if !defined(_WIN32)
+
+    Int32 fd = shm_open(cosim->shmName, O_CREAT|O_RDWR, 0600);
+
+    if(fd<0) {
+
+        // no action if object cannot be created
+
+    } else if(ftruncate(fd, cosim->ringBytes)) {
+
+        close(fd);
+
+    } else {
+
+        void *base = mmap(
+            0, cosim->ringBytes, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0
+        );
+
+        close(fd);
+
+        if(base!=MAP_FAILED) {
+            ring = base;
+            memset(ring, 0, cosim->ringBytes);
+        }
+    }
+
+#endif
+
+    if(!ring) {
+        vmiMessage("W", CPU_PREFIX"_CSSM",
+            NO_SRCREF_FMT "Cannot create co-simulation shared memory '%s' - "
+            "using local consumer",
+            NO_SRCREF_ARGS(riscv), cosim->shmName
+        );
+    }
+
+    return ring;
+}
+
+//
+// Allocate co-simulation structures if required
+//
+void riscvNewCosim(riscvP riscv, riscvParamValuesP params) {
+
+    const char *shm    = params->cosim_shm;
+    const char *log    = params->cosim_log;
+    const char *expect = params->cosim_expect;
+
+    if(shm[0] || log[0] || expect[0]) {
+
+        riscvCosimP cosim   = STYPE_CALLOC(riscvCosim);
+        Uns32       records = ringRecords(params->cosim_ring);
+
+        riscv->cosim     = cosim;
+        cosim->ringBytes = (
+            sizeof(riscvCosimRing) + (records*sizeof(riscvCosimRecord))
+        );
+
+        // allocate ring in shared memory if required, using per-hart name
+        if(shm[0]) {
+
+            const char *name = vmirtProcessorName((vmiProcessorP)riscv);
+            Uns32       len  = strlen(shm) + strlen(name) + 3;
+
+            cosim->shmName = STYPE_CALLOC_N(char, len);
+            snprintf(
+                cosim->shmName, len, "%s%s_%s", (shm[0]=='/') ? "" : "/",
+                shm, name
+            );
+
+            cosim->ring = newSharedRing(riscv, cosim);
+        }
+
+        // use local consumer if ring is not in shared memory
+        if(!cosim->ring) {
+
+            void *base = STYPE_CALLOC_N(Uns8, cosim->ringBytes);
+
+            cosim->ring  = base;
+            cosim->local = STYPE_CALLOC(cosimLocal);
+
+            if(log[0]) {
+                cosim->local->log = openLocalFile(riscv, log, "wb");
+            }
+            if(expect[0]) {
+                cosim->local->expect = openLocalFile(riscv, expect, "rb");
+            }
+
+        } else if(log[0] || expect[0]) {
+
+            vmiMessage("W", CPU_PREFIX"_CSLI",
+                NO_SRCREF_FMT "Co-simulation log and expected files ignored "
+                "when using shared memory",
+                NO_SRCREF_ARGS(riscv)
+            );
+        }
+
+        // stepping requires a testbench to raise the step limit, so is
+        // disabled if the ring could not be shared
+        if(params->cosim_stepping && cosim->local) {
+            vmiMessage("W", CPU_PREFIX"_CSSD",
+                NO_SRCREF_FMT "Co-simulation stepping requires shared memory "
+                "- stepping disabled",
+                NO_SRCREF_ARGS(riscv)
+            );
+        }
+
+        // initialize ring header (the model waits for the testbench before
+        // the first instruction if stepping is enabled)
+        cosim->ring->magic    = RISCV_COSIM_MAGIC;
+        cosim->ring->version  = RISCV_COSIM_VERSION;
+        cosim->ring->size     = records;
+        cosim->ring->stepping = params->cosim_stepping && !cosim->local;
+
+        // allocate vector register shadow if required
+        if(riscv->v) {
+            cosim->vRegBytes = riscv->configInfo.VLEN/8;
+            cosim->v = STYPE_CALLOC_N(Uns32, (cosim->vRegBytes/4)*VREG_NUM);
+        }
+
+        // initialize shadow copy of all registers
+        riscv->cosimVMask = -1;
+        syncShadow(riscv, cosim, -1, -1);
+    }
+}
+
+//
+// Publish any pending record and free co-simulation structures
+//
+void riscvFreeCosim(riscvP riscv) {
+
+    riscvCosimP cosim = riscv->cosim;
+
+    if(cosim) {
+
+        cosimLocalP local = cosim->local;
+
+        // the last executed instruction has retired
+        if(cosim->pendingValid) {
+            commitPending(riscv, cosim);
+        }
+
+        storeShared(&cosim->ring->done, 1);
+
+        if(local) {
+
+            if(local->log) {
+                fclose(local->log);
+            }
+
+            if(local->expect) {
+
+                vmiMessage("I", CPU_PREFIX"_CSSU",
+                    NO_SRCREF_FMT "Co-simulation compared "FMT_64u" records, "
+                    FMT_64u" mismatches",
+                    NO_SRCREF_ARGS(riscv), local->compared, local->mismatches
+                );
+
+                fclose(local->expect);
+            }
+
+            STYPE_FREE(local);
+            STYPE_FREE(cosim->ring);
+
+        } else {
+
+#if !defined(_WIN32)
+            // the testbench keeps any existing mapping after the name is
+            // removed
+            munmap(cosim->ring, cosim->ringBytes);
+            shm_unlink(cosim->shmName);
+#endif
+        }
+
+        if(cosim->shmName) {
+            STYPE_FREE(cosim->shmName);
+        }
+
+        if(cosim->v) {
+            STYPE_FREE(cosim->v);
+        }
+
+        STYPE_FREE(cosim);
+
+        riscv->cosim = 0;
+    }
+}
+
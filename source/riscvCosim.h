@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+// basic types
+#include "hostapi/impTypes.h"
+
+// model header files
+#include "riscvExceptionTypes.h"
+#include "riscvTypeRefs.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// SHARED MEMORY INTERFACE
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// The definitions in this section describe the layout of the co-simulation
+// ring in shared memory and are intended to be used by external testbenches.
+// Fields written by the model are marked (M); fields written by the testbench
+// are marked (T). Head, tail and control fields should be accessed with
+// acquire/release semantics.
+//
+
+#define RISCV_COSIM_MAGIC   0x4d49534f43435652ULL   // "RVCCOSIM"
+#define RISCV_COSIM_VERSION 2
+#define RISCV_COSIM_CSRS    4       // maximum CSR writes in a record
+#define RISCV_COSIM_VALUES  8       // maximum written values in a record
+
+//
+// Retire record flags
+//
+typedef enum riscvCosimFlagsE {
+    RVCF_TRAP      = 0x1,           // instruction raised an exception
+    RVCF_INTERRUPT = 0x2,           // interrupt taken at this boundary
+    RVCF_OVERFLOW  = 0x4,           // too many writes to record all values
+} riscvCosimFlags;
+
+DEFINE_S(riscvCosimRecord);
+DEFINE_S(riscvCosimRing);
+
+//
+// Retire record. The value array holds the new values of written GPRs (in
+// ascending order of xMask), then written FPRs (fMask) then written CSRs
+// (csrNum), truncated to RISCV_COSIM_VALUES entries. Vector register writes
+// are indicated by vMask only.
+//
+typedef struct riscvCosimRecordS {
+    Uns64 seq;                          // record sequence number (from 1)
+    Uns64 PC;                           // instruction address or EPC
+    Uns64 cause;                        // cause if trap or interrupt
+    Uns64 tval;                         // trap value if trap or interrupt
+    Uns32 instr;                        // instruction (0 if not fetched)
+    Uns32 flags;                        // riscvCosimFlags
+    Uns32 xMask;                        // mask of written GPRs
+    Uns32 fMask;                        // mask of written FPRs
+    Uns32 vMask;                        // mask of written vector registers
+    Uns32 csrCount;                     // number of written CSRs
+    Uns32 valueCount;                   // number of valid entries in value
+    Uns32 mode;                         // privilege mode after retirement
+    Uns16 csrNum[RISCV_COSIM_CSRS];     // numbers of written CSRs
+    Uns64 value[RISCV_COSIM_VALUES];    // written register values
+} riscvCosimRecord;
+
+//
+// Ring control block, followed in memory by the record array
+//
+typedef struct riscvCosimRingS {
+    Uns64 magic;                        // (M) RISCV_COSIM_MAGIC
+    Uns32 version;                      // (M) RISCV_COSIM_VERSION
+    Uns32 size;                         // (M) record count (power of two)
+    Uns64 head;                         // (M) records published
+    Uns64 tail;                         // (T) records consumed
+    Uns64 done;                         // (M) non-zero when model has ended
+    Uns64 stepping;                     // (T) non-zero to enable stepping
+    Uns64 stepLimit;                    // (T) last record allowed to start
+    Uns64 irqSeq;                       // (T) apply interrupt change after seq
+    Uns64 irqIndex;                     // (T) interrupt port index to change
+    Uns64 irqValue;                     // (T) new interrupt port value
+    Uns64 irqAck;                       // (M) irqSeq of last applied change
+    riscvCosimRecord records[];         // (M) record array
+} riscvCosimRing;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// MODEL INTERFACE
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Allocate co-simulation structures if required
+//
+void riscvNewCosim(riscvP riscv, riscvParamValuesP params);
+
+//
+// Publish any pending record and free co-simulation structures
+//
+void riscvFreeCosim(riscvP riscv);
+
+//
+// Publish the record for the previous instruction and start a new record for
+// the instruction at the given address (called from JIT code). The xMask and
+// fMask arguments are the masks of GPRs and FPRs written by the previous
+// instruction if maskValid is True.
+//
+void riscvCosimRetire(
+    riscvP riscv,
+    Uns64  PC,
+    Uns32  instr,
+    Uns32  xMask,
+    Uns32  fMask,
+    Bool   maskValid
+);
+
+//
+// Record a CSR write by the current instruction (called from JIT code)
+//
+void riscvCosimCSRWrite(riscvP riscv, riscvCSRAttrsCP attrs);
+
+//
+// Record an exception or interrupt before it is taken
+//
+void riscvCosimTrap(
+    riscvP         riscv,
+    riscvException exception,
+    Uns64          EPC,
+    Uns64          tval
+);
+
@@ -17,6 +17,9 @@
  *
  */
 
+// standard header files
+#include <string.h>
+
 // Imperas header files
 #include "hostapi/impAlloc.h"
 
@@ -248,6 +251,40 @@ inline static riscvCSRAttrsCP getCSRAttrs(vmiRegInfoCP reg) {
     return reg->userData;
 }
 
+//
+// Read processor vector register
+//
+static VMI_REG_READ_FN(readVR) {
+
+    riscvP riscv     = (riscvP)processor;
+    Uns32  index     = (UnsPS)reg->userData;
+    Uns32  vRegBytes = riscv->configInfo.VLEN/8;
+
+    // complete any deferred tail zeroing before the register is observed
+    riscvVZeroPending(riscv, index, vRegBytes);
+
+    memcpy(buffer, &riscv->v[index*vRegBytes/4], vRegBytes);
+
+    return True;
+}
+
+//
+// Write processor vector register
+//
+static VMI_REG_WRITE_FN(writeVR) {
+
+    riscvP riscv     = (riscvP)processor;
+    Uns32  index     = (UnsPS)reg->userData;
+    Uns32  vRegBytes = riscv->configInfo.VLEN/8;
+
+    // complete any deferred tail zeroing so it does not overwrite the new value
+    riscvVZeroPending(riscv, index, vRegBytes);
+
+    memcpy(&riscv->v[index*vRegBytes/4], buffer, vRegBytes);
+
+    return True;
+}
+
 //
 // Read callback for AArch64 system register, current view
 //
@@ -400,6 +437,9 @@ static vmiRegInfoCP getRegisters(riscvP riscv, Bool normal) {
             dst->gdbIndex = i+RISCV_V0_INDEX;
             dst->access   = vmi_RA_RW;
             dst->raw      = riscvGetVReg(riscv, i);
+            dst->readCB   = readVR;
+            dst->writeCB  = writeVR;
+            dst->userData = (void *)(UnsPS)i;
             dst++;
         }
 
@@ -539,6 +579,254 @@ VMI_REG_INFO_FN(riscvRegInfo) {
     return getNextRegister((riscvP)processor, prev, gdbFrame);
 }
 
+
+
+////////////////////////////////////////////////////////////////////////////////
+// BULK REGISTER GROUP ACCESS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// How a register in a group is read or written
+//
+typedef enum regGroupAccessE {
+    RGA_NONE,           // not accessible
+    RGA_CSR,            // CSR accessed by callback
+    RGA_CB,             // other register accessed by callback
+    RGA_RAW,            // register accessed directly
+} regGroupAccess;
+
+//
+// One register in a register group index
+//
+typedef struct regGroupEntryS {
+    vmiRegInfoCP    reg;        // register description
+    riscvCSRAttrsCP attrs;      // CSR attributes (if RGA_CSR)
+    Uns32           offset;     // byte offset in group buffer
+    Uns32           bytes;      // bytes in group buffer
+    regGroupAccess  rdAccess;   // read access type
+    regGroupAccess  wrAccess;   // write access type
+} regGroupEntry, *regGroupEntryP;
+
+//
+// Index of registers in one register group
+//
+typedef struct regGroupS {
+    regGroupEntryP entries;     // registers in group, in register list order
+    Uns32          num;         // number of registers
+    Uns32          bytes;       // group buffer size
+} regGroup, *regGroupP;
+
+//
+// Index of registers in all register groups
+//
+typedef struct riscvRegGroupsS {
+    regGroup groups[RV_RG_LAST];
+} riscvRegGroups;
+
+//
+// Return read access type for a register
+//
+static regGroupAccess getReadAccess(vmiRegInfoCP reg) {
+
+    if(!(reg->access & vmi_RA_R)) {
+        return RGA_NONE;
+    } else if(reg->readCB==readCSR) {
+        return RGA_CSR;
+    } else if(reg->readCB) {
+        return RGA_CB;
+    } else {
+        return RGA_RAW;
+    }
+}
+
+//
+// Return write access type for a register
+//
+static regGroupAccess getWriteAccess(vmiRegInfoCP reg) {
+
+    if(!(reg->access & vmi_RA_W)) {
+        return RGA_NONE;
+    } else if(reg->writeCB==writeCSR) {
+        return RGA_CSR;
+    } else if(reg->writeCB) {
+        return RGA_CB;
+    } else {
+        return RGA_RAW;
+    }
+}
+
+//
+// Return the register group index, creating it from the normal register view
+// on first use so that bulk accesses need no register iteration
+//
+static riscvRegGroupsP getRegGroups(riscvP riscv) {
+
+    if(!riscv->regGroups) {
+
+        riscvRegGroupsP index = STYPE_CALLOC(riscvRegGroups);
+        vmiRegInfoCP    reg   = 0;
+        Uns32           i;
+
+        // count registers in each group
+        while((reg=getNextRegister(riscv, reg, VMIRIT_NORMAL))) {
+            index->groups[reg->group-groups].num++;
+        }
+
+        // allocate group entries
+        for(i=0; i<RV_RG_LAST; i++) {
+
+            regGroupP group = &index->groups[i];
+
+            if(group->num) {
+                group->entries = STYPE_CALLOC_N(regGroupEntry, group->num);
+                group->num     = 0;
+            }
+        }
+
+        // fill group entries
+        while((reg=getNextRegister(riscv, reg, VMIRIT_NORMAL))) {
+
+            regGroupP      group = &index->groups[reg->group-groups];
+            regGroupEntryP entry = &group->entries[group->num++];
+
+            entry->reg      = reg;
+            entry->attrs    = reg->userData;
+            entry->offset   = group->bytes;
+            entry->bytes    = (reg->bits+7)/8;
+            entry->rdAccess = getReadAccess(reg);
+            entry->wrAccess = getWriteAccess(reg);
+
+            group->bytes += entry->bytes;
+        }
+
+        riscv->regGroups = index;
+    }
+
+    return riscv->regGroups;
+}
+
+//
+// Return the index for the passed register group, or NULL if it is not a
+// group of this processor
+//
+static regGroupP getRegGroup(riscvP riscv, vmiRegGroupCP group) {
+
+    if((group<groups) || (group>=&groups[RV_RG_LAST])) {
+        return 0;
+    } else {
+        return &getRegGroups(riscv)->groups[group-groups];
+    }
+}
+
+//
+// Read all registers in a register group into a buffer in register list
+// order, returning the number of bytes required (no registers are read if the
+// buffer is too small)
+//
+RISCV_READ_REG_GROUP_FN(riscvReadRegGroup) {
+
+    regGroupP regs     = getRegGroup(riscv, group);
+    Uns32     required = regs ? regs->bytes : 0;
+
+    if(required && (bytes>=required)) {
+
+        vmiProcessorP processor = (vmiProcessorP)riscv;
+        Bool          old       = riscv->artifactAccess;
+        Uns32         i;
+
+        // all CSR reads in the group are artifact accesses
+        riscv->artifactAccess = True;
+
+        for(i=0; i<regs->num; i++) {
+
+            regGroupEntryP entry = &regs->entries[i];
+            vmiRegInfoCP   reg   = entry->reg;
+            Uns8          *dst   = (Uns8 *)buffer + entry->offset;
+            Bool           ok    = False;
+
+            if(entry->rdAccess==RGA_CSR) {
+                ok = riscvReadCSR(entry->attrs, riscv, dst);
+            } else if(entry->rdAccess==RGA_CB) {
+                ok = reg->readCB(processor, reg, dst);
+            } else if(entry->rdAccess==RGA_RAW) {
+                ok = vmirtRegRead(processor, reg, dst);
+            }
+
+            // unreadable registers read as zero
+            if(!ok) {
+                memset(dst, 0, entry->bytes);
+            }
+        }
+
+        riscv->artifactAccess = old;
+    }
+
+    return required;
+}
+
+//
+// Write all writable registers in a register group from a buffer with the
+// layout used by riscvReadRegGroup, returning the number of bytes required
+// (no registers are written if the buffer is too small)
+//
+RISCV_WRITE_REG_GROUP_FN(riscvWriteRegGroup) {
+
+    regGroupP regs     = getRegGroup(riscv, group);
+    Uns32     required = regs ? regs->bytes : 0;
+
+    if(required && (bytes>=required)) {
+
+        vmiProcessorP processor = (vmiProcessorP)riscv;
+        Bool          old       = riscv->artifactAccess;
+        Uns32         i;
+
+        // all CSR writes in the group are artifact accesses
+        riscv->artifactAccess = True;
+
+        for(i=0; i<regs->num; i++) {
+
+            regGroupEntryP entry = &regs->entries[i];
+            vmiRegInfoCP   reg   = entry->reg;
+            const Uns8    *src   = (const Uns8 *)buffer + entry->offset;
+
+            if(entry->wrAccess==RGA_CSR) {
+                riscvWriteCSR(entry->attrs, riscv, src);
+            } else if(entry->wrAccess==RGA_CB) {
+                reg->writeCB(processor, reg, src);
+            } else if(entry->wrAccess==RGA_RAW) {
+                vmirtRegWrite(processor, reg, src);
+            }
+        }
+
+        riscv->artifactAccess = old;
+    }
+
+    return required;
+}
+
+//
+// Free register group index, if it has been allocated
+//
+static void freeRegGroups(riscvP riscv) {
+
+    riscvRegGroupsP index = riscv->regGroups;
+
+    if(index) {
+
+        Uns32 i;
+
+        for(i=0; i<RV_RG_LAST; i++) {
+            if(index->groups[i].entries) {
+                STYPE_FREE(index->groups[i].entries);
+            }
+        }
+
+        STYPE_FREE(index);
+
+        riscv->regGroups = 0;
+    }
+}
+
 //
 // Free register descriptions, if they have been allocated
 //
@@ -546,6 +834,9 @@ void riscvFreeRegInfo(riscvP riscv) {
 
     Uns32 i;
 
+    // free register group index (refers to register descriptions)
+    freeRegGroups(riscv);
+
     for(i=0; i<2; i++) {
         if(riscv->regInfo[i]) {
             STYPE_FREE(riscv->regInfo[i]);
@@ -23,6 +23,7 @@
 #include "hostapi/impTypes.h"
 
 // model header files
+#include "riscvModelCallbacks.h"
 #include "riscvTypeRefs.h"
 #include "riscvVariant.h"
 
@@ -31,3 +32,13 @@
 //
 void riscvFreeRegInfo(riscvP riscv);
 
+//
+// Read all registers in a register group into a buffer
+//
+RISCV_READ_REG_GROUP_FN(riscvReadRegGroup);
+
+//
+// Write all writable registers in a register group from a buffer
+//
+RISCV_WRITE_REG_GROUP_FN(riscvWriteRegGroup);
+
@@ -1961,7 +1961,27 @@ void riscvDoc(riscvP rootProcessor) {
                 "setting dcsr.step. After one non-Debug-mode instruction "
                 "has been executed, control will be returned to the harness. "
                 "The processor will remain in single-step mode until dcsr.step "
-                "is cleared."
+                "is cleared. Interrupts (including NMI) are disabled while "
+                "stepping unless dcsr.stepie is set."
+            );
+            vmidocAddText(
+                DebugExecution,
+                "Enhanced model callback debugStep allows a harness to "
+                "request a number of single steps, or to step until the "
+                "instruction at a given address is reached or a condition "
+                "function returns True, in one call. The processor leaves "
+                "Debug mode once and runs translated code, re-entering Debug "
+                "mode with dcsr.cause set to step only at the final stop. The "
+                "result is identical to the same number of single steps, "
+                "including interrupt handling controlled by dcsr.stepie. A "
+                "condition function is called at the end of every step, so a "
+                "step using one runs more slowly than one using only a count "
+                "or address. If a step with no step count reaches a WFI "
+                "instruction with dcsr.stepie clear, interrupts are enabled "
+                "for the rest of the step so that it cannot wait forever for "
+                "an interrupt that is never taken. Any other entry to Debug "
+                "mode (for example, ebreak, a trigger or haltreq) ends the "
+                "sequence early."
             );
         }
 
@@ -1992,6 +2012,54 @@ void riscvDoc(riscvP rootProcessor) {
         }
     }
 
+    ////////////////////////////////////////////////////////////////////////////
+    // DEBUG TRIGGERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    if(cfg->trigger_num) {
+
+        vmiDocNodeP triggers = vmidocAddSection(Root, "Debug Triggers");
+
+        snprintf(
+            SNPRINTF_TGT(string),
+            "This variant implements %u debug triggers, accessed using CSRs "
+            "tselect, tdata1, tdata2 and tdata3 (parameter \"trigger_num\"). "
+            "Trigger types mcontrol (address/data match), icount, itrigger "
+            "and etrigger are supported. Writing any other type to tdata1 "
+            "creates a disabled mcontrol trigger.",
+            cfg->trigger_num
+        );
+        vmidocAddText(triggers, string);
+
+        vmidocAddText(
+            triggers,
+            "Execute triggers are compiled into translated code, so "
+            "instructions that match no trigger run at full speed. Changing "
+            "the address or modes of an execute trigger discards translated "
+            "code. Execute triggers fire before the instruction executes "
+            "(timing 0)."
+        );
+
+        vmidocAddText(
+            triggers,
+            "Load and store triggers are implemented using memory watchpoints "
+            "on the address range selected by the match type, so other "
+            "accesses are not checked. These triggers fire after the access "
+            "completes (timing 1). Data value triggers (select 1) must watch "
+            "all addresses and are correspondingly slower."
+        );
+
+        vmidocAddText(
+            triggers,
+            "Match types 0 (equal), 1 (NAPOT), 2 (greater or equal) and 3 "
+            "(less than) are supported. Fields chain, sizelo and sizehi are "
+            "hardwired to zero, tdata3 is hardwired to zero and the nmi field "
+            "of itrigger is not implemented. Action 1 (enter Debug mode) may "
+            "be selected only when dmode is set, which is possible only in "
+            "Debug mode."
+        );
+    }
+
     ////////////////////////////////////////////////////////////////////////////
     // DEBUG MASK
     ////////////////////////////////////////////////////////////////////////////
@@ -2074,6 +2142,290 @@ void riscvDoc(riscvP rootProcessor) {
                 "externally as described above."
             );
         }
+
+        leafSection = vmidocAddSection(integration, "Function Profiling");
+
+        vmidocAddText(
+            leafSection,
+            "If parameter \"enable_profile\" is True, calls and returns "
+            "identified by the standard link register conventions (JAL/JALR "
+            "with rd=ra, and JALR with rs1=ra) are used to maintain a shadow "
+            "call stack for each hart. Exclusive and inclusive instruction "
+            "and cycle counts are accumulated for each function, together "
+            "with call counts for each caller/callee pair. Tail calls that do "
+            "not write the link register are attributed to the caller."
+        );
+
+        vmidocAddText(
+            leafSection,
+            "At the end of simulation, the profile is written in callgrind "
+            "format to a file with name given by parameter \"profile_file\" "
+            "followed by the hart name (for example, callgrind.out.cpu0). The "
+            "file may be viewed using tools such as kcachegrind or "
+            "callgrind_annotate. Function names are obtained from the loaded "
+            "symbol files, where available."
+        );
+
+        vmidocAddText(
+            leafSection,
+            "Commands \"profileStart\" and \"profileStop\" may be used to "
+            "restrict profiling to a region of interest, and command "
+            "\"profileReport\" prints a flat profile of the functions with "
+            "the highest exclusive instruction counts."
+        );
+
+        vmidocAddText(
+            leafSection,
+            "If parameter \"profile_sample\" is non-zero, the shadow call "
+            "stack and current PC are sampled after every \"profile_sample\" "
+            "instructions, with samples accumulated per hart. At the end of "
+            "simulation, the samples are written in folded stack format to a "
+            "file with name given by parameter \"profile_file\" followed by "
+            "the hart name and suffix \".folded\" (for example, "
+            "callgrind.out.cpu0.folded), suitable for flamegraph.pl. Sampling "
+            "may be used without \"enable_profile\", in which case no "
+            "callgrind profile is written, calls and returns are not "
+            "instrumented, and each sample instead records the call stack by "
+            "walking the frame pointer chain in register s0 (up to 64 "
+            "frames). This requires code compiled with "
+            "-fno-omit-frame-pointer; functions that do not create a frame "
+            "are omitted from the sampled stack."
+        );
+
+        leafSection = vmidocAddSection(integration, "Cache Model");
+
+        vmidocAddText(
+            leafSection,
+            "An optional set-associative cache model can be enabled using "
+            "parameters \"L1I_size\", \"L1D_size\" and \"L2_size\" (cache "
+            "sizes in bytes, 0 if absent) with associativity specified by "
+            "parameters \"L1I_ways\", \"L1D_ways\" and \"L2_ways\". All "
+            "caches use a common line size specified by parameter "
+            "\"cache_line\" and replacement policy specified by parameter "
+            "\"cache_replace\". Instruction fetches, loads and stores "
+            "(including AMO and vector accesses) are recorded in a per-hart "
+            "buffer that is applied to the cache model in batches; a load or "
+            "store wholly within the most-recent data line is counted as a "
+            "hit without being buffered. Accesses are recorded only when they "
+            "complete without an exception. Caches are physically indexed and "
+            "tagged, write-allocate and have no effect on timing or memory "
+            "contents. Caches are not affected by satp writes or sfence.vma "
+            "instructions; the L1I cache is invalidated by fence.i."
+        );
+
+        vmidocAddText(
+            leafSection,
+            "When the cache model is enabled, mhpmevent3-mhpmevent31 select "
+            "cache events to be counted by the corresponding mhpmcounter "
+            "registers: 1=L1I access, 2=L1I miss, 3=L1D access, 4=L1D miss, "
+            "5=L2 access, 6=L2 miss. These counters are stopped by the "
+            "corresponding mcountinhibit bits. Command \"cacheReport\" "
+            "prints cache statistics, which are also printed at the end of "
+            "simulation if parameter \"verbose\" is True."
+        );
+
+        leafSection = vmidocAddSection(
+            integration, "Branch Trace and Predictor Models"
+        );
+
+        vmidocAddText(
+            leafSection,
+            "If parameter \"branch_trace\" is non-empty, a compressed branch "
+            "trace is written to a file with that name followed by the hart "
+            "name. The trace is a byte stream of packets. A packet with "
+            "header 0x00-0x1f holds 1-32 outcome bits (header value plus one) "
+            "in the following bytes, least-significant bit first. Each "
+            "conditional branch contributes one outcome bit (1 if taken). "
+            "Each return (JALR with rs1=ra) also contributes one bit: 1 if "
+            "the target matches a 32-entry return address stack pushed by "
+            "calls (JAL/JALR with rd=ra), or 0 if it is followed by an "
+            "explicit target. Packet 0x20 gives an explicit indirect target "
+            "as a ULEB128 value XORed with the previous explicit target. "
+            "Packet 0x21 gives a ULEB128 new PC at trace start and after "
+            "each exception, interrupt or exception return. Each exception, "
+            "interrupt or NMI is preceded by packet 0x22, which gives ULEB128 "
+            "values of the cause (exception code shifted left by one, with "
+            "bit 0 set for interrupts), EPC and tval. Direct jumps produce "
+            "no packets."
+        );
+
+        vmidocAddText(
+            leafSection,
+            "Parameter \"branch_predictor\" selects a conditional branch "
+            "predictor model (bimodal, gshare or a simplified TAGE), with "
+            "table size given by parameter \"branch_predictor_bits\". "
+            "Returns are predicted using a return address stack of depth "
+            "\"branch_ras_depth\" and other indirect jumps using a target "
+            "buffer. Overall misprediction rates and the branches with the "
+            "most mispredictions are printed at the end of simulation and by "
+            "command \"branchReport\". The predictor model has no effect on "
+            "timing."
+        );
+
+        leafSection = vmidocAddSection(
+            integration, "Lockstep Co-simulation"
+        );
+
+        vmidocAddText(
+            leafSection,
+            "If parameter \"cosim_shm\" is non-empty, a record is published "
+            "for each retired or trapped instruction and each interrupt into "
+            "a single-producer ring in a POSIX shared memory object with that "
+            "name followed by the hart name. The ring has \"cosim_ring\" "
+            "entries. The record and ring layouts are given by types "
+            "riscvCosimRecord and riscvCosimRing in file riscvCosim.h. Each "
+            "record holds the PC, instruction, trap cause and value, "
+            "privilege mode, masks of written GPRs, FPRs and vector "
+            "registers, numbers of written CSRs and the new GPR, FPR and CSR "
+            "values. GPR and FPR writes that leave the value unchanged are "
+            "reported only within a translated block; vector register writes "
+            "are reported only when the value changes. The model waits when "
+            "the ring is full."
+        );
+
+        vmidocAddText(
+            leafSection,
+            "When the testbench sets the ring \"stepping\" field, an "
+            "instruction with sequence number greater than field "
+            "\"stepLimit\" waits until the limit is raised, allowing the "
+            "testbench to run the model N instructions at a time. Parameter "
+            "\"cosim_stepping\" enables stepping before the first "
+            "instruction (it is ignored if the shared memory object cannot be "
+            "created). Writing fields \"irqIndex\" and \"irqValue\" "
+            "then field \"irqSeq\" changes the given interrupt port while "
+            "that instruction executes, so that any resulting interrupt is "
+            "taken exactly when it retires. The model acknowledges the change "
+            "by copying \"irqSeq\" to field \"irqAck\"."
+        );
+
+        vmidocAddText(
+            leafSection,
+            "If no shared memory is used, a local consumer writes records to "
+            "the file given by parameter \"cosim_log\" and compares them "
+            "with the records in the file given by parameter "
+            "\"cosim_expect\", reporting any mismatches. Both files hold raw "
+            "riscvCosimRecord structures, so the log from one run can be used "
+            "as the expected records for another."
+        );
+
+        leafSection = vmidocAddSection(
+            integration, "Stimulus Record and Replay"
+        );
+
+        vmidocAddText(
+            leafSection,
+            "If parameter \"stimulus_record\" is non-empty, every change on "
+            "an input net port (interrupts, reset, NMI, debug requests and "
+            "CLIC inputs) is logged to a file with that name followed by the "
+            "hart name. Each event is stored as three ULEB128 values: the "
+            "instruction count delta since the previous event, the input "
+            "port index and the new value. The instruction count includes "
+            "cycles spent halted, so events that wake a hart from WFI are "
+            "placed correctly."
+        );
+
+        vmidocAddText(
+            leafSection,
+            "If parameter \"stimulus_replay\" is non-empty, events are "
+            "instead read from the named log and applied to the input ports "
+            "at exactly the recorded instruction count, and changes driven by "
+            "the platform are ignored. This allows a failure to be "
+            "reproduced in a standalone run without the platform models that "
+            "originally generated the stimulus. Events recorded at time zero "
+            "are applied after the first instruction."
+        );
+
+        leafSection = vmidocAddSection(
+            integration, "Fault Injection Campaigns"
+        );
+
+        vmidocAddText(
+            leafSection,
+            "If parameter \"fault_campaign\" names a file, the first hart runs "
+            "a fault injection campaign. Each line of the file has the form "
+            "\"<time> <target> <bit>\". Time is an instruction count. Target "
+            "is one of xN, fN or vN (GPR, FPR or vector register N), "
+            "csr:<number> or tlb:<address>. The given bit of the target is "
+            "inverted. For TLB targets it is a bit of the physical page number "
+            "in the entry mapping the address; bits beyond the physical "
+            "address size are not injected. Lines starting with '#' are "
+            "ignored."
+        );
+
+        vmidocAddText(
+            leafSection,
+            "The simulation itself is the golden run. At each injection time "
+            "the simulator process is forked, and the fault is injected in the "
+            "child, which runs to completion in parallel on another host core. "
+            "At most \"fault_jobs\" children run at once. A child still "
+            "running \"fault_timeout\" instructions after injection is "
+            "classified as a hang; if \"fault_timeout\" is 0 (the default), "
+            "the limit is twice the number of instructions executed by the "
+            "golden run after the injection, plus 1000000, and is applied "
+            "once the golden run has ended. Otherwise, a child that takes more "
+            "exceptions after injection than the golden run did over the same "
+            "period is classified as a trap. Remaining children are classified "
+            "as masked or SDC by comparing a signature of the final GPRs, "
+            "FPRs and the physical memory region given by parameters "
+            "\"fault_sig_addr\" and \"fault_sig_size\" with the golden run. "
+            "Outcomes are written to the file given by parameter "
+            "\"fault_report\". In children, standard input and all inherited "
+            "files open for writing are replaced by /dev/null and inherited "
+            "read-only files are reopened privately; children exit at the end "
+            "of simulation before any hart state is freed, without normal "
+            "termination, so other output is written by the golden run only. "
+            "Shared memory mappings, such as the co-simulation ring, remain "
+            "shared, so fault campaigns should not be combined with "
+            "co-simulation. Injection runs are not started if the simulator "
+            "has more than one thread, and fault campaigns are not supported "
+            "on Windows hosts."
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        // TRANSLATION STATISTICS
+        ////////////////////////////////////////////////////////////////////////
+
+        leafSection = vmidocAddSection(
+            integration, "Translation Statistics"
+        );
+
+        vmidocAddText(
+            leafSection,
+            "If parameter \"morph_stats\" is True, host time spent decoding and "
+            "translating instructions is measured for each hart. At the end "
+            "of simulation, and when command \"morphReport\" is used, a report "
+            "shows the number of blocks translated with a histogram of block "
+            "sizes, the instructions translated and time taken for each "
+            "emitter family (floating point, CSR and vector) and for the most "
+            "expensive instruction types, and the blocks translated most often. "
+            "Each retranslation of a block is classified by what changed since "
+            "its previous translation: the processor mode, the block mask, the "
+            "polymorphic key, or none of these (for example, after a code "
+            "dictionary flush). Timing adds overhead to translation, so "
+            "absolute times should only be compared between runs with the "
+            "parameter enabled."
+        );
+
+        ////////////////////////////////////////////////////////////////////////
+        // OPCODE MIX
+        ////////////////////////////////////////////////////////////////////////
+
+        leafSection = vmidocAddSection(integration, "Opcode Mix");
+
+        vmidocAddText(
+            leafSection,
+            "If parameter \"opcode_mix\" is True, the number of instructions "
+            "executed by each hart is counted for each instruction type. At "
+            "the end of simulation, and when command \"opcodeMixReport\" is "
+            "used, a report shows executed instruction counts by instruction "
+            "class, processor mode, XLEN and instruction type. Counts are "
+            "updated once each time a translated block is entered rather than "
+            "for every instruction; instructions in a block that are not "
+            "executed because of an exception or interrupt are corrected using "
+            "the instruction count when the next block is entered. Counts "
+            "therefore match retired instructions as reported by the "
+            "instruction count."
+        );
     }
 
     ////////////////////////////////////////////////////////////////////////////
@@ -29,14 +29,20 @@
 #include "vmi/vmiRt.h"
 
 // model header files
+#include "riscvBlockState.h"
+#include "riscvBranch.h"
 #include "riscvCLIC.h"
+#include "riscvCosim.h"
 #include "riscvCSR.h"
 #include "riscvDecode.h"
 #include "riscvExceptions.h"
 #include "riscvExceptionDefinitions.h"
+#include "riscvFault.h"
 #include "riscvFunctions.h"
 #include "riscvMessage.h"
+#include "riscvProfile.h"
 #include "riscvStructure.h"
+#include "riscvTrigger.h"
 #include "riscvUtils.h"
 #include "riscvVM.h"
 #include "riscvVMConstants.h"
@@ -137,6 +143,12 @@ inline static void writeNet(riscvP riscv, Uns32 handle, Uns32 value) {
 // Set current PC on exception
 //
 inline static void setPCException(riscvP riscv, Uns64 newPC) {
+
+    // record discontinuity in branch trace if required
+    if(riscv->branch) {
+        riscvBranchSync(riscv, newPC);
+    }
+
     vmirtSetPCException((vmiProcessorP)riscv, newPC);
 }
 
@@ -151,6 +163,11 @@ inline static void setPCxRET(riscvP riscv, Uns64 newPC) {
         newPC &= -4;
     }
 
+    // record discontinuity in branch trace if required
+    if(riscv->branch) {
+        riscvBranchSync(riscv, newPC);
+    }
+
     vmirtSetPC((vmiProcessorP)riscv, newPC);
 }
 
@@ -560,6 +577,26 @@ void riscvTakeException(
             tval = 0;
         }
 
+        // publish co-simulation record for the trap if required
+        if(riscv->cosim) {
+            riscvCosimTrap(riscv, exception, EPC, tval);
+        }
+
+        // record trap cause, EPC and tval in branch trace if required
+        if(riscv->branch) {
+            riscvBranchTrap(riscv, isInt, ecodeMod, EPC, tval);
+        }
+
+        // count exceptions for fault injection campaign if required
+        if(riscv->fault) {
+            riscvFaultTrap(riscv, exception);
+        }
+
+        // fire interrupt and exception triggers if required
+        if(riscv->trigger) {
+            riscvTriggerTrap(riscv, isInt, ecode, modeY);
+        }
+
         // update state dependent on target exception level
         if(modeX==RISCV_MODE_USER) {
 
@@ -633,6 +670,11 @@ void riscvTakeException(
         // set address at which to execute
         setPCException(riscv, handlerPC);
 
+        // record trap handler entry in function profile if required
+        if(riscv->pmKey & PMK_PROFILE) {
+            riscvProfileTrap(riscv, handlerPC);
+        }
+
         // notify derived model of exception entry if required
         for(extCB=riscv->extCBs; extCB; extCB=extCB->next) {
             notifyTrapDerived(riscv, modeX, extCB->trapNotifier, extCB->clientData);
@@ -833,6 +875,11 @@ static void doERETCommon(
     // switch to target mode
     riscvSetMode(riscv, newMode);
 
+    // unwind trap handler frames in function profile if required
+    if(riscv->pmKey & PMK_PROFILE) {
+        riscvProfileTrapReturn(riscv);
+    }
+
     // jump to return address
     setPCxRET(riscv, epc);
 
@@ -994,6 +1041,12 @@ static void enterDM(riscvP riscv, dmCause cause) {
 
         riscvCountState state;
 
+        // any multi-instruction step ends on entry to Debug mode
+        if(riscv->multiStep.active) {
+            riscv->multiStep.active = False;
+            vmirtClearModelTimer(riscv->stepTimer);
+        }
+
         // get state before possible inhibit update
         riscvPreInhibit(riscv, &state);
 
@@ -1092,6 +1145,74 @@ void riscvSetDMStall(riscvP riscv, Bool DMStall) {
     updateDMStall(riscv, DMStall);
 }
 
+//
+// Is the processor stepping, either because dcsr.step is set or because a
+// multi-instruction step is in progress?
+//
+inline static Bool isStepping(riscvP riscv) {
+    return (
+        !inDebugMode(riscv) &&
+        (RD_CSR_FIELD(riscv, dcsr, step) || riscv->multiStep.active)
+    );
+}
+
+//
+// Are interrupts (including NMI) disabled because the processor is stepping
+// with dcsr.stepie=0? (A multi-instruction step with no step limit enables
+// them once a WFI instruction is reached, see riscvWFI)
+//
+inline static Bool stepDisablesInterrupts(riscvP riscv) {
+    return (
+        isStepping(riscv) &&
+        !RD_CSR_FIELD(riscv, dcsr, stepie) &&
+        !(riscv->multiStep.active && riscv->multiStep.WFIEnable)
+    );
+}
+
+//
+// Arm the step timer for the remaining count of a multi-instruction step. A
+// single step restarts at each point where the step breakpoint is set (on
+// resume, trap entry or any other mode change), so every instruction completed
+// since the timer was last armed has completed one step. A step with a stop
+// condition is armed for one instruction so that the condition is evaluated
+// at the end of every step.
+//
+static void armMultiStep(riscvP riscv) {
+
+    riscvMultiStepP ms     = &riscv->multiStep;
+    Uns64           icount = vmirtGetICount((vmiProcessorP)riscv);
+    Uns64           done   = icount - ms->base;
+
+    ms->base = icount;
+
+    if(ms->remaining) {
+        ms->remaining = (ms->remaining>done) ? ms->remaining-done : 1;
+    }
+
+    if(ms->condition) {
+        vmirtSetModelTimer(riscv->stepTimer, 1);
+    } else if(ms->remaining) {
+        vmirtSetModelTimer(riscv->stepTimer, ms->remaining);
+    }
+}
+
+//
+// Should a multi-instruction step with a stop condition continue after the
+// step timer has expired?
+//
+static Bool continueMultiStep(riscvP riscv) {
+
+    riscvMultiStepP ms   = &riscv->multiStep;
+    Uns64           done = vmirtGetICount((vmiProcessorP)riscv) - ms->base;
+
+    return (
+        ms->active &&
+        ms->condition &&
+        !(ms->remaining && (ms->remaining<=done)) &&
+        !ms->condition(riscv, ms->userData)
+    );
+}
+
 //
 // Instruction step breakpoint callback
 //
@@ -1099,7 +1220,14 @@ static VMI_ICOUNT_FN(riscvStepExcept) {
 
     riscvP riscv = (riscvP)processor;
 
-    if(!inDebugMode(riscv) && RD_CSR_FIELD(riscv, dcsr, step)) {
+    // a multi-instruction step without a stop condition arms the timer only
+    // for the remaining step count, so expiry indicates that the step has
+    // completed; with a stop condition the timer expires after every step
+    if(!isStepping(riscv)) {
+        // no action
+    } else if(continueMultiStep(riscv)) {
+        armMultiStep(riscv);
+    } else {
         enterDM(riscv, DMC_STEP);
     }
 }
@@ -1109,11 +1237,96 @@ static VMI_ICOUNT_FN(riscvStepExcept) {
 //
 void riscvSetStepBreakpoint(riscvP riscv) {
 
-    if(!inDebugMode(riscv) && RD_CSR_FIELD(riscv, dcsr, step)) {
+    if(inDebugMode(riscv)) {
+        // no action in Debug mode
+    } else if(riscv->multiStep.active) {
+        armMultiStep(riscv);
+    } else if(RD_CSR_FIELD(riscv, dcsr, step)) {
         vmirtSetModelTimer(riscv->stepTimer, 1);
     }
 }
 
+//
+// Leave Debug mode and execute as if by 'count' single steps (or with no step
+// limit if 'count' is zero), re-entering Debug mode only when the steps are
+// complete or, if 'useStopPC' is True, when a step would end at 'stopPC'
+//
+RISCV_DEBUG_STEP_FN(riscvDebugStep) {
+
+    riscvMultiStepP ms = &riscv->multiStep;
+
+    if(
+        !riscv->stepTimer ||
+        !inDebugMode(riscv) ||
+        !(count || useStopPC || condition)
+    ) {
+        return False;
+    }
+
+    // code at any new stop address must be retranslated with a stop check
+    if(useStopPC && !(ms->stopPCValid && (ms->stopPC==stopPC))) {
+        ms->stopPC      = stopPC;
+        ms->stopPCValid = True;
+        vmirtFlushAllDicts((vmiProcessorP)riscv);
+    }
+
+    // start the step (the step timer is armed on leaving Debug mode)
+    ms->remaining = count;
+    ms->base      = vmirtGetICount((vmiProcessorP)riscv);
+    ms->active    = True;
+    ms->useStopPC = useStopPC;
+    ms->condition = condition;
+    ms->userData  = userData;
+    ms->WFIEnable = False;
+
+    leaveDM(riscv);
+
+    return True;
+}
+
+//
+// Is there a multi-instruction step stop check for the instruction at the
+// passed address?
+//
+Bool riscvDebugStepStopMatch(riscvP riscv, Uns64 thisPC) {
+
+    riscvMultiStepP ms = &riscv->multiStep;
+
+    return ms->stopPCValid && (ms->stopPC==thisPC);
+}
+
+//
+// Called before the instruction at a multi-instruction step stop address: a
+// step can end here only if at least one instruction has completed since the
+// step timer was last armed
+//
+void riscvDebugStepStop(riscvP riscv, Uns64 thisPC) {
+
+    riscvMultiStepP ms = &riscv->multiStep;
+
+    if(
+        ms->active &&
+        ms->useStopPC &&
+        (ms->stopPC==thisPC) &&
+        (vmirtGetICount((vmiProcessorP)riscv) != ms->base)
+    ) {
+        enterDM(riscv, DMC_STEP);
+    }
+}
+
+//
+// Take the action for a debug trigger that has fired, either entering Debug
+// mode or raising a Breakpoint exception
+//
+void riscvTakeTriggerAction(riscvP riscv, Bool debug, Uns64 tval) {
+
+    if(debug) {
+        enterDM(riscv, DMC_TRIGGER);
+    } else {
+        riscvTakeException(riscv, riscv_E_Breakpoint, tval);
+    }
+}
+
 //
 // Return from Debug mode
 //
@@ -1717,10 +1930,22 @@ inline static Bool getPendingAndEnabled(riscvP riscv) {
     return (
         (riscv->pendEnab.id!=RV_NO_INT) &&
         !inDebugMode(riscv) &&
+        !stepDisablesInterrupts(riscv) &&
         !riscv->netValue.deferint
     );
 }
 
+//
+// Return an indication of whether there is a pending NMI that can be taken
+//
+inline static Bool getPendingNMI(riscvP riscv) {
+    return (
+        RD_CSR_FIELD(riscv, dcsr, nmip) &&
+        !inDebugMode(riscv) &&
+        !stepDisablesInterrupts(riscv)
+    );
+}
+
 //
 // Process highest-priority interrupt in the given mask of pending-and-enabled
 // interrupts
@@ -1774,7 +1999,14 @@ VMI_IFETCH_FN(riscvIFetchExcept) {
             enterDM(riscv, DMC_HALTREQ);
         }
 
-    } else if(RD_CSR_FIELD(riscv, dcsr, nmip) && !inDebugMode(riscv)) {
+    } else if(riscvTriggerPending(riscv) && !inDebugMode(riscv)) {
+
+        // take action for a fired trigger
+        if(complete) {
+            riscvTriggerTakePending(riscv);
+        }
+
+    } else if(getPendingNMI(riscv)) {
 
         // handle pending NMI
         if(complete) {
@@ -2048,22 +2280,38 @@ inline static Bool negedge(Uns32 old, Uns32 new) {
 }
 
 //
-// Halt the processor in WFI state if required
+// Handle any pending and enabled interrupts
 //
-void riscvWFI(riscvP riscv) {
+inline static void handlePendingAndEnabled(riscvP riscv) {
 
-    if(!(inDebugMode(riscv) || getPending(riscv))) {
-        haltProcessor(riscv, RVD_WFI);
+    // an NMI held off while stepping with dcsr.stepie=0 is handled here too
+    if(getPendingAndEnabled(riscv) || getPendingNMI(riscv)) {
+        vmirtDoSynchronousInterrupt((vmiProcessorP)riscv);
     }
 }
 
 //
-// Handle any pending and enabled interrupts
+// Halt the processor in WFI state if required
 //
-inline static void handlePendingAndEnabled(riscvP riscv) {
+void riscvWFI(riscvP riscv) {
 
-    if(getPendingAndEnabled(riscv)) {
-        vmirtDoSynchronousInterrupt((vmiProcessorP)riscv);
+    riscvMultiStepP ms = &riscv->multiStep;
+
+    // a multi-instruction step with no step limit and dcsr.stepie=0 would
+    // never complete if the code is waiting for an interrupt handler, so
+    // interrupts are enabled for the rest of the step once WFI is reached
+    if(
+        ms->active &&
+        !ms->remaining &&
+        !inDebugMode(riscv) &&
+        !RD_CSR_FIELD(riscv, dcsr, stepie)
+    ) {
+        ms->WFIEnable = True;
+        handlePendingAndEnabled(riscv);
+    }
+
+    if(!(inDebugMode(riscv) || getPending(riscv))) {
+        haltProcessor(riscv, RVD_WFI);
     }
 }
 
@@ -2096,6 +2344,9 @@ void riscvReset(riscvP riscv) {
     // restart the processor from any halted state
     restartProcessor(riscv, RVD_RESTART_RESET);
 
+    // abandon any multi-instruction step
+    riscv->multiStep.active = False;
+
     // exit Debug mode
     riscvSetDM(riscv, False);
 
@@ -2108,6 +2359,9 @@ void riscvReset(riscvP riscv) {
     // reset CLIC state
     riscvResetCLIC(riscv);
 
+    // reset debug triggers
+    riscvTriggerReset(riscv);
+
     // notify dependent model of reset event
     for(extCB=riscv->extCBs; extCB; extCB=extCB->next) {
         if(extCB->resetNotifier) {
@@ -2151,6 +2405,13 @@ static void doNMI(riscvP riscv) {
     // update mepc to hold next instruction address
     WR_CSR(riscv, mepc, getEPC(riscv));
 
+    // record NMI cause and EPC in branch trace if required
+    if(riscv->branch) {
+        riscvBranchTrap(
+            riscv, True, riscv->configInfo.ecode_nmi, getEPC(riscv), 0
+        );
+    }
+
     // indicate the taken exception
     riscv->exception = 0;
 
@@ -2344,16 +2605,13 @@ static VMI_NET_CHANGE_FN(SCValidPortCB) {
 }
 
 //
-// Generic interrupt signal
+// Update the state of the generic interrupt signal with the given index
 //
-static VMI_NET_CHANGE_FN(interruptPortCB) {
+void riscvSetInterruptPending(riscvP riscv, Uns32 index, Uns32 newValue) {
 
-    riscvInterruptInfoP ii     = userData;
-    riscvP              riscv  = ii->hart;
-    Uns32               index  = ii->userData;
-    Uns32               offset = index/64;
-    Uns64               mask   = 1ULL << (index&63);
-    Uns32               maxNum = riscvGetIntNum(riscv);
+    Uns32 offset = index/64;
+    Uns64 mask   = 1ULL << (index&63);
+    Uns32 maxNum = riscvGetIntNum(riscv);
 
     // sanity check
     VMI_ASSERT(
@@ -2380,6 +2638,16 @@ static VMI_NET_CHANGE_FN(interruptPortCB) {
     }
 }
 
+//
+// Generic interrupt signal
+//
+static VMI_NET_CHANGE_FN(interruptPortCB) {
+
+    riscvInterruptInfoP ii = userData;
+
+    riscvSetInterruptPending(ii->hart, ii->userData, newValue);
+}
+
 //
 // Generic interrupt ID signal
 //
@@ -2964,6 +3232,7 @@ void riscvTimerSave(
 
         if(riscv->stepTimer) {
             vmirtSaveModelTimer(cxt, RV_STEP_TIMER, riscv->stepTimer);
+            VMIRT_SAVE_FIELD(cxt, riscv, multiStep);
         }
     }
 }
@@ -2979,7 +3248,14 @@ void riscvTimerRestore(
     if(phase==SRT_END_CORE) {
 
         if(riscv->stepTimer) {
+
             vmirtRestoreModelTimer(cxt, RV_STEP_TIMER, riscv->stepTimer);
+            VMIRT_RESTORE_FIELD(cxt, riscv, multiStep);
+
+            // code at any stop address must be retranslated with a stop check
+            if(riscv->multiStep.stopPCValid) {
+                vmirtFlushAllDicts((vmiProcessorP)riscv);
+            }
         }
     }
 }
@@ -24,6 +24,7 @@
 
 // model header files
 #include "riscvExceptionTypes.h"
+#include "riscvModelCallbacks.h"
 #include "riscvTypeRefs.h"
 
 
@@ -115,6 +116,29 @@ void riscvSetDMStall(riscvP riscv, Bool DMStall);
 //
 void riscvSetStepBreakpoint(riscvP riscv);
 
+//
+// Leave Debug mode and execute as if by 'count' single steps (or with no step
+// limit if 'count' is zero), stopping early at 'stopPC' if 'useStopPC' is True
+// or when 'condition' (if any) returns True
+//
+RISCV_DEBUG_STEP_FN(riscvDebugStep);
+
+//
+// Is there a multi-instruction step stop check for the instruction at the
+// passed address?
+//
+Bool riscvDebugStepStopMatch(riscvP riscv, Uns64 thisPC);
+
+//
+// Called before the instruction at a multi-instruction step stop address
+//
+void riscvDebugStepStop(riscvP riscv, Uns64 thisPC);
+
+//
+// Take the action for a debug trigger that has fired
+//
+void riscvTakeTriggerAction(riscvP riscv, Bool debug, Uns64 tval);
+
 //
 // Halt the processor in WFI state if required
 //
@@ -146,6 +170,11 @@ void riscvExceptFree(riscvP riscv);
 //
 void riscvUpdatePending(riscvP riscv);
 
+//
+// Update the state of the generic interrupt signal with the given index
+//
+void riscvSetInterruptPending(riscvP riscv, Uns32 index, Uns32 newValue);
+
 //
 // Refresh pending-and-enabled interrupt state
 //
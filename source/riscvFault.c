@@ -0,0 +1,1008 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// standard header files
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// process management header files
+#if !defined(_WIN32)
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Imperas header files
+#include "hostapi/impAlloc.h"
+
+// VMI header files
+#include "vmi/vmiMessage.h"
+#include "vmi/vmiRt.h"
+
+// model header files
+#include "riscvCSR.h"
+#include "riscvFault.h"
+#include "riscvMessage.h"
+#include "riscvParameters.h"
+#include "riscvStructure.h"
+#include "riscvUtils.h"
+#include "riscvVariant.h"
+#include "riscvVM.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Maximum length of a campaign file line
+//
+#define FAULT_LINE_MAX      256
+
+//
+// Without an explicit timeout, an injection run is classified as a hang when
+// it has executed FAULT_HANG_FACTOR times the instructions executed by the
+// golden run after the injection, plus FAULT_HANG_MIN
+//
+#define FAULT_HANG_FACTOR   2
+#define FAULT_HANG_MIN      1000000
+
+//
+// Interval at which an injection run checks for the end of the golden run
+//
+#define FAULT_HANG_CHECK    10000000
+
+//
+// Hang limit used if the end of the golden run cannot be shared
+//
+#define FAULT_HANG_FIXED    100000000
+
+//
+// Fault injection targets
+//
+typedef enum faultTargetE {
+    FT_X,                       // GPR
+    FT_F,                       // FPR
+    FT_V,                       // vector register
+    FT_CSR,                     // CSR
+    FT_TLB,                     // TLB entry physical page number
+} faultTarget;
+
+//
+// Fault injection outcomes
+//
+typedef enum faultOutcomeE {
+    FO_MASKED,                  // final signature matches golden run
+    FO_SDC,                     // silent data corruption
+    FO_TRAP,                    // more exceptions than golden run
+    FO_HANG,                    // timeout expired
+    FO_NOT_INJECTED,            // target not present
+    FO_ERROR,                   // injection run ended abnormally
+    FO_LAST                     // KEEP LAST: for sizing
+} faultOutcome;
+
+DEFINE_S(faultInjection);
+DEFINE_S(faultResult);
+DEFINE_S(faultShared);
+
+//
+// State shared between the golden run and injection runs
+//
+typedef struct faultSharedS {
+    Uns64 goldenEnd;            // golden run instruction count at end
+    Uns64 goldenDone;           // non-zero when golden run has ended
+} faultShared;
+
+//
+// Result sent from an injection run to the golden run
+//
+typedef struct faultResultS {
+    Uns64 signature;            // final state signature
+    Uns64 traps;                // exceptions after injection
+    Bool  injected;             // whether fault was injected
+    Bool  hang;                 // whether timeout expired
+    Bool  valid;                // whether result was received
+} faultResult;
+
+//
+// One fault injection
+//
+typedef struct faultInjectionS {
+    Uns64        when;          // injection time
+    faultTarget  target;        // injection target
+    Uns64        index;         // register index, CSR number or TLB address
+    Uns32        bit;           // bit to invert
+    char        *desc;          // injection description
+    Int32        pid;           // injection run process id
+    Int32        fd;            // injection run result pipe
+    Uns64        start;         // instruction count at injection
+    Uns64        goldenTraps;   // golden run exceptions at injection time
+    faultResult  result;        // injection run result
+} faultInjection;
+
+//
+// Fault injection campaign state
+//
+typedef struct riscvFaultS {
+    faultInjectionP injections; // injections in time order
+    Uns32           num;        // number of injections
+    Uns32           next;       // index of next injection
+    Uns32           jobs;       // maximum concurrent injection runs
+    Uns32           running;    // active injection runs
+    Uns64           timeout;    // injection run timeout (0 if derived)
+    faultSharedP    shared;     // state shared with injection runs
+    Uns64           sigAddr;    // memory signature address
+    Uns64           sigSize;    // memory signature size
+    char           *report;     // report file name
+    vmiModelTimerP  timer;      // injection and timeout timer
+    Uns64           traps;      // exceptions taken
+    faultInjectionP child;      // active injection (injection run only)
+} riscvFault;
+
+//
+// Outcome names
+//
+static const char *outcomeNames[FO_LAST] = {
+    [FO_MASKED]       = "masked",
+    [FO_SDC]          = "SDC",
+    [FO_TRAP]         = "trap",
+    [FO_HANG]         = "hang",
+    [FO_NOT_INJECTED] = "not-injected",
+    [FO_ERROR]        = "error",
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+// SIGNATURE AND INJECTION
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Accumulate bytes into an FNV-1a signature
+//
+static Uns64 hashBytes(Uns64 hash, const void *data, Uns64 bytes) {
+
+    const Uns8 *p = data;
+    Uns64       i;
+
+    for(i=0; i<bytes; i++) {
+        hash = (hash ^ p[i]) * 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+//
+// Return signature of final GPR, FPR and signature memory region state
+//
+static Uns64 getSignature(riscvP riscv, riscvFaultP fault) {
+
+    Uns64 hash = 0xcbf29ce484222325ULL;
+
+    hash = hashBytes(hash, riscv->x, sizeof(riscv->x));
+    hash = hashBytes(hash, riscv->f, sizeof(riscv->f));
+
+    if(fault->sigSize) {
+
+        memDomainP domain = vmirtGetProcessorPhysicalDataDomain(
+            (vmiProcessorP)riscv
+        );
+        Uns8  buffer[256];
+        Uns64 addr = fault->sigAddr;
+        Uns64 left = fault->sigSize;
+
+        while(left) {
+
+            Uns32 bytes = (left>sizeof(buffer)) ? sizeof(buffer) : left;
+
+            vmirtReadNByteDomain(domain, addr, buffer, bytes, 0, MEM_AA_FALSE);
+            hash = hashBytes(hash, buffer, bytes);
+
+            addr += bytes;
+            left -= bytes;
+        }
+    }
+
+    return hash;
+}
+
+//
+// Inject the fault, returning False if the target is not present
+//
+static Bool injectFault(riscvP riscv, faultInjectionP injection) {
+
+    Uns64 index = injection->index;
+    Uns32 bit   = injection->bit;
+    Bool  ok    = True;
+
+    switch(injection->target) {
+
+        case FT_X:
+            ok = (index>0) && (index<32);
+            if(ok) {riscv->x[index] ^= 1ULL << (bit&63);}
+            break;
+
+        case FT_F:
+            ok = (index<32) && (riscv->configInfo.arch & (ISA_F|ISA_D));
+            if(ok) {riscv->f[index] ^= 1ULL << (bit&63);}
+            break;
+
+        case FT_V: {
+
+            Uns32 vRegBytes = riscv->configInfo.VLEN/8;
+
+            ok = riscv->v && (index<VREG_NUM) && (bit<(vRegBytes*8));
+
+            if(ok) {
+                Uns8 *vBytes = (Uns8 *)riscv->v;
+                riscvVZeroPending(riscv, index, vRegBytes);
+                vBytes[(index*vRegBytes)+(bit/8)] ^= 1 << (bit%8);
+            }
+            break;
+        }
+
+        case FT_CSR: {
+
+            Bool  old = riscv->artifactAccess;
+            Uns64 value;
+
+            ok = riscvGetCSRName(riscv, index) ? True : False;
+
+            if(ok) {
+                riscv->artifactAccess = True;
+                value = riscvReadCSRNum(riscv, index);
+                riscv->artifactAccess = old;
+                riscvWriteCSRNum(riscv, index, value ^ (1ULL << (bit&63)));
+            }
+            break;
+        }
+
+        case FT_TLB:
+            ok = riscvVMInjectTLBFault(riscv, index, bit);
+            break;
+    }
+
+    // discard translated code that may depend on the previous state
+    if(ok) {
+        vmirtFlushAllDicts((vmiProcessorP)riscv);
+    }
+
+    return ok;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// INJECTION RUN MANAGEMENT
+////////////////////////////////////////////////////////////////////////////////
+
+#if !defined(_WIN32)
+
+//
+// Hart controlling the campaign in a forked injection run (0 in the golden
+// run)
+//
+static riscvP childHart;
+
+//
+// Return the number of threads in this process (forked injection runs contain
+// only the thread that called fork, so a campaign requires a single thread)
+//
+static Uns32 getThreadCount(void) {
+
+    Uns32 result = 1;
+
+#if defined(__linux__)
+
+    DIR *dir = opendir("/proc/self/task");
+
+    if(dir) {
+
+        struct dirent *entry;
+
+        result = 0;
+
+        while((entry=readdir(dir))) {
+            if(entry->d_name[0]!='.') {
+                result++;
+            }
+        }
+
+        closedir(dir);
+    }
+
+#endif
+
+    return result;
+}
+
+//
+// Give an injection run a private copy of an inherited read-only file at the
+// same offset, so that its reads do not move the golden run file offset
+// (the file is left shared if it cannot be reopened)
+//
+static void reopenChildFile(Int32 fd) {
+
+    char  path[32];
+    off_t offset = lseek(fd, 0, SEEK_CUR);
+    Int32 newFd;
+
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+
+    if((offset>=0) && ((newFd=open(path, O_RDONLY))>=0)) {
+        lseek(newFd, offset, SEEK_SET);
+        dup2(newFd, fd);
+        close(newFd);
+    }
+}
+
+//
+// Isolate one inherited file descriptor in an injection run: standard input
+// and files open for writing are replaced by /dev/null, so that nothing
+// written by the model, other harts or the platform is duplicated in golden
+// run output files, and read-only files are reopened privately
+//
+static void isolateChildFile(Int32 fd, Int32 nullFd, Int32 keepFd) {
+
+    Int32 flags = fcntl(fd, F_GETFL);
+
+    if((flags<0) || (fd==nullFd) || (fd==keepFd)) {
+        // no action
+    } else if((fd!=STDIN_FILENO) && ((flags&O_ACCMODE)==O_RDONLY)) {
+        reopenChildFile(fd);
+    } else {
+        dup2(nullFd, fd);
+    }
+}
+
+//
+// Isolate all inherited file descriptors except the given result pipe in an
+// injection run
+//
+static void isolateChildFiles(Int32 keepFd) {
+
+    Int32 nullFd = open("/dev/null", O_RDWR);
+    DIR  *dir    = opendir("/proc/self/fd");
+
+    if(nullFd<0) {
+
+        // no action if /dev/null is unavailable
+
+    } else if(dir) {
+
+        // isolate open descriptors listed by the host
+        struct dirent *entry;
+        Int32          dirFd = dirfd(dir);
+
+        while((entry=readdir(dir))) {
+
+            Int32 fd = atoi(entry->d_name);
+
+            if((entry->d_name[0]!='.') && (fd!=dirFd)) {
+                isolateChildFile(fd, nullFd, keepFd);
+            }
+        }
+
+        closedir(dir);
+
+    } else {
+
+        // otherwise check every possible descriptor
+        Int32 max = sysconf(_SC_OPEN_MAX);
+        Int32 fd;
+
+        for(fd=0; (fd<max) && (fd<4096); fd++) {
+            isolateChildFile(fd, nullFd, keepFd);
+        }
+    }
+
+    if(nullFd>=0) {
+        close(nullFd);
+    }
+}
+
+//
+// Return instructions remaining before the injection run is classified as a
+// hang (0 if it should be classified now). Without an explicit timeout the
+// limit is derived from the instructions executed by the golden run after the
+// injection, so the run checks periodically until the golden run has ended.
+//
+static Uns64 getHangRemaining(riscvFaultP fault, Uns64 now) {
+
+    faultInjectionP injection = fault->child;
+    faultSharedP    shared    = fault->shared;
+    Uns64           elapsed   = now - injection->start;
+    Uns64           limit;
+
+    if(fault->timeout) {
+
+        limit = fault->timeout;
+
+    } else if(!__atomic_load_n(&shared->goldenDone, __ATOMIC_ACQUIRE)) {
+
+        return FAULT_HANG_CHECK;
+
+    } else {
+
+        Uns64 golden = shared->goldenEnd - injection->start;
+
+        limit = (golden*FAULT_HANG_FACTOR) + FAULT_HANG_MIN;
+    }
+
+    return (elapsed<limit) ? limit-elapsed : 0;
+}
+
+//
+// Send the result of this injection run to the golden run and exit (the exit
+// bypasses normal termination so that no output shared with the golden run is
+// written)
+//
+static void finishChild(riscvP riscv, riscvFaultP fault, Bool hang) {
+
+    faultInjectionP injection = fault->child;
+    faultResultP    result    = &injection->result;
+
+    result->signature = getSignature(riscv, fault);
+    result->traps     = fault->traps;
+    result->hang      = hang;
+    result->valid     = True;
+
+    if(write(injection->fd, result, sizeof(*result))!=sizeof(*result)) {
+        _exit(1);
+    }
+
+    _exit(0);
+}
+
+//
+// Collect the result of a completed injection run
+//
+static void collectChild(riscvFaultP fault, faultInjectionP injection) {
+
+    faultResult result;
+
+    if(read(injection->fd, &result, sizeof(result))==sizeof(result)) {
+        injection->result = result;
+    }
+
+    close(injection->fd);
+
+    injection->pid = 0;
+    fault->running--;
+}
+
+//
+// Wait for at least one injection run to complete and collect its result.
+// Only injection runs started by this campaign are waited for, so that child
+// processes created by the platform are not reaped.
+//
+static void reapChild(riscvFaultP fault) {
+
+    faultInjectionP oldest = 0;
+    Uns32           reaped = 0;
+    Int32           status;
+    Uns32           i;
+
+    // collect any injection runs that have already completed
+    for(i=0; i<fault->next; i++) {
+
+        faultInjectionP injection = &fault->injections[i];
+
+        if(!injection->pid) {
+
+            // not running
+
+        } else if(waitpid(injection->pid, &status, WNOHANG)) {
+
+            // completed (or no longer a child, reported as an error)
+            collectChild(fault, injection);
+            reaped++;
+
+        } else if(!oldest) {
+
+            oldest = injection;
+        }
+    }
+
+    // otherwise wait for the oldest injection run to complete
+    if(!reaped && oldest) {
+        waitpid(oldest->pid, &status, 0);
+        collectChild(fault, oldest);
+    }
+}
+
+//
+// Start an injection run for the given injection
+//
+static void startChild(riscvP riscv, riscvFaultP fault, faultInjectionP inj) {
+
+    static Bool threadsReported;
+
+    Uns32 threads = getThreadCount();
+    Int32 fds[2];
+    Int32 pid;
+
+    // wait for a job slot
+    while(fault->running>=fault->jobs) {
+        reapChild(fault);
+    }
+
+    inj->goldenTraps = fault->traps;
+    inj->start       = vmirtGetICount((vmiProcessorP)riscv);
+
+    if(threads>1) {
+
+        // a forked copy of a multithreaded simulator could deadlock (reported
+        // as error)
+        if(!threadsReported) {
+            vmiMessage("W", CPU_PREFIX"_FMT",
+                NO_SRCREF_FMT "Fault injection runs require a single-threaded "
+                "simulator (%u threads found) - injections not run",
+                NO_SRCREF_ARGS(riscv), threads
+            );
+            threadsReported = True;
+        }
+
+    } else if(pipe(fds)) {
+
+        // no action if pipe cannot be created (reported as error)
+
+    } else if((pid=fork())<0) {
+
+        close(fds[0]);
+        close(fds[1]);
+
+    } else if(pid) {
+
+        // golden run continues
+        close(fds[1]);
+
+        inj->pid = pid;
+        inj->fd  = fds[0];
+
+        fault->running++;
+
+    } else {
+
+        // injection run
+        close(fds[0]);
+        isolateChildFiles(fds[1]);
+
+        childHart      = riscv;
+        inj->fd        = fds[1];
+        fault->child   = inj;
+        fault->running = 0;
+        fault->traps   = 0;
+
+        if(!(inj->result.injected=injectFault(riscv, inj))) {
+            finishChild(riscv, fault, False);
+        }
+
+        // the timer now detects a hang
+        vmirtSetModelTimer(fault->timer, getHangRemaining(fault, inj->start));
+    }
+}
+
+//
+// Injection timer callback
+//
+static VMI_ICOUNT_FN(faultTimerCB) {
+
+    riscvP      riscv = (riscvP)processor;
+    riscvFaultP fault = riscv->fault;
+    Uns64       now   = vmirtGetICount(processor);
+
+    if(fault->child) {
+
+        Uns64 remaining = getHangRemaining(fault, now);
+
+        // classify as a hang if the limit has been reached, otherwise check
+        // again later
+        if(!remaining) {
+            finishChild(riscv, fault, True);
+        } else {
+            vmirtSetModelTimer(fault->timer, remaining);
+        }
+    }
+
+    // start all injection runs due now
+    while(
+        !fault->child &&
+        (fault->next<fault->num) &&
+        (fault->injections[fault->next].when<=now)
+    ) {
+        startChild(riscv, fault, &fault->injections[fault->next++]);
+    }
+
+    // schedule next injection in the golden run
+    if(!fault->child && (fault->next<fault->num)) {
+        vmirtSetModelTimer(
+            fault->timer, fault->injections[fault->next].when-now
+        );
+    }
+}
+
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////
+// CAMPAIGN FILE AND REPORT
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Parse an injection target, returning False if it is invalid
+//
+static Bool parseTarget(const char *text, faultInjectionP injection) {
+
+    char *end;
+
+    if(!strncmp(text, "csr:", 4)) {
+        injection->target = FT_CSR;
+        injection->index  = strtoull(text+4, &end, 0);
+    } else if(!strncmp(text, "tlb:", 4)) {
+        injection->target = FT_TLB;
+        injection->index  = strtoull(text+4, &end, 0);
+    } else if(text[0]=='x') {
+        injection->target = FT_X;
+        injection->index  = strtoull(text+1, &end, 10);
+    } else if(text[0]=='f') {
+        injection->target = FT_F;
+        injection->index  = strtoull(text+1, &end, 10);
+    } else if(text[0]=='v') {
+        injection->target = FT_V;
+        injection->index  = strtoull(text+1, &end, 10);
+    } else {
+        return False;
+    }
+
+    return !*end;
+}
+
+//
+// Compare injections by time
+//
+static int compareInjections(const void *a, const void *b) {
+
+    faultInjectionP ia = (faultInjectionP)a;
+    faultInjectionP ib = (faultInjectionP)b;
+
+    return (ia->when<ib->when) ? -1 : (ia->when>ib->when) ? 1 : 0;
+}
+
+//
+// Read the campaign file, returning False if it cannot be read
+//
+static Bool readCampaign(riscvP riscv, riscvFaultP fault, const char *file) {
+
+    FILE *f = fopen(file, "r");
+    char  line[FAULT_LINE_MAX];
+    Uns32 lineNum = 0;
+
+    if(!f) {
+
+        vmiMessage("W", CPU_PREFIX"_FIO",
+            NO_SRCREF_FMT "Cannot open fault campaign file '%s'",
+            NO_SRCREF_ARGS(riscv), file
+        );
+
+        return False;
+    }
+
+    // allocate an injection for each line
+    while(fgets(line, sizeof(line), f)) {
+        lineNum++;
+    }
+
+    fault->injections = STYPE_CALLOC_N(faultInjection, lineNum);
+    lineNum           = 0;
+
+    rewind(f);
+
+    while(fgets(line, sizeof(line), f)) {
+
+        unsigned long long when;
+        unsigned long long bit;
+        char               target[64];
+        faultInjection     injection = {0};
+
+        lineNum++;
+
+        if((line[0]=='#') || (line[0]=='\n')) {
+
+            // ignore comments and blank lines
+
+        } else if(
+            (sscanf(line, "%llu %63s %llu", &when, target, &bit)!=3) ||
+            !parseTarget(target, &injection)
+        ) {
+
+            vmiMessage("W", CPU_PREFIX"_FIS",
+                NO_SRCREF_FMT "%s:%u: expected '<time> <target> <bit>' - "
+                "line ignored",
+                NO_SRCREF_ARGS(riscv), file, lineNum
+            );
+
+        } else {
+
+            Uns32 len = strlen(target) + 48;
+
+            injection.when = when;
+            injection.bit  = bit;
+            injection.desc = STYPE_CALLOC_N(char, len);
+            snprintf(injection.desc, len, "%llu %s %llu", when, target, bit);
+
+            fault->injections[fault->num++] = injection;
+        }
+    }
+
+    fclose(f);
+
+    qsort(
+        fault->injections, fault->num, sizeof(faultInjection),
+        compareInjections
+    );
+
+    return True;
+}
+
+//
+// Classify the outcome of an injection
+//
+static faultOutcome classify(
+    faultInjectionP injection,
+    Uns64           signature,
+    Uns64           traps
+) {
+    faultResultP result = &injection->result;
+
+    if(!result->valid) {
+        return FO_ERROR;
+    } else if(!result->injected) {
+        return FO_NOT_INJECTED;
+    } else if(result->hang) {
+        return FO_HANG;
+    } else if(result->traps > (traps-injection->goldenTraps)) {
+        return FO_TRAP;
+    } else if(result->signature!=signature) {
+        return FO_SDC;
+    } else {
+        return FO_MASKED;
+    }
+}
+
+//
+// Write the campaign report and summary
+//
+static void writeReport(riscvP riscv, riscvFaultP fault) {
+
+    Uns64 signature = getSignature(riscv, fault);
+    Uns32 counts[FO_LAST] = {0};
+    FILE *f = fopen(fault->report, "w");
+    Uns32 i;
+
+    if(!f) {
+        vmiMessage("W", CPU_PREFIX"_FRO",
+            NO_SRCREF_FMT "Cannot open fault report file '%s'",
+            NO_SRCREF_ARGS(riscv), fault->report
+        );
+    }
+
+    for(i=0; i<fault->num; i++) {
+
+        faultInjectionP injection = &fault->injections[i];
+        faultOutcome    outcome   = FO_NOT_INJECTED;
+
+        // injections after the end of the golden run are not started
+        if(i<fault->next) {
+            outcome = classify(injection, signature, fault->traps);
+        }
+
+        counts[outcome]++;
+
+        if(f) {
+            fprintf(f, "%s %s\n", injection->desc, outcomeNames[outcome]);
+        }
+    }
+
+    if(f) {
+        fclose(f);
+    }
+
+    vmiMessage("I", CPU_PREFIX"_FRS",
+        NO_SRCREF_FMT "Fault campaign: %u injections, %u masked, %u SDC, "
+        "%u trap, %u hang, %u not injected, %u error",
+        NO_SRCREF_ARGS(riscv), fault->num, counts[FO_MASKED], counts[FO_SDC],
+        counts[FO_TRAP], counts[FO_HANG], counts[FO_NOT_INJECTED],
+        counts[FO_ERROR]
+    );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// INTERFACE FUNCTIONS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Record an exception for fault outcome classification
+//
+void riscvFaultTrap(riscvP riscv, riscvException exception) {
+
+    if(!isInterrupt(exception)) {
+        riscv->fault->traps++;
+    }
+}
+
+//
+// Allocate fault injection campaign structures if required
+//
+void riscvNewFault(riscvP riscv, riscvParamValuesP params) {
+
+    const char *file = params->fault_campaign;
+
+    if(!file[0]) {
+
+        // no action unless fault campaign is specified
+
+    } else if(vmirtGetSMPIndex((vmiProcessorP)riscv)) {
+
+        // campaign is controlled by the first hart only
+
+    } else {
+
+#if defined(_WIN32)
+
+        vmiMessage("W", CPU_PREFIX"_FNS",
+            NO_SRCREF_FMT "Fault campaigns are not supported on this host",
+            NO_SRCREF_ARGS(riscv)
+        );
+
+#else
+
+        riscvFault fault = {
+            jobs    : params->fault_jobs,
+            timeout : params->fault_timeout,
+            sigAddr : params->fault_sig_addr,
+            sigSize : params->fault_sig_size,
+        };
+
+        if(readCampaign(riscv, &fault, file) && fault.num) {
+
+            riscvFaultP new    = STYPE_CALLOC(riscvFault);
+            const char *report = params->fault_report;
+            void       *shared = MAP_FAILED;
+
+            // allocate state shared with injection runs if the hang limit is
+            // derived from the golden run
+            if(!fault.timeout) {
+                shared = mmap(
+                    0, sizeof(faultShared), PROT_READ|PROT_WRITE,
+                    MAP_SHARED|MAP_ANONYMOUS, -1, 0
+                );
+            }
+
+            *new = fault;
+
+            // use all host cores by default
+            if(!new->jobs) {
+                new->jobs = sysconf(_SC_NPROCESSORS_ONLN);
+                new->jobs = new->jobs ? : 1;
+            }
+
+            // without shared state, the golden run end cannot be used to
+            // derive the hang limit
+            if(new->timeout) {
+
+                // explicit hang limit
+
+            } else if(shared==MAP_FAILED) {
+
+                vmiMessage("W", CPU_PREFIX"_FSM",
+                    NO_SRCREF_FMT "Cannot allocate fault campaign shared "
+                    "memory - using hang limit of %u instructions",
+                    NO_SRCREF_ARGS(riscv), FAULT_HANG_FIXED
+                );
+
+                new->timeout = FAULT_HANG_FIXED;
+
+            } else {
+
+                new->shared = shared;
+            }
+
+            new->report = STYPE_CALLOC_N(char, strlen(report)+1);
+            strcpy(new->report, report);
+
+            new->timer = vmirtCreateModelTimer(
+                (vmiProcessorP)riscv, faultTimerCB, 1, 0
+            );
+
+            vmirtSetModelTimer(new->timer, new->injections[0].when ? : 1);
+
+            riscv->fault = new;
+        }
+
+#endif
+    }
+}
+
+//
+// Report the result of a forked injection run at the end of simulation. This
+// must be called by each hart before any model state is freed; in an injection
+// run, the first call reports the result and does not return.
+//
+void riscvFaultEndSimulation(riscvP riscv) {
+
+#if !defined(_WIN32)
+
+    if(childHart) {
+        finishChild(childHart, childHart->fault, False);
+    }
+
+#endif
+}
+
+//
+// Complete any fault injection campaign and free its structures
+//
+void riscvFreeFault(riscvP riscv) {
+
+    riscvFaultP fault = riscv->fault;
+
+    if(fault) {
+
+        faultSharedP shared = fault->shared;
+        Uns32        i;
+
+#if !defined(_WIN32)
+
+        // publish the golden run length, from which outstanding injection runs
+        // derive their hang limit
+        if(shared) {
+            shared->goldenEnd = vmirtGetICount((vmiProcessorP)riscv);
+            __atomic_store_n(&shared->goldenDone, 1, __ATOMIC_RELEASE);
+        }
+
+        // wait for outstanding injection runs
+        while(fault->running) {
+            reapChild(fault);
+        }
+
+        if(shared) {
+            munmap(shared, sizeof(*shared));
+        }
+
+#endif
+
+        writeReport(riscv, fault);
+
+        for(i=0; i<fault->num; i++) {
+            STYPE_FREE(fault->injections[i].desc);
+        }
+
+        vmirtDeleteModelTimer(fault->timer);
+
+        STYPE_FREE(fault->report);
+        STYPE_FREE(fault->injections);
+        STYPE_FREE(fault);
+
+        riscv->fault = 0;
+    }
+}
+
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+// basic types
+#include "hostapi/impTypes.h"
+
+// model header files
+#include "riscvExceptionTypes.h"
+#include "riscvTypeRefs.h"
+
+
+//
+// Allocate fault injection campaign structures if required
+//
+void riscvNewFault(riscvP riscv, riscvParamValuesP params);
+
+//
+// Report the result of a forked injection run at the end of simulation. This
+// must be called by each hart before any model state is freed; in an injection
+// run, the first call reports the result and does not return.
+//
+void riscvFaultEndSimulation(riscvP riscv);
+
+//
+// Complete any fault injection campaign and free its structures
+//
+void riscvFreeFault(riscvP riscv);
+
+//
+// Record an exception for fault outcome classification
+//
+void riscvFaultTrap(riscvP riscv, riscvException exception);
+
@@ -29,19 +29,28 @@
 // Model header files
 #include "riscvCLIC.h"
 #include "riscvCluster.h"
+#include "riscvBranch.h"
 #include "riscvBus.h"
+#include "riscvCache.h"
 #include "riscvConfig.h"
+#include "riscvCosim.h"
 #include "riscvCSR.h"
 #include "riscvDebug.h"
 #include "riscvDecode.h"
 #include "riscvDisassemble.h"
 #include "riscvDoc.h"
+#include "riscvFault.h"
 #include "riscvExceptions.h"
 #include "riscvFunctions.h"
 #include "riscvMessage.h"
 #include "riscvMorph.h"
+#include "riscvMorphStats.h"
+#include "riscvOpcodeMix.h"
 #include "riscvParameters.h"
+#include "riscvProfile.h"
+#include "riscvReplay.h"
 #include "riscvStructure.h"
+#include "riscvTrigger.h"
 #include "riscvUtils.h"
 #include "riscvVM.h"
 #include "riscvVMConstants.h"
@@ -81,6 +90,7 @@ static void initLeafModelCBs(riscvP riscv) {
     riscv->cb.testInterrupt      = riscvTestInterrupt;
     riscv->cb.illegalInstruction = riscvIllegalInstruction;
     riscv->cb.takeException      = riscvTakeAsynchonousException;
+    riscv->cb.debugStep          = riscvDebugStep;
 
     // from riscvDecode.h
     riscv->cb.fetchInstruction   = riscvExtFetchInstruction;
@@ -103,6 +113,10 @@ static void initLeafModelCBs(riscvP riscv) {
 
     // from riscvCSR.h
     riscv->cb.newCSR             = riscvNewCSR;
+
+    // from riscvDebug.h
+    riscv->cb.readRegGroup       = riscvReadRegGroup;
+    riscv->cb.writeRegGroup      = riscvWriteRegGroup;
 }
 
 //
@@ -263,8 +277,10 @@ static void applyParamsSMP(riscvP riscv, riscvParamValuesP params) {
     cfg->debug_mode          = params->debug_mode;
     cfg->debug_address       = params->debug_address;
     cfg->dexc_address        = params->dexc_address;
+    cfg->trigger_num         = params->trigger_num;
     cfg->updatePTEA          = params->updatePTEA;
     cfg->updatePTED          = params->updatePTED;
+    cfg->tlb_prefill         = params->tlb_prefill;
     cfg->unaligned           = params->unaligned;
     cfg->unalignedAMO        = params->unalignedAMO;
     cfg->wfi_is_nop          = params->wfi_is_nop;
@@ -517,6 +533,9 @@ VMI_CONSTRUCTOR_FN(riscvConstructor) {
         // allocate timers
         riscvNewTimers(riscv);
 
+        // allocate debug trigger structures if required
+        riscvNewTrigger(riscv);
+
         // allocate CLIC data structures if required
         if(CLICInternal(riscv)) {
             riscvNewCLIC(riscv, smpContext->index);
@@ -524,6 +543,37 @@ VMI_CONSTRUCTOR_FN(riscvConstructor) {
 
         // do initial reset
         riscvReset(riscv);
+
+        // allocate cache model structures if required
+        riscvNewCache(riscv, paramValues);
+
+        // allocate branch trace and predictor structures if required
+        riscvNewBranch(riscv, paramValues);
+
+        // allocate co-simulation structures if required
+        riscvNewCosim(riscv, paramValues);
+
+        // enable stimulus record or replay if required
+        riscvNewReplay(riscv, paramValues);
+
+        // start fault injection campaign if required
+        riscvNewFault(riscv, paramValues);
+
+        // enable translation statistics if required
+        riscvNewMorphStats(riscv, paramValues);
+
+        // enable dynamic opcode mix if required
+        riscvNewOpcodeMix(riscv, paramValues);
+
+        // enable function profiling or stack sampling if required
+        if(paramValues->enable_profile || paramValues->profile_sample) {
+            riscvNewProfile(
+                riscv,
+                paramValues->profile_file,
+                paramValues->enable_profile,
+                paramValues->profile_sample
+            );
+        }
     }
 }
 
@@ -548,9 +598,23 @@ VMI_DESTRUCTOR_FN(riscvDestructor) {
 
     riscvP riscv = (riscvP)processor;
 
+    // end any fault injection run at the first hart destructor (before any
+    // hart state is freed)
+    riscvFaultEndSimulation(riscv);
+
+    // complete fault injection campaign (before register state is freed)
+    riscvFreeFault(riscv);
+
+    // publish final co-simulation record and free co-simulation structures
+    // (before register state is freed)
+    riscvFreeCosim(riscv);
+
     // free register descriptions
     riscvFreeRegInfo(riscv);
 
+    // free debug trigger structures (before virtual memory structures)
+    riscvFreeTrigger(riscv);
+
     // free virtual memory structures
     riscvVMFree(riscv);
 
@@ -578,6 +642,24 @@ VMI_DESTRUCTOR_FN(riscvDestructor) {
     // free CLIC data structures
     riscvFreeCLIC(riscv);
 
+    // write function profile and free profiling structures
+    riscvFreeProfile(riscv);
+
+    // free cache model structures
+    riscvFreeCache(riscv);
+
+    // write branch trace and free branch trace and predictor structures
+    riscvFreeBranch(riscv);
+
+    // close stimulus log and free stimulus record/replay structures
+    riscvFreeReplay(riscv);
+
+    // report translation statistics and free translation statistics structures
+    riscvFreeMorphStats(riscv);
+
+    // report opcode mix and free opcode mix structures
+    riscvFreeOpcodeMix(riscv);
+
     // free PMP structures
     riscvVMFreePMP(riscv);
 }
@@ -696,6 +778,9 @@ VMI_SAVE_STATE_FN(riscvSaveState) {
     // save timer state not covered by register read/write API
     riscvTimerSave(riscv, cxt, phase);
 
+    // save debug trigger state not covered by register read/write API
+    riscvTriggerSave(riscv, cxt, phase);
+
     // end of SMP cluster
     if(phase==SRT_END) {
         vmirtIterAllProcessors(processor, endSave, 0);
@@ -751,6 +836,9 @@ VMI_RESTORE_STATE_FN(riscvRestoreState) {
     // restore timer state not covered by register read/write API
     riscvTimerRestore(riscv, cxt, phase);
 
+    // restore debug trigger state not covered by register read/write API
+    riscvTriggerRestore(riscv, cxt, phase);
+
     // end of SMP cluster
     if(phase==SRT_END) {
         vmirtIterAllProcessors(processor, endRestore, 0);
@@ -163,6 +163,33 @@ typedef RISCV_ILLEGAL_INSTRUCTION_FN((*riscvIllegalInstructionFn));
 )
 typedef RISCV_TAKE_EXCEPTION_FN((*riscvTakeExceptionFn));
 
+//
+// Condition evaluated at the end of each step of a multi-instruction debug
+// step, returning True if the step should stop there
+//
+#define RISCV_DEBUG_STEP_COND_FN(_NAME) Bool _NAME( \
+    riscvP riscv,               \
+    void  *userData             \
+)
+typedef RISCV_DEBUG_STEP_COND_FN((*riscvDebugStepCondFn));
+
+//
+// Leave Debug mode and execute with results identical to 'count' single steps
+// (or with no step limit if 'count' is zero), re-entering Debug mode only when
+// the steps are complete, if 'useStopPC' is True when a step would end before
+// the instruction at 'stopPC' or, if 'condition' is non-NULL, when it returns
+// True at the end of a step. Returns False if not in Debug mode.
+//
+#define RISCV_DEBUG_STEP_FN(_NAME) Bool _NAME( \
+    riscvP               riscv,     \
+    Uns64                count,     \
+    Bool                 useStopPC, \
+    Uns64                stopPC,    \
+    riscvDebugStepCondFn condition, \
+    void                *userData   \
+)
+typedef RISCV_DEBUG_STEP_FN((*riscvDebugStepFn));
+
 //
 // Fetch an instruction at the given simulated address and if it matches a
 // decode pattern in the given instruction table unpack the instruction fields
@@ -307,6 +334,32 @@ typedef RISCV_MORPH_VOP_FN((*riscvMorphVOpFn));
 )
 typedef RISCV_NEW_CSR_FN((*riscvNewCSRFn));
 
+//
+// Read all registers in a register group into a buffer in register list
+// order, each register occupying (bits+7)/8 bytes, returning the number of
+// bytes required (no registers are read if the buffer is too small)
+//
+#define RISCV_READ_REG_GROUP_FN(_NAME) Uns32 _NAME( \
+    riscvP        riscv,            \
+    vmiRegGroupCP group,            \
+    void         *buffer,           \
+    Uns32         bytes             \
+)
+typedef RISCV_READ_REG_GROUP_FN((*riscvReadRegGroupFn));
+
+//
+// Write all writable registers in a register group from a buffer with the
+// layout used by RISCV_READ_REG_GROUP_FN, returning the number of bytes
+// required (no registers are written if the buffer is too small)
+//
+#define RISCV_WRITE_REG_GROUP_FN(_NAME) Uns32 _NAME( \
+    riscvP        riscv,            \
+    vmiRegGroupCP group,            \
+    const void   *buffer,           \
+    Uns32         bytes             \
+)
+typedef RISCV_WRITE_REG_GROUP_FN((*riscvWriteRegGroupFn));
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // IMPLEMENTED BY DERIVED MODEL
@@ -479,6 +532,7 @@ typedef struct riscvModelCBS {
     riscvTestInterruptFn      testInterrupt;
     riscvIllegalInstructionFn illegalInstruction;
     riscvTakeExceptionFn      takeException;
+    riscvDebugStepFn          debugStep;
 
     // from riscvDecode.h
     riscvFetchInstructionFn   fetchInstruction;
@@ -502,6 +556,10 @@ typedef struct riscvModelCBS {
     // from riscvCSR.h
     riscvNewCSRFn             newCSR;
 
+    // from riscvDebug.h
+    riscvReadRegGroupFn       readRegGroup;
+    riscvWriteRegGroupFn      writeRegGroup;
+
 } riscvModelCB;
 
 //
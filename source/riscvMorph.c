@@ -28,6 +28,9 @@
 // model header files
 #include "riscvBExtension.h"
 #include "riscvBlockState.h"
+#include "riscvBranch.h"
+#include "riscvCache.h"
+#include "riscvCosim.h"
 #include "riscvCSRTypes.h"
 #include "riscvDecode.h"
 #include "riscvDecodeTypes.h"
@@ -36,11 +39,16 @@
 #include "riscvMessage.h"
 #include "riscvModelCallbackTypes.h"
 #include "riscvMorph.h"
+#include "riscvMorphStats.h"
+#include "riscvOpcodeMix.h"
+#include "riscvProfile.h"
 #include "riscvRegisters.h"
 #include "riscvStructure.h"
+#include "riscvTrigger.h"
 #include "riscvTypeRefs.h"
 #include "riscvUtils.h"
 #include "riscvVM.h"
+#include "riscvVectorKernel.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -146,6 +154,7 @@ typedef struct riscvMorphAttrS {
     vmiCondition          cond       : 4;   // comparison condition
     riscvVArgType         argType    : 4;   // vector argument types
     riscvVStartType       vstart0    : 4;   // constraints on vstart=0
+    riscvVKernelOp        vKernel    : 4;   // whole-register kernel operation
     Bool                  fpQNaNOk   : 1;   // allow QNaN in floating point compare?
     Bool                  clearFS1   : 1;   // clear FS1 sign (FSgn operation)
     Bool                  negFS2     : 1;   // negate FS2 sign (FSgn operation)
@@ -1053,6 +1062,9 @@ void riscvWriteRegSize(
         // set mstatus.FS
         updateFS(riscv);
 
+        // add to record of F registers written by this instruction
+        riscv->writtenFMask |= fprMask;
+
     } else {
 
         VMI_ABORT("Bad register specifier 0x%x", r); // LCOV_EXCL_LINE
@@ -1471,14 +1483,15 @@ static void doStoreTMode(riscvP riscv, Uns64 VA, Uns64 value, Uns32 bytes) {
 }
 
 //
-// Create address for transaction load or store
+// Create 64-bit address for transaction or cache model load or store in the
+// given temporary
 //
-static vmiReg emitTransactionVA(
+static vmiReg emitExtendedVA(
     riscvMorphStateP state,
+    vmiReg           raTmp,
     vmiReg           ra,
     Addr             offset
 ) {
-    vmiReg raTmp    = newTmp(state);
     Uns32  raBits   = riscvGetXlenMode(state->riscv);
     Uns32  addrBits = 64;
 
@@ -1493,6 +1506,36 @@ static vmiReg emitTransactionVA(
     return raTmp;
 }
 
+//
+// Return any explicit data domain to use for a load or store because
+// mstatus.MPRV selects a different mode, or NULL if the processor data domain
+// should be used
+//
+static memDomainP getMPRVDomainMT(riscvMorphStateP state) {
+
+    riscvP           riscv      = state->riscv;
+    riscvBlockStateP blockState = riscv->blockState;
+
+    // validate mstatus.MPRV state once per block if required (CSR writes that
+    // could change it end the block)
+    if(riscvVMUseMPRVKey(riscv) && !blockState->MPRVKeyMt) {
+        emitCheckPolymorphic();
+        blockState->MPRVKeyMt = True;
+    }
+
+    return riscvVMGetMPRVDomainMT(riscv);
+}
+
+//
+// Emit call to switch the processor data domain to or from the mstatus.MPRV
+// domain
+//
+static void emitSetMPRVDataDomain(Bool enable) {
+    vmimtArgProcessor();
+    vmimtArgUns32(enable);
+    vmimtCallAttrs((vmiCallFn)riscvVMSetMPRVDataDomain, VMCA_NO_INVALIDATE);
+}
+
 //
 // Transaction load value from memory for explicit memBits and offset
 //
@@ -1505,12 +1548,19 @@ static void emitLoadTModeMBO(
     vmiReg           ra,
     memConstraint    constraint
 ) {
-    Bool      sExtend = !state->info.unsExt;
-    memEndian endian  = riscvGetCurrentDataEndianMT(state->riscv);
-    vmiCallFn cb      = (vmiCallFn)doLoadTMode;
+    Bool       sExtend = !state->info.unsExt;
+    memEndian  endian  = riscvGetCurrentDataEndianMT(state->riscv);
+    vmiCallFn  cb      = (vmiCallFn)doLoadTMode;
+    memDomainP domain  = getMPRVDomainMT(state);
 
     // extend address to 64 bits if required
-    ra = emitTransactionVA(state, ra, offset);
+    ra = emitExtendedVA(state, newTmp(state), ra, offset);
+
+    // transaction loads use the processor data domain, so switch it for the
+    // load if mstatus.MPRV is in effect
+    if(domain) {
+        emitSetMPRVDataDomain(True);
+    }
 
     // emit code to perform transaction load
     vmimtArgProcessor();
@@ -1518,6 +1568,11 @@ static void emitLoadTModeMBO(
     vmimtArgUns32(memBits/8);
     vmimtCallResultAttrs(cb, memBits, rd, VMCA_FP_RESTORE);
 
+    // restore Machine mode data domain
+    if(domain) {
+        emitSetMPRVDataDomain(False);
+    }
+
     // byte swap result if required (here for completeness, but not expected
     // to be executed)
     if(endian==MEM_ENDIAN_BIG) {                        // LCOV_EXCL_LINE
@@ -1539,11 +1594,12 @@ static void emitStoreTModeMBO(
     vmiReg           rs,
     memConstraint    constraint
 ) {
-    memEndian endian = riscvGetCurrentDataEndianMT(state->riscv);
-    vmiCallFn cb     = (vmiCallFn)doStoreTMode;
+    memEndian  endian = riscvGetCurrentDataEndianMT(state->riscv);
+    vmiCallFn  cb     = (vmiCallFn)doStoreTMode;
+    memDomainP domain = getMPRVDomainMT(state);
 
     // extend address to 64 bits if required
-    ra = emitTransactionVA(state, ra, offset);
+    ra = emitExtendedVA(state, newTmp(state), ra, offset);
 
     // byte swap source if required (here for completeness, but not expected
     // to be executed)
@@ -1553,12 +1609,211 @@ static void emitStoreTModeMBO(
         rs = rsTmp;                                     // LCOV_EXCL_LINE
     }                                                   // LCOV_EXCL_LINE
 
+    // transaction stores use the processor data domain, so switch it for the
+    // store if mstatus.MPRV is in effect
+    if(domain) {
+        emitSetMPRVDataDomain(True);
+    }
+
     // emit code to perform transaction store
     vmimtArgProcessor();
     vmimtArgReg(64, ra);
     vmimtArgReg(64, rs);
     vmimtArgUns32(memBits/8);
     vmimtCallAttrs(cb, VMCA_FP_RESTORE);
+
+    // restore Machine mode data domain
+    if(domain) {
+        emitSetMPRVDataDomain(False);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// CACHE MODEL UTILITIES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Emit code saving the address of a data load or store for the cache model, if
+// enabled (the address is saved before the access because the access may
+// overwrite the base register)
+//
+static void emitCacheDataVA(riscvMorphStateP state, vmiReg ra, Addr offset) {
+
+    if(state->riscv->cache) {
+        emitExtendedVA(state, RISCV_CACHE_VA, ra, offset);
+    }
+}
+
+//
+// Emit call recording a data load or store for the cache model, if enabled
+// (emitted after the access, so that accesses that fault are not recorded)
+//
+static void emitCacheDataAccess(
+    riscvMorphStateP     state,
+    Uns32                memBits,
+    riscvCacheAccessType type
+) {
+    riscvP riscv = state->riscv;
+
+    if(riscv->cache) {
+
+        Uns32      bytes     = memBits/8;
+        Uns32      lineShift = riscvGetCacheLineShift(riscv);
+        Uns32      lineBytes = 1<<lineShift;
+        memDomainP domain    = getMPRVDomainMT(state);
+        vmiReg     VA        = RISCV_CACHE_VA;
+        vmiReg     line      = RISCV_CACHE_LINE;
+        vmiReg     tmp       = newTmp(state);
+        vmiLabelP  miss      = vmimtNewLabel();
+        vmiLabelP  done      = vmimtNewLabel();
+
+        // an access wholly within the last data line accessed must hit, so
+        // count it here without a call (the line is most-recently used, so
+        // replacement state is unchanged)
+        if(bytes<=lineBytes) {
+
+            Uns32 maxOffset = lineBytes-bytes;
+
+            vmimtBinopRRC(64, vmi_SHR, tmp, VA, lineShift, 0);
+            vmimtCompareRRJumpLabel(64, vmi_COND_NE, tmp, line, miss);
+            vmimtBinopRRC(64, vmi_AND, tmp, VA, lineBytes-1, 0);
+            vmimtCompareRCJumpLabel(64, vmi_COND_NBE, tmp, maxOffset, miss);
+            vmimtBinopRC(64, vmi_ADD, RISCV_CACHE_HITS, 1, 0);
+            vmimtUncondJumpLabel(done);
+        }
+
+        freeTmp(state);
+
+        // record any other access in the cache model
+        vmimtInsertLabel(miss);
+        vmimtArgProcessor();
+        vmimtArgNatAddress(domain);
+        vmimtArgReg(64, VA);
+        vmimtArgUns32(bytes);
+        vmimtArgUns32(type);
+        vmimtCallAttrs((vmiCallFn)riscvCacheAccess, VMCA_NO_INVALIDATE);
+        vmimtInsertLabel(done);
+    }
+}
+
+//
+// Emit call recording an instruction fetch for the cache model if it accesses
+// a cache line not already fetched by a previous instruction in this block
+//
+static void emitCacheFetch(riscvMorphStateP state) {
+
+    riscvP           riscv      = state->riscv;
+    riscvBlockStateP blockState = riscv->blockState;
+    Uns64            thisPC     = state->info.thisPC;
+    Uns32            bytes      = state->info.bytes;
+
+    if(riscv->cache) {
+
+        Uns32 lineShift = riscvGetCacheLineShift(riscv);
+        Uns64 first     = thisPC >> lineShift;
+        Uns64 last      = (thisPC+bytes-1) >> lineShift;
+
+        if((first!=blockState->fetchLineMt) || (last!=first)) {
+
+            vmimtArgProcessor();
+            vmimtArgNatAddress(0);
+            vmimtArgUns64(thisPC);
+            vmimtArgUns32(bytes);
+            vmimtArgUns32(RVCA_FETCH);
+            vmimtCallAttrs((vmiCallFn)riscvCacheAccess, VMCA_NO_INVALIDATE);
+
+            blockState->fetchLineMt = last;
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// CO-SIMULATION UTILITIES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Emit call publishing the co-simulation record for the previous instruction
+// and starting a record for this one, passing the X and F registers written by
+// the previous instruction if it is in this block (these are reported even if
+// the value is unchanged)
+//
+static void emitCosimRetire(riscvMorphStateP state) {
+
+    riscvP           riscv      = state->riscv;
+    riscvBlockStateP blockState = riscv->blockState;
+
+    if(riscv->cosim) {
+
+        vmimtArgProcessor();
+        vmimtArgUns64(state->info.thisPC);
+        vmimtArgUns32(state->info.instruction);
+        vmimtArgUns32(blockState->cosimXMaskMt);
+        vmimtArgUns32(blockState->cosimFMaskMt);
+        vmimtArgUns32(blockState->cosimMaskMt);
+        vmimtCallAttrs((vmiCallFn)riscvCosimRetire, VMCA_NO_INVALIDATE);
+
+        blockState->cosimXMaskMt = 0;
+        blockState->cosimFMaskMt = 0;
+        blockState->cosimMaskMt  = False;
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// DEBUG TRIGGER AND STEP UTILITIES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Emit call firing execute triggers before this instruction if any trigger
+// matches it in the current mode; instructions that match no trigger have no
+// check, so translated code is only affected at trigger addresses
+//
+static void emitTriggerCheck(riscvMorphStateP state) {
+
+    riscvP riscv       = state->riscv;
+    Uns64  thisPC      = state->info.thisPC;
+    Uns32  instruction = state->info.instruction;
+
+    if(riscvTriggerExecuteMatch(riscv, thisPC, instruction)) {
+
+        vmiLabelP noTrigger = vmimtNewLabel();
+
+        // triggers do not fire in Debug mode
+        vmimtTestRCJumpLabel(8, vmi_COND_NZ, RISCV_DM, 1, noTrigger);
+
+        vmimtArgProcessor();
+        vmimtArgUns64(thisPC);
+        vmimtArgUns32(instruction);
+        vmimtCallAttrs((vmiCallFn)riscvTriggerExecute, VMCA_EXCEPTION);
+
+        vmimtInsertLabel(noTrigger);
+    }
+}
+
+//
+// Emit call that may end a multi-instruction debug step before this
+// instruction if it is at the step stop address
+//
+static void emitDebugStepCheck(riscvMorphStateP state) {
+
+    riscvP riscv  = state->riscv;
+    Uns64  thisPC = state->info.thisPC;
+
+    if(riscvDebugStepStopMatch(riscv, thisPC)) {
+
+        vmiLabelP noStop = vmimtNewLabel();
+
+        // steps do not stop in Debug mode
+        vmimtTestRCJumpLabel(8, vmi_COND_NZ, RISCV_DM, 1, noStop);
+
+        vmimtArgProcessor();
+        vmimtArgUns64(thisPC);
+        vmimtCallAttrs((vmiCallFn)riscvDebugStepStop, VMCA_EXCEPTION);
+
+        vmimtInsertLabel(noStop);
+    }
 }
 
 
@@ -1578,10 +1833,19 @@ static void emitLoadNormalMBO(
     vmiReg           ra,
     memConstraint    constraint
 ) {
-    Bool      sExtend = !state->info.unsExt;
-    memEndian endian  = riscvGetCurrentDataEndianMT(state->riscv);
+    Bool       sExtend = !state->info.unsExt;
+    memEndian  endian  = riscvGetCurrentDataEndianMT(state->riscv);
+    memDomainP domain  = getMPRVDomainMT(state);
 
-    vmimtLoadRRO(rdBits, memBits, offset, rd, ra, endian, sExtend, constraint);
+    if(domain) {
+        vmimtLoadRRODomain(
+            domain, rdBits, memBits, offset, rd, ra, endian, sExtend, constraint
+        );
+    } else {
+        vmimtLoadRRO(
+            rdBits, memBits, offset, rd, ra, endian, sExtend, constraint
+        );
+    }
 }
 
 //
@@ -1595,9 +1859,14 @@ static void emitStoreNormalMBO(
     vmiReg           rs,
     memConstraint    constraint
 ) {
-    memEndian endian = riscvGetCurrentDataEndianMT(state->riscv);
+    memEndian  endian = riscvGetCurrentDataEndianMT(state->riscv);
+    memDomainP domain = getMPRVDomainMT(state);
 
-    vmimtStoreRRO(memBits, offset, ra, rs, endian, constraint);
+    if(domain) {
+        vmimtStoreRRODomain(domain, memBits, offset, ra, rs, endian, constraint);
+    } else {
+        vmimtStoreRRO(memBits, offset, ra, rs, endian, constraint);
+    }
 }
 
 //
@@ -1612,11 +1881,15 @@ static void emitLoadCommonMBO(
     Uns64            offset,
     memConstraint    constraint
 ) {
+    emitCacheDataVA(state, ra, offset);
+
     if(inTransactionMode(state)) {
         emitLoadTModeMBO(state, rdBits, memBits, offset, rd, ra, constraint);
     } else {
         emitLoadNormalMBO(state, rdBits, memBits, offset, rd, ra, constraint);
     }
+
+    emitCacheDataAccess(state, memBits, RVCA_LOAD);
 }
 
 //
@@ -1630,11 +1903,15 @@ static void emitStoreCommonMBO(
     Uns64            offset,
     memConstraint    constraint
 ) {
+    emitCacheDataVA(state, ra, offset);
+
     if(inTransactionMode(state)) {
         emitStoreTModeMBO(state, memBits, offset, ra, rs, constraint);
     } else {
         emitStoreNormalMBO(state, memBits, offset, ra, rs, constraint);
     }
+
+    emitCacheDataAccess(state, memBits, RVCA_STORE);
 }
 
 //
@@ -1676,11 +1953,24 @@ static void emitTryStoreCommon(
     vmiReg           ra,
     memConstraint    constraint
 ) {
-    Uns32 memBits = state->info.memBits;
-    Uns64 offset  = state->info.c;
+    Uns32      memBits = state->info.memBits;
+    Uns64      offset  = state->info.c;
+    memDomainP domain  = getMPRVDomainMT(state);
+
+    // there is no explicit-domain try-store, so switch the processor data
+    // domain for the probe if mstatus.MPRV is in effect (if the probe faults,
+    // the domain is restored when the exception is taken)
+    if(domain) {
+        emitSetMPRVDataDomain(True);
+    }
 
     // generate Store/AMO exception in preference to Load exception
     vmimtTryStoreRC(memBits, offset, ra, constraint);
+
+    // restore Machine mode data domain
+    if(domain) {
+        emitSetMPRVDataDomain(False);
+    }
 }
 
 
@@ -1978,6 +2268,89 @@ static void checkTargetAddressAlignedR(
     }
 }
 
+//
+// Emit code recording a conditional branch outcome for branch trace and
+// predictor models. Predictor statistics for the branch are found when the
+// code is translated. With no predictor, outcomes are accumulated in the
+// branch map inline, calling the trace encoder only when the map is full.
+//
+static void emitBranchCond(riscvMorphStateP state, vmiReg taken) {
+
+    riscvP riscv = state->riscv;
+
+    if(riscvBranchHasPredictor(riscv)) {
+
+        Uns64             PC    = state->info.thisPC;
+        riscvBranchStatsP stats = riscvBranchGetStats(riscv, PC);
+
+        vmimtArgProcessor();
+        vmimtArgNatAddress(stats);
+        vmimtArgReg(8, taken);
+        vmimtCallAttrs((vmiCallFn)riscvBranchCond, VMCA_NO_INVALIDATE);
+
+    } else {
+
+        vmiReg    mapBits = RISCV_BRANCH_MAP_BITS;
+        vmiReg    mapNum  = RISCV_BRANCH_MAP_NUM;
+        vmiReg    bit     = newTmp(state);
+        vmiLabelP notFull = vmimtNewLabel();
+
+        // add outcome to the map
+        vmimtMoveExtendRR(32, bit, 8, taken, False);
+        vmimtBinopRR(32, vmi_SHL, bit, mapNum, 0);
+        vmimtBinopRR(32, vmi_OR, mapBits, bit, 0);
+        vmimtBinopRC(32, vmi_ADD, mapNum, 1, 0);
+
+        // emit the map if it is full
+        vmimtCompareRCJumpLabel(
+            32, vmi_COND_NE, mapNum, RISCV_BRANCH_MAP_MAX, notFull
+        );
+        vmimtArgProcessor();
+        vmimtCallAttrs((vmiCallFn)riscvBranchFlushMap, VMCA_NO_INVALIDATE);
+        vmimtInsertLabel(notFull);
+
+        freeTmp(state);
+    }
+}
+
+//
+// Emit call recording a direct call for branch trace and predictor models
+//
+static void emitBranchCall(Uns64 linkPC) {
+    vmimtArgProcessor();
+    vmimtArgUns64(linkPC);
+    vmimtCallAttrs((vmiCallFn)riscvBranchCall, VMCA_NO_INVALIDATE);
+}
+
+//
+// Emit call recording an indirect jump, call or return for branch trace and
+// predictor models
+//
+static void emitBranchIndirect(
+    riscvMorphStateP state,
+    Uns32            bits,
+    vmiReg           tgt,
+    Uns64            linkPC,
+    vmiJumpHint      hint
+) {
+    Uns64             PC    = state->info.thisPC;
+    riscvBranchStatsP stats = riscvBranchGetStats(state->riscv, PC);
+    riscvBranchKind   kind  = RVBK_JUMP;
+
+    if(hint==vmi_JH_CALL) {
+        kind = RVBK_CALL;
+    } else if(hint==vmi_JH_RETURN) {
+        kind = RVBK_RETURN;
+    }
+
+    vmimtArgProcessor();
+    vmimtArgNatAddress(stats);
+    vmimtArgRegSimAddress(bits, tgt);
+    vmimtArgUns64(linkPC);
+    vmimtArgUns32(kind);
+    vmimtCallAttrs((vmiCallFn)riscvBranchIndirect, VMCA_NO_INVALIDATE);
+}
+
 //
 // Branch based on register comparison
 //
@@ -2008,10 +2381,71 @@ static RISCV_MORPH_FN(emitBranchRR) {
         vmimtInsertLabel(noBranch);
     }
 
+    // record branch outcome if required
+    if(riscv->branch) {
+        emitBranchCond(state, tmp);
+    }
+
     // do branch
     vmimtCondJump(tmp, True, 0, tgt, VMI_NOREG, vmi_JH_RELATIVE);
 }
 
+//
+// Return a Boolean indicating if function profiling is active
+//
+inline static Bool profileActive(riscvMorphStateP state) {
+
+    riscvP riscv = state->riscv;
+
+    // validate function profiling state if required
+    if(riscv->useProfile) {
+        emitCheckPolymorphic();
+    }
+
+    return (riscv->pmKey & PMK_PROFILE) != 0;
+}
+
+//
+// Emit call recording a function call to a constant target address
+//
+static void emitProfileCallC(riscvP riscv, Uns64 tgt, Uns64 linkPC) {
+
+    // resolve the called function when the call is translated
+    riscvProfileFnP callee = riscvProfileGetFn(riscv, tgt);
+
+    vmimtArgProcessor();
+    vmimtArgNatAddress(callee);
+    vmimtArgUns64(linkPC);
+    vmimtCallAttrs((vmiCallFn)riscvProfileCallFn, VMCA_NO_INVALIDATE);
+}
+
+//
+// Emit call recording a function call to a register target address
+//
+static void emitProfileCallR(Uns32 bits, vmiReg tgt, Uns64 linkPC) {
+    vmimtArgProcessor();
+    vmimtArgRegSimAddress(bits, tgt);
+    vmimtArgUns64(linkPC);
+    vmimtCallAttrs((vmiCallFn)riscvProfileCall, VMCA_NO_INVALIDATE);
+}
+
+//
+// Emit call recording a function return to a register target address
+//
+void riscvEmitProfileReturn(riscvP riscv, vmiReg tgt) {
+
+    // validate function profiling state if required
+    if(riscv->useProfile) {
+        emitCheckPolymorphic();
+    }
+
+    if(riscv->pmKey & PMK_PROFILE) {
+        vmimtArgProcessor();
+        vmimtArgRegSimAddress(riscvGetXlenMode(riscv), tgt);
+        vmimtCallAttrs((vmiCallFn)riscvProfileReturn, VMCA_NO_INVALIDATE);
+    }
+}
+
 //
 // Return link address if the current instruction requires it
 //
@@ -2047,6 +2481,17 @@ static RISCV_MORPH_FN(emitJAL) {
 
     // emit call using calculated linkPC and adjusted lr
     Uns64 linkPC = getLinkPC(state, &lr.r);
+
+    // record function call if profiling is active
+    if((hint==vmi_JH_CALL) && profileActive(state)) {
+        emitProfileCallC(riscv, tgt, linkPC);
+    }
+
+    // record direct call if required
+    if((hint==vmi_JH_CALL) && riscv->branch) {
+        emitBranchCall(linkPC);
+    }
+
     vmimtUncondJump(linkPC, tgt, lr.r, hint|vmi_JH_RELATIVE);
 }
 
@@ -2082,6 +2527,19 @@ static RISCV_MORPH_FN(emitJALR) {
 
     // emit call using calculated linkPC and adjusted lr
     Uns64 linkPC = getLinkPC(state, &lr.r);
+
+    // record function call or return if profiling is active
+    if(hint==vmi_JH_RETURN) {
+        riscvEmitProfileReturn(state->riscv, ra.r);
+    } else if((hint==vmi_JH_CALL) && profileActive(state)) {
+        emitProfileCallR(bits, ra.r, linkPC);
+    }
+
+    // record indirect jump, call or return if required
+    if(state->riscv->branch) {
+        emitBranchIndirect(state, bits, ra.r, linkPC, hint);
+    }
+
     vmimtUncondJumpReg(linkPC, ra.r, lr.r, hint|vmi_JH_RELATIVE);
 }
 
@@ -2663,6 +3121,29 @@ static RISCV_MORPH_FN(emitSFENCE_VMA) {
     } else {
         vmimtCall((vmiCallFn)riscvVMInvalidateVAASID);
     }
+
+    // the cache model is physically tagged, but filters repeated accesses
+    // by virtual address
+    if(riscv->cache) {
+        vmimtArgProcessor();
+        vmimtCallAttrs((vmiCallFn)riscvCacheRefreshMapping, VMCA_NO_INVALIDATE);
+        riscv->blockState->fetchLineMt = -1;
+    }
+}
+
+//
+// Implement FENCE.I instruction
+//
+static RISCV_MORPH_FN(emitFENCEI) {
+
+    riscvP riscv = state->riscv;
+
+    // invalidate the instruction cache model if required
+    if(riscv->cache) {
+        vmimtArgProcessor();
+        vmimtCallAttrs((vmiCallFn)riscvCacheInvalidateI, VMCA_NO_INVALIDATE);
+        riscv->blockState->fetchLineMt = -1;
+    }
 }
 
 
@@ -3476,6 +3957,29 @@ inline static Bool enableBFLOAT16(riscvP riscv) {
 	return riscv->configInfo.fp16_version==RVFP16_BFLOAT16;
 }
 
+//
+// Return the number of explicit mantissa bits in a floating point value of the
+// given size
+//
+static Uns32 getFMantissaBits(riscvP riscv, Uns32 bits) {
+
+    Uns32 result = 0;
+
+    if(bits==64) {
+        result = FP64_EXP_SHIFT;
+    } else if(bits==32) {
+        result = FP32_EXP_SHIFT;
+    } else if(bits!=16) {
+        VMI_ABORT("unimplemented bits %u", bits); // LCOV_EXCL_LINE
+    } else if(enableBFLOAT16(riscv)) {
+        result = FP32_EXP_SHIFT-16;
+    } else {
+        result = FP16_EXP_SHIFT;
+    }
+
+    return result;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // FLOATING POINT INSTRUCTIONS
@@ -3688,17 +4192,116 @@ static void emitFCompareInt(
     vmimtBinopRC(8, vmi_AND, rd, relation, &zf);
 }
 
+//
+// Return the integer comparison condition giving the same result as the given
+// floating point relation for ordered operands converted to signed integer keys
+// (or False if there is no such condition)
+//
+static Bool getFCompareCond(vmiFPRelation relation, vmiCondition *condP) {
+
+    Bool ok = True;
+
+    switch(relation) {
+        case vmi_FPRL_EQUAL:
+            *condP = vmi_COND_EQ;
+            break;
+        case vmi_FPRL_LESS:
+            *condP = vmi_COND_L;
+            break;
+        case vmi_FPRL_LESS|vmi_FPRL_EQUAL:
+            *condP = vmi_COND_LE;
+            break;
+        case vmi_FPRL_GREATER:
+            *condP = vmi_COND_NLE;
+            break;
+        case vmi_FPRL_GREATER|vmi_FPRL_EQUAL:
+            *condP = vmi_COND_NL;
+            break;
+        default:
+            ok = False;
+            break;
+    }
+
+    return ok;
+}
+
+//
+// Convert a floating point value in fs to a signed integer key in key that
+// orders in the same way as the value, with -0 and +0 equal. On entry, key
+// holds the value magnitude.
+//
+static void emitFCompareKey(
+    riscvMorphStateP state,
+    vmiReg           key,
+    vmiReg           fs,
+    Uns32            bits
+) {
+    vmiReg mask = newTmp(state);
+
+    // mask is all ones if the value is negative, otherwise zero
+    vmimtBinopRRC(bits, vmi_SAR, mask, fs, bits-1, 0);
+
+    // negate the magnitude of negative values
+    vmimtBinopRR(bits, vmi_XOR, key, mask, 0);
+    vmimtBinopRR(bits, vmi_SUB, key, mask, 0);
+
+    freeTmp(state);
+}
+
 //
 // Implement floating point comparison
 //
 static RISCV_MORPH_FN(emitFCompare) {
 
-    unpackedReg rd    = unpackRX(state, 0);
-    unpackedReg fs1   = unpackFS(state, 1);
-    unpackedReg fs2   = unpackFS(state, 2);
-    vmiFType    typeS = fs1.ftype;
+    unpackedReg   rd       = unpackRX(state, 0);
+    unpackedReg   fs1      = unpackFS(state, 1);
+    unpackedReg   fs2      = unpackFS(state, 2);
+    vmiFType      typeS    = fs1.ftype;
+    Uns32         bits     = fs1.bits;
+    vmiFPRelation relation = state->attrs->fpRel & ~RVFCMP_QNOK;
+    vmiCondition  cond;
+
+    if(getFCompareCond(relation, &cond)) {
+
+        // comparisons of operands that are not NaN raise no exceptions and
+        // can be implemented using integer operations
+        Uns32     mBits = getFMantissaBits(state->riscv, bits);
+        Uns64     sign  = 1ULL<<(bits-1);
+        Uns64     inf   = (sign-1) & (-1ULL<<mBits);
+        vmiLabelP slow  = vmimtNewLabel();
+        vmiLabelP done  = vmimtNewLabel();
+        vmiReg    key1  = newTmp(state);
+        vmiReg    key2  = newTmp(state);
+
+        // the general comparison may update fflags, which marks mstatus.FS
+        // dirty when code is translated, so do that update on both paths
+        riscvGetFPFlagsMT(state->riscv);
+
+        // use the general comparison if either operand is a NaN
+        vmimtBinopRRC(bits, vmi_AND, key1, fs1.r, ~sign, 0);
+        vmimtCompareRCJumpLabel(bits, vmi_COND_NBE, key1, inf, slow);
+        vmimtBinopRRC(bits, vmi_AND, key2, fs2.r, ~sign, 0);
+        vmimtCompareRCJumpLabel(bits, vmi_COND_NBE, key2, inf, slow);
+
+        // compare signed integer keys
+        emitFCompareKey(state, key1, fs1.r, bits);
+        emitFCompareKey(state, key2, fs2.r, bits);
+        vmimtCompareRR(bits, cond, key1, key2, rd.r);
+        vmimtUncondJumpLabel(done);
+
+        // general comparison
+        vmimtInsertLabel(slow);
+        emitFCompareInt(state, rd.r, fs1.r, fs2.r, typeS);
+
+        vmimtInsertLabel(done);
+
+        freeTmp(state);
+        freeTmp(state);
+
+    } else {
 
-    emitFCompareInt(state, rd.r, fs1.r, fs2.r, typeS);
+        emitFCompareInt(state, rd.r, fs1.r, fs2.r, typeS);
+    }
 
     writeUnpackedSize(rd, 8);
 }
@@ -3770,118 +4373,85 @@ typedef enum riscvFClassE {
 } riscvFClass;
 
 //
-// Implement 16-bit FClass operation
+// Emit code to set rd to the positive or negative fclass value depending on
+// the sign flag, then jump to the done label
 //
-static riscvFClass doFClass16(Uns16 value) {
-
-    Bool        isSigned = (value & FP16_SIGN_MASK) && True;
-    riscvFClass result;
-
-    if(isSNaN16(value)) {
-        result = RVFC_SNAN;
-    } else if(isQNaN16(value)) {
-        result = RVFC_QNAN;
-    } else if(isInf16(value)) {
-        result = isSigned ? RVFC_NINF : RVFC_PINF;
-    } else if(isDenorm16(value)) {
-        result = isSigned ? RVFC_NDENORM : RVFC_PDENORM;
-    } else if(isZero16(value)) {
-        result = isSigned ? RVFC_NZERO : RVFC_PZERO;
-    } else {
-        result = isSigned ? RVFC_NNORM : RVFC_PNORM;
-    }
-
-    return result;
+static void emitFClassSigned(
+    Uns32       bitsD,
+    vmiReg      rd,
+    vmiReg      isNeg,
+    riscvFClass pos,
+    riscvFClass neg,
+    vmiLabelP   done
+) {
+    vmimtMoveRC(bitsD, rd, neg);
+    vmimtCondMoveRRC(bitsD, isNeg, True, rd, rd, pos);
+    vmimtUncondJumpLabel(done);
 }
 
 //
-// Implement 32-bit FClass operation
+// Implement fclass operation, internal interface (the class is determined
+// from the magnitude using integer comparisons)
 //
-static riscvFClass doFClass32(Uns32 value) {
-
-    Bool        isSigned = (value & FP32_SIGN_MASK) && True;
-    riscvFClass result;
-
-    if(isSNaN32(value)) {
-        result = RVFC_SNAN;
-    } else if(isQNaN32(value)) {
-        result = RVFC_QNAN;
-    } else if(isInf32(value)) {
-        result = isSigned ? RVFC_NINF : RVFC_PINF;
-    } else if(isDenorm32(value)) {
-        result = isSigned ? RVFC_NDENORM : RVFC_PDENORM;
-    } else if(isZero32(value)) {
-        result = isSigned ? RVFC_NZERO : RVFC_PZERO;
-    } else {
-        result = isSigned ? RVFC_NNORM : RVFC_PNORM;
-    }
+static void emitFClassInt(
+    riscvMorphStateP state,
+    vmiReg           rd,
+    vmiReg           fs1,
+    Uns32            bitsS,
+    Uns32            bitsD
+) {
+    Uns32     mBits   = getFMantissaBits(state->riscv, bitsS);
+    Uns64     sign    = 1ULL<<(bitsS-1);
+    Uns64     minNorm = 1ULL<<mBits;
+    Uns64     inf     = (sign-1) & -minNorm;
+    Uns64     quiet   = minNorm>>1;
+    vmiLabelP notNorm = vmimtNewLabel();
+    vmiLabelP isZero  = vmimtNewLabel();
+    vmiLabelP special = vmimtNewLabel();
+    vmiLabelP isNaN   = vmimtNewLabel();
+    vmiLabelP done    = vmimtNewLabel();
+    vmiReg    abs     = newTmp(state);
+    vmiReg    isNeg   = newTmp(state);
 
-    return result;
-}
+    // mark this instruction as floating point
+    vmimtInstructionClassAdd(OCL_IC_FLOAT);
 
-//
-// Implement 64-bit FClass operation
-//
-static riscvFClass doFClass64(Uns64 value) {
+    // get magnitude and sign (rd may be the same as fs1 for vector operations,
+    // so fs1 must not be used once rd is written)
+    vmimtBinopRRC(bitsS, vmi_AND, abs, fs1, ~sign, 0);
+    vmimtCompareRR(bitsS, vmi_COND_NE, fs1, abs, isNeg);
 
-    Bool        isSigned = (value & FP64_SIGN_MASK) && True;
-    riscvFClass result;
+    // infinities and NaNs have magnitude of at least infinity
+    vmimtCompareRCJumpLabel(bitsS, vmi_COND_NB, abs, inf, special);
 
-    if(isSNaN64(value)) {
-        result = RVFC_SNAN;
-    } else if(isQNaN64(value)) {
-        result = RVFC_QNAN;
-    } else if(isInf64(value)) {
-        result = isSigned ? RVFC_NINF : RVFC_PINF;
-    } else if(isDenorm64(value)) {
-        result = isSigned ? RVFC_NDENORM : RVFC_PDENORM;
-    } else if(isZero64(value)) {
-        result = isSigned ? RVFC_NZERO : RVFC_PZERO;
-    } else {
-        result = isSigned ? RVFC_NNORM : RVFC_PNORM;
-    }
+    // normal values
+    vmimtCompareRCJumpLabel(bitsS, vmi_COND_B, abs, minNorm, notNorm);
+    emitFClassSigned(bitsD, rd, isNeg, RVFC_PNORM, RVFC_NNORM, done);
 
-    return result;
-}
+    // denormal values
+    vmimtInsertLabel(notNorm);
+    vmimtCompareRCJumpLabel(bitsS, vmi_COND_EQ, abs, 0, isZero);
+    emitFClassSigned(bitsD, rd, isNeg, RVFC_PDENORM, RVFC_NDENORM, done);
 
-//
-// Implement BFLOAT FClass operation
-//
-static riscvFClass doFClassBFLOAT(Uns16 value) {
-    return doFClass32(value<<16);
-}
+    // zero values
+    vmimtInsertLabel(isZero);
+    emitFClassSigned(bitsD, rd, isNeg, RVFC_PZERO, RVFC_NZERO, done);
 
-//
-// Implement fclass operation, internal interface
-//
-static void emitFClassInt(
-    riscvP riscv,
-    vmiReg rd,
-    vmiReg fs1,
-    Uns32  bitsS,
-    Uns32  bitsD
-) {
-    vmiCallFn cb = 0;
+    // infinities
+    vmimtInsertLabel(special);
+    vmimtCompareRCJumpLabel(bitsS, vmi_COND_NE, abs, inf, isNaN);
+    emitFClassSigned(bitsD, rd, isNeg, RVFC_PINF, RVFC_NINF, done);
 
-    // mark this instruction as floating point
-    vmimtInstructionClassAdd(OCL_IC_FLOAT);
+    // NaNs, quiet if the most-significant mantissa bit is set
+    vmimtInsertLabel(isNaN);
+    vmimtMoveRC(bitsD, rd, RVFC_QNAN);
+    vmimtTestRCJumpLabel(bitsS, vmi_COND_NZ, abs, quiet, done);
+    vmimtMoveRC(bitsD, rd, RVFC_SNAN);
 
-    // get function implementing fclass
-    if(bitsS==32) {
-        cb = (vmiCallFn)doFClass32;
-    } else if(bitsS==64) {
-        cb = (vmiCallFn)doFClass64;
-    } else if(bitsS!=16) {
-        VMI_ABORT("unimplemented bits %u", bitsS); // LCOV_EXCL_LINE
-    } else if(enableBFLOAT16(riscv)) {
-        cb = (vmiCallFn)doFClassBFLOAT;
-    } else {
-        cb = (vmiCallFn)doFClass16;
-    }
+    vmimtInsertLabel(done);
 
-    // call function
-    vmimtArgReg(bitsS, fs1);
-    vmimtCallResultAttrs(cb, bitsD, rd, VMCA_PURE);
+    freeTmp(state);
+    freeTmp(state);
 }
 
 //
@@ -3894,7 +4464,7 @@ static RISCV_MORPH_FN(emitFClass) {
     Uns32       bitsD = 32;
     Uns32       bitsS = fs1.bits;
 
-    emitFClassInt(state->riscv, rd.r, fs1.r, bitsS, bitsD);
+    emitFClassInt(state, rd.r, fs1.r, bitsS, bitsD);
 
     writeUnpackedSize(rd, bitsD);
 }
@@ -4408,6 +4978,9 @@ void riscvConfigureVector(riscvP riscv) {
     // allocate vector registers if required
     if(riscv->configInfo.arch & ISA_V) {
         riscv->v = STYPE_CALLOC_N(Uns32, (vRegBytes/4)*VREG_NUM);
+
+        // allocate whole-register kernel result buffer (up to LMUL=8)
+        riscv->vKernelBuffer = STYPE_CALLOC_N(Uns8, vRegBytes*8);
     }
 }
 
@@ -4420,6 +4993,11 @@ void riscvFreeVector(riscvP riscv) {
     if(riscv->v) {
     	STYPE_FREE(riscv->v);
     }
+
+    // free whole-register kernel result buffer if required
+    if(riscv->vKernelBuffer) {
+        STYPE_FREE(riscv->vKernelBuffer);
+    }
 }
 
 
@@ -6148,13 +6726,199 @@ static Bool checkVectorOp(riscvMorphStateP state, iterDescP id) {
     return validVFPRM(state) && (!checkCB || checkCB(state, id));
 }
 
+//
+// Record deferred tail zeroing of a register group from the current vstart
+// (called from JIT code). Any deferred tail previously pending below the new
+// offset has already been completed before the operation (see
+// emitVZeroPending), so the new offset simply replaces it.
+//
+static void doVZeroTailDeferred(
+    riscvP riscv,
+    Uns32  index,
+    Uns32  regNum,
+    Uns32  EEWBytes
+) {
+    Uns32 vRegBytes = riscv->configInfo.VLEN/8;
+    Uns32 offset    = RD_CSR(riscv, vstart)*EEWBytes;
+    Uns32 i;
+
+    for(i=0; i<regNum; i++) {
+
+        Uns32 regStart = i*vRegBytes;
+        Uns32 from     = (offset>regStart) ? offset-regStart : 0;
+
+        if(from<vRegBytes) {
+            riscv->vZeroFrom[index+i] = from;
+            riscv->vZeroPending      |= 1<<(index+i);
+        }
+    }
+}
+
+//
+// Complete deferred tail zeroing of a register group up to the given extent in
+// bytes, scaled by vl if required (called from JIT code)
+//
+static void doVZeroPending(
+    riscvP riscv,
+    Uns32  index,
+    Uns32  regNum,
+    Uns32  bytes,
+    Bool   scaleVL
+) {
+    Uns32 vRegBytes = riscv->configInfo.VLEN/8;
+    Uns32 extent    = scaleVL ? RD_CSR(riscv, vl)*bytes : bytes;
+    Uns32 i;
+
+    for(i=0; (i<regNum) && (extent>(i*vRegBytes)); i++) {
+        riscvVZeroPending(riscv, index+i, extent-(i*vRegBytes));
+    }
+}
+
+//
+// Emit code to complete deferred tail zeroing of a register group up to the
+// given extent in bytes, scaled by vl if required
+//
+static void emitVZeroPendingGroup(
+    riscvMorphStateP state,
+    Uns32            index,
+    Uns32            regNum,
+    Uns32            bytes,
+    Bool             scaleVL
+) {
+    vmiLabelP skip = vmimtNewLabel();
+    Uns32     mask = ((1<<regNum)-1)<<index;
+
+    // skip completion unless some register in the group has a deferred tail
+    vmimtTestRCJumpLabel(32, vmi_COND_Z, RISCV_VZERO_PENDING, mask, skip);
+
+    vmimtArgProcessor();
+    vmimtArgUns32(index);
+    vmimtArgUns32(regNum);
+    vmimtArgUns32(bytes);
+    vmimtArgUns32(scaleVL);
+    vmimtCallAttrs((vmiCallFn)doVZeroPending, VMCA_NO_INVALIDATE);
+
+    vmimtInsertLabel(skip);
+}
+
+//
+// Emit code to complete deferred tail zeroing of vector registers before an
+// operation that could observe them. Element-indexed arguments only observe
+// elements below vl, so tails deferred beyond that point remain deferred.
+//
+static void emitVZeroPending(riscvMorphStateP state, iterDescP id) {
+
+    riscvP      riscv     = state->riscv;
+    riscvVShape vShape    = state->attrs->vShape;
+    Uns32       vRegBytes = riscv->configInfo.VLEN/8;
+    Bool        striped   = (id->VLEN>id->SLEN);
+    Uns32       i, j;
+
+    // mask register is observed as a whole
+    if(!VMI_ISNOREG(id->mask)) {
+        emitVZeroPendingGroup(state, 0, 1, vRegBytes, False);
+    }
+
+    for(i=0; i<RV_MAX_AREGS; i++) {
+
+        riscvRegDesc r        = getRVReg(state, i);
+        Uns32        index    = getRIndex(r);
+        Uns32        EMUL     = getEMUL(id, i);
+        Uns32        EEWBytes = getEEW(id, i)/8;
+
+        if(!isVReg(r)) {
+
+            // not a vector register
+
+        } else if(state->info.isWhole) {
+
+            // whole-register operations observe all registers
+            Uns32 regNum = state->info.nf+1;
+            Uns32 bytes  = regNum*vRegBytes;
+            emitVZeroPendingGroup(state, index, regNum, bytes, False);
+
+        } else if(isScalarN(vShape, i)) {
+
+            // scalar arguments observe element 0 only
+            emitVZeroPendingGroup(state, index, 1, EEWBytes, False);
+
+        } else if(isMaskN(vShape, i)) {
+
+            // mask arguments are observed as a whole
+            emitVZeroPendingGroup(state, index, 1, vRegBytes, False);
+
+        } else if(striped || isUnindexedN(vShape, i)) {
+
+            // arguments with arbitrary element order are observed as a whole
+            emitVZeroPendingGroup(state, index, EMUL, EMUL*vRegBytes, False);
+
+        } else {
+
+            // element-indexed arguments observe elements below vl
+            Uns32 nf = i ? 0 : id->nf;
+
+            for(j=0; j<=nf; j++) {
+                Uns32 segIndex = getSegmentRegisterIndex(id, r, j);
+                emitVZeroPendingGroup(state, segIndex, EMUL, EEWBytes, True);
+            }
+        }
+    }
+}
+
+//
+// Return mask of vector registers that could be written by an operation
+//
+static Uns32 getVdMask(riscvMorphStateP state, iterDescP id) {
+
+    riscvVShape  vShape = state->attrs->vShape;
+    riscvRegDesc r      = getRVReg(state, 0);
+    Uns32        index  = getRIndex(r);
+    Uns32        regNum = 0;
+    Uns32        result = 0;
+    Uns32        i;
+
+    if(!isVReg(r)) {
+        // no vector register target
+    } else if(state->info.isWhole) {
+        regNum = state->info.nf+1;
+    } else if(isScalarN(vShape, 0) || isMaskN(vShape, 0)) {
+        regNum = 1;
+    } else {
+        regNum = (getEMUL(id, 0) ? : 1) * (id->nf+1);
+    }
+
+    for(i=0; i<regNum; i++) {
+        result |= 1<<((index+i)%VREG_NUM);
+    }
+
+    return result;
+}
+
 //
 // Do actions at the start of a vector operation
 //
 static void startVectorOp(riscvMorphStateP state, iterDescP id, Bool iterVStart) {
 
+    riscvP riscv = state->riscv;
+
     // set vector state to dirty if required
-    updateVS(state->riscv);
+    updateVS(riscv);
+
+    // record vector registers that could be written for co-simulation
+    if(riscv->cosim) {
+
+        Uns32 vdMask = getVdMask(state, id);
+
+        if(vdMask) {
+            vmimtBinopRC(32, vmi_OR, RISCV_COSIM_VMASK, vdMask, 0);
+        }
+    }
+
+    // complete deferred tail zeroing that this operation could observe (tail
+    // zeroing is only deferred for versions that zero the tail)
+    if(requireZeroTail(riscv)) {
+        emitVZeroPending(state, id);
+    }
 
     // handle non-zero vstart
     id->skip = handleNonZeroVStart(state, id, iterVStart);
@@ -6359,6 +7123,23 @@ static void zeroVdPdTopPE(
     vmimtCompareRCJumpLabel(32, vmi_COND_NE, vstart, elemNum, loop);
 }
 
+//
+// Can zeroing of the top part of vector target registers be deferred? This
+// requires the zeroed part to extend contiguously from element vl to the end
+// of each register group
+//
+static Bool canDeferZeroVd(iterDescP id) {
+
+    Uns32 elemNum = id->VLEN/id->MLEN;
+    Uns32 VLENxN  = id->VLEN*getEMUL(id,0);
+
+    return (
+        (id->VLEN<=id->SLEN) &&
+        (getEEW(id,0)==id->SEW) &&
+        ((elemNum*id->SEW)>=VLENxN)
+    );
+}
+
 //
 // Fill top part of predicate and vector target registers with zero using
 // block-transfer algorithm
@@ -6389,7 +7170,28 @@ static void zeroVdPdTopBLT(
         vmimtZeroRV(VLEN, Pd, 32, t0, 0, id->MLEN/8, vmi_CC_NONE);
     }
 
-    if(zeroVd) {
+    if(zeroVd && canDeferZeroVd(id)) {
+
+        riscvRegDesc VdA = getRVReg(state, 0);
+        Uns32        i;
+
+        // iterate over all segment registers affected
+        for(i=0; i<=id->nf; i++) {
+
+            if(zeroVd & getTopZeroVdMask(i)) {
+
+                // defer zeroing of register top part until it is observed
+                vmimtArgProcessor();
+                vmimtArgUns32(getSegmentRegisterIndex(id, VdA, i));
+                vmimtArgUns32(getEMUL(id,0));
+                vmimtArgUns32(getEEW(id,0)/8);
+                vmimtCallAttrs(
+                    (vmiCallFn)doVZeroTailDeferred, VMCA_NO_INVALIDATE
+                );
+            }
+        }
+
+    } else if(zeroVd) {
 
         Uns32 VLENxN = VLEN*getEMUL(id,0);
         Uns32 i;
@@ -6619,6 +7421,102 @@ static riscvVLClassMt fillVectorOperationData(
     return vlClass;
 }
 
+//
+// Return whole-register kernel key for the current operation, or 0 if the
+// operation must be implemented element by element (including when the host
+// has no kernel for the operation and element size)
+//
+static Uns32 getVKernelKey(riscvMorphStateP state, iterDescP id) {
+
+    riscvP          riscv  = state->riscv;
+    riscvVKernelOp  op     = state->attrs->vKernel;
+    riscvVKernelKey key    = {u32:0};
+    Bool            isMAC  = (op==RVVK_WMACC) || (op==RVVK_QMACC);
+    Bool            isBF16 = (id->SEW==SEWMT_16) && enableBFLOAT16(riscv);
+    Bool            isVX   = isMAC && (state->info.VIType==RV_VIT_VX);
+    Uns32           i;
+
+    if(!op) {
+        return 0;
+    } else if(!isMAC && isBF16) {
+        return 0;
+    } else if((state->info.VIType!=RV_VIT_VV) && !isVX) {
+        return 0;
+    } else if(
+        !VMI_ISNOREG(id->mask) &&
+        vectorFractLMUL(riscv) &&
+        (id->VLEN>id->SLEN)
+    ) {
+        return 0;
+    }
+
+    // kernels index registers directly, so striped layouts are not supported
+    for(i=0; i<3; i++) {
+        if(isIndexedVRegisterStriped(id, i)) {
+            return 0;
+        }
+    }
+
+    key.f.op       = op;
+    key.f.SEWShift = mulToShiftP2(id->SEW/8);
+    key.f.vd       = getRIndex(getRVReg(state, 0));
+    key.f.vA       = isVX ? 0 : getRIndex(getRVReg(state, 1));
+    key.f.vB       = getRIndex(getRVReg(state, 2));
+    key.f.MLEN     = id->MLEN;
+    key.f.signA    = isVArgSigned(state, 1) && True;
+    key.f.signB    = isVArgSigned(state, 2) && True;
+    key.f.masked   = !VMI_ISNOREG(id->mask);
+    key.f.scalarA  = isVX;
+
+    return riscvVectorKernelSupported(key.u32) ? key.u32 : 0;
+}
+
+//
+// If the operation has a whole-register kernel, emit a call to it, returning a
+// label to which control is transferred if the kernel completes the operation
+//
+static vmiLabelP emitVectorKernel(riscvMorphStateP state, iterDescP id) {
+
+    Uns32     key  = getVKernelKey(state, id);
+    vmiLabelP done = 0;
+
+    if(key) {
+
+        riscvVKernelKey keyF   = {u32:key};
+        vmiReg          ok     = newTmp(state);
+        vmiReg          scalar = newTmp(state);
+
+        done = vmimtNewLabel();
+
+        // kernel sets floating point flags, so floating point state is dirty
+        riscvGetFPFlagsMT(state->riscv);
+
+        // extend any scalar first operand as for the per-element operation
+        if(keyF.f.scalarA) {
+            vmimtMoveExtendRR(64, scalar, id->SEW, id->r[1], keyF.f.signA);
+        } else {
+            vmimtMoveRC(64, scalar, 0);
+        }
+
+        // call kernel, skipping per-element operation if it succeeds
+        vmimtArgProcessor();
+        vmimtArgUns32(key);
+        vmimtArgReg(64, scalar);
+        vmimtCallResultAttrs(
+            (vmiCallFn)riscvVectorKernel,
+            8,
+            ok,
+            VMCA_NO_INVALIDATE|VMCA_FP_RESTORE
+        );
+        vmimtCondJumpLabel(ok, True, done);
+
+        freeTmp(state);
+        freeTmp(state);
+    }
+
+    return done;
+}
+
 //
 // Emit code to dispatch a vector operation
 //
@@ -6654,6 +7552,9 @@ static RISCV_MORPH_FN(emitVectorOp) {
             // start a new vector operation
             startVectorOp(state, &id, True);
 
+            // use a whole-register kernel if possible
+            vmiLabelP kernelDone = emitVectorKernel(state, &id);
+
             // loop to here
             vmimtInsertLabel(loop);
 
@@ -6678,6 +7579,11 @@ static RISCV_MORPH_FN(emitVectorOp) {
             // repeat until done
             endVectorLoop(state, &id, loop);
 
+            // here if whole-register kernel completed the operation
+            if(kernelDone) {
+                vmimtInsertLabel(kernelDone);
+            }
+
             // perform actions at end of instruction
             endVectorOp(state, &id, vlClass);
         }
@@ -8799,7 +9705,7 @@ static RISCV_MORPHV_FN(emitVRFClassFltCB) {
     Uns32 bitsS = id->SEW;
     Uns32 bitsD = (bitsS<=32) ? bitsS : 32;
 
-    emitFClassInt(state->riscv, id->r[0], id->r[1], bitsS, bitsD);
+    emitFClassInt(state, id->r[0], id->r[1], bitsS, bitsD);
     vmimtMoveExtendRR(bitsS, id->r[0], bitsD, id->r[0], False);
 }
 
@@ -9469,7 +10375,7 @@ const static riscvMorphAttr dispatchTable[] = {
     // miscellaneous system I-type instructions
     [RV_IT_EBREAK_I]         = {morph:emitEBREAK, iClass:OCL_IC_SYSTEM  },
     [RV_IT_ECALL_I]          = {morph:emitECALL,  iClass:OCL_IC_SYSTEM  },
-    [RV_IT_FENCEI_I]         = {morph:emitNOP,    iClass:OCL_IC_IBARRIER},
+    [RV_IT_FENCEI_I]         = {morph:emitFENCEI, iClass:OCL_IC_IBARRIER},
     [RV_IT_MRET_I]           = {morph:emitMRET,   iClass:OCL_IC_SYSTEM  },
     [RV_IT_SRET_I]           = {morph:emitSRET,   iClass:OCL_IC_SYSTEM  },
     [RV_IT_URET_I]           = {morph:emitURET,   iClass:OCL_IC_SYSTEM  },
@@ -9709,16 +10615,16 @@ const static riscvMorphAttr dispatchTable[] = {
     [RV_IT_VNMSUB_VR]        = {morph:emitVectorOp, opTCB:emitVRMAddIntCB,   binop:vmi_SUB,                                                 },
     [RV_IT_VMACC_VR]         = {morph:emitVectorOp, opTCB:emitVRMAccIntCB,   binop:vmi_ADD,                                                 },
     [RV_IT_VNMSAC_VR]        = {morph:emitVectorOp, opTCB:emitVRMAccIntCB,   binop:vmi_SUB,                                                 },
-    [RV_IT_VWMACCU_VR]       = {morph:emitVectorOp, opTCB:emitVRMAccIntCB,   binop:vmi_ADD,      vShape:RVVW_V2I_V1I_V1I,    argType:RVVX_UU},
-    [RV_IT_VWMACC_VR]        = {morph:emitVectorOp, opTCB:emitVRMAccIntCB,   binop:vmi_ADD,      vShape:RVVW_V2I_V1I_V1I,    argType:RVVX_SS},
-    [RV_IT_VWMACCSU_VR]      = {morph:emitVectorOp, opTCB:emitVRMAccIntCB,   binop:vmi_ADD,      vShape:RVVW_V2I_V1I_V1I,    argType:RVVX_SU},
-    [RV_IT_VWMACCUS_VR]      = {morph:emitVectorOp, opTCB:emitVRMAccIntCB,   binop:vmi_ADD,      vShape:RVVW_V2I_V1I_V1I,    argType:RVVX_US},
+    [RV_IT_VWMACCU_VR]       = {morph:emitVectorOp, opTCB:emitVRMAccIntCB,   binop:vmi_ADD,      vShape:RVVW_V2I_V1I_V1I,    vKernel:RVVK_WMACC, argType:RVVX_UU},
+    [RV_IT_VWMACC_VR]        = {morph:emitVectorOp, opTCB:emitVRMAccIntCB,   binop:vmi_ADD,      vShape:RVVW_V2I_V1I_V1I,    vKernel:RVVK_WMACC, argType:RVVX_SS},
+    [RV_IT_VWMACCSU_VR]      = {morph:emitVectorOp, opTCB:emitVRMAccIntCB,   binop:vmi_ADD,      vShape:RVVW_V2I_V1I_V1I,    vKernel:RVVK_WMACC, argType:RVVX_SU},
+    [RV_IT_VWMACCUS_VR]      = {morph:emitVectorOp, opTCB:emitVRMAccIntCB,   binop:vmi_ADD,      vShape:RVVW_V2I_V1I_V1I,    vKernel:RVVK_WMACC, argType:RVVX_US},
 
     // V-extension MVV/MVX-type common instructions (Zvqmac extension)
-    [RV_IT_VQMACCU_VR]       = {morph:emitVectorOp, opTCB:emitVRMAccIntCB, checkCB:emitQMACCheckCB, binop:vmi_ADD, vShape:RVVW_V4I_V1I_V1I, argType:RVVX_UU},
-    [RV_IT_VQMACC_VR]        = {morph:emitVectorOp, opTCB:emitVRMAccIntCB, checkCB:emitQMACCheckCB, binop:vmi_ADD, vShape:RVVW_V4I_V1I_V1I, argType:RVVX_SS},
-    [RV_IT_VQMACCSU_VR]      = {morph:emitVectorOp, opTCB:emitVRMAccIntCB, checkCB:emitQMACCheckCB, binop:vmi_ADD, vShape:RVVW_V4I_V1I_V1I, argType:RVVX_SU},
-    [RV_IT_VQMACCUS_VR]      = {morph:emitVectorOp, opTCB:emitVRMAccIntCB, checkCB:emitQMACCheckCB, binop:vmi_ADD, vShape:RVVW_V4I_V1I_V1I, argType:RVVX_US},
+    [RV_IT_VQMACCU_VR]       = {morph:emitVectorOp, opTCB:emitVRMAccIntCB, checkCB:emitQMACCheckCB, binop:vmi_ADD, vShape:RVVW_V4I_V1I_V1I, vKernel:RVVK_QMACC, argType:RVVX_UU},
+    [RV_IT_VQMACC_VR]        = {morph:emitVectorOp, opTCB:emitVRMAccIntCB, checkCB:emitQMACCheckCB, binop:vmi_ADD, vShape:RVVW_V4I_V1I_V1I, vKernel:RVVK_QMACC, argType:RVVX_SS},
+    [RV_IT_VQMACCSU_VR]      = {morph:emitVectorOp, opTCB:emitVRMAccIntCB, checkCB:emitQMACCheckCB, binop:vmi_ADD, vShape:RVVW_V4I_V1I_V1I, vKernel:RVVK_QMACC, argType:RVVX_SU},
+    [RV_IT_VQMACCUS_VR]      = {morph:emitVectorOp, opTCB:emitVRMAccIntCB, checkCB:emitQMACCheckCB, binop:vmi_ADD, vShape:RVVW_V4I_V1I_V1I, vKernel:RVVK_QMACC, argType:RVVX_US},
 
     // V-extension IVV-type instructions
     [RV_IT_VWREDSUMU_VS]     = {morph:emitVectorOp, opTCB:emitVRedBinaryIntCB, initCB:initVRedCB, endCB:endVRedCB, binop:vmi_ADD, vShape:RVVW_S2I_V1I_S2I, argType:RVVX_UU, vstart0:RVVS_ZERO},
@@ -9728,11 +10634,11 @@ const static riscvMorphAttr dispatchTable[] = {
 
     // V-extension FVV/FVF-type common instructions
     [RV_IT_VFMERGE_VR]       = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMERGETCB, opFCB:emitVRMERGEFCB,    vShape:RVVW_V1F_V1F_V1F},
-    [RV_IT_VFADD_VR]         = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FADD,   vShape:RVVW_V1F_V1F_V1F},
-    [RV_IT_VFSUB_VR]         = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FSUB,   vShape:RVVW_V1F_V1F_V1F},
+    [RV_IT_VFADD_VR]         = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FADD,   vShape:RVVW_V1F_V1F_V1F, vKernel:RVVK_FADD},
+    [RV_IT_VFSUB_VR]         = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FSUB,   vShape:RVVW_V1F_V1F_V1F, vKernel:RVVK_FSUB},
     [RV_IT_VFRSUB_VR]        = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRBinaryFltRCB, fpBinop: vmi_FSUB,   vShape:RVVW_V1F_V1F_V1F},
-    [RV_IT_VFMUL_VR]         = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FMUL,   vShape:RVVW_V1F_V1F_V1F},
-    [RV_IT_VFDIV_VR]         = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FDIV,   vShape:RVVW_V1F_V1F_V1F},
+    [RV_IT_VFMUL_VR]         = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FMUL,   vShape:RVVW_V1F_V1F_V1F, vKernel:RVVK_FMUL},
+    [RV_IT_VFDIV_VR]         = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FDIV,   vShape:RVVW_V1F_V1F_V1F, vKernel:RVVK_FDIV},
     [RV_IT_VFRDIV_VR]        = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRBinaryFltRCB, fpBinop: vmi_FDIV,   vShape:RVVW_V1F_V1F_V1F},
     [RV_IT_VFWADD_VR]        = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FADD,   vShape:RVVW_V2F_V1F_V1F},
     [RV_IT_VFWSUB_VR]        = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FSUB,   vShape:RVVW_V2F_V1F_V1F},
@@ -9743,10 +10649,10 @@ const static riscvMorphAttr dispatchTable[] = {
     [RV_IT_VFNMADD_VR]       = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAddFltCB,    fpTernop:vmi_FNMADD, vShape:RVVW_V1F_V1F_V1F},
     [RV_IT_VFMSUB_VR]        = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAddFltCB,    fpTernop:vmi_FMSUB,  vShape:RVVW_V1F_V1F_V1F},
     [RV_IT_VFNMSUB_VR]       = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAddFltCB,    fpTernop:vmi_FNMSUB, vShape:RVVW_V1F_V1F_V1F},
-    [RV_IT_VFMACC_VR]        = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAccFltCB,    fpTernop:vmi_FMADD,  vShape:RVVW_V1F_V1F_V1F},
-    [RV_IT_VFNMACC_VR]       = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAccFltCB,    fpTernop:vmi_FNMADD, vShape:RVVW_V1F_V1F_V1F},
-    [RV_IT_VFMSAC_VR]        = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAccFltCB,    fpTernop:vmi_FMSUB,  vShape:RVVW_V1F_V1F_V1F},
-    [RV_IT_VFNMSAC_VR]       = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAccFltCB,    fpTernop:vmi_FNMSUB, vShape:RVVW_V1F_V1F_V1F},
+    [RV_IT_VFMACC_VR]        = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAccFltCB,    fpTernop:vmi_FMADD,  vShape:RVVW_V1F_V1F_V1F, vKernel:RVVK_FMACC},
+    [RV_IT_VFNMACC_VR]       = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAccFltCB,    fpTernop:vmi_FNMADD, vShape:RVVW_V1F_V1F_V1F, vKernel:RVVK_FNMACC},
+    [RV_IT_VFMSAC_VR]        = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAccFltCB,    fpTernop:vmi_FMSUB,  vShape:RVVW_V1F_V1F_V1F, vKernel:RVVK_FMSAC},
+    [RV_IT_VFNMSAC_VR]       = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAccFltCB,    fpTernop:vmi_FNMSUB, vShape:RVVW_V1F_V1F_V1F, vKernel:RVVK_FNMSAC},
     [RV_IT_VFWMACC_VR]       = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAccFltCB,    fpTernop:vmi_FMADD,  vShape:RVVW_V2F_V1F_V1F},
     [RV_IT_VFWNMACC_VR]      = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAccFltCB,    fpTernop:vmi_FNMADD, vShape:RVVW_V2F_V1F_V1F},
     [RV_IT_VFWMSAC_VR]       = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRMAccFltCB,    fpTernop:vmi_FMSUB,  vShape:RVVW_V2F_V1F_V1F},
@@ -9754,16 +10660,16 @@ const static riscvMorphAttr dispatchTable[] = {
     [RV_IT_VFSQRT_V]         = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRUnaryFltCB,   fpUnop:  vmi_FSQRT,  vShape:RVVW_V1F_V1F_V1F},
     [RV_IT_VFRSQRTE7_V]      = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRUnaryFltCB,   fpUnop:  vmi_FRSQRT, vShape:RVVW_V1F_V1F_V1F},
     [RV_IT_VFRECE7_V]        = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRUnaryFltCB,   fpUnop:  vmi_FRECIP, vShape:RVVW_V1F_V1F_V1F},
-    [RV_IT_VFMIN_VR]         = {fpConfig:RVFP_FMIN,   morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FMIN,   vShape:RVVW_V1F_V1F_V1F},
-    [RV_IT_VFMAX_VR]         = {fpConfig:RVFP_FMAX,   morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FMAX,   vShape:RVVW_V1F_V1F_V1F},
+    [RV_IT_VFMIN_VR]         = {fpConfig:RVFP_FMIN,   morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FMIN,   vShape:RVVW_V1F_V1F_V1F, vKernel:RVVK_FMIN},
+    [RV_IT_VFMAX_VR]         = {fpConfig:RVFP_FMAX,   morph:emitVectorOp, opTCB:emitVRBinaryFltCB,  fpBinop: vmi_FMAX,   vShape:RVVW_V1F_V1F_V1F, vKernel:RVVK_FMAX},
     [RV_IT_VFSGNJ_VR]        = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRFSgnFltCB,    clearFS1:1,negFS2:0, vShape:RVVW_V1F_V1F_V1F},
     [RV_IT_VFSGNJN_VR]       = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRFSgnFltCB,    clearFS1:1,negFS2:1, vShape:RVVW_V1F_V1F_V1F},
     [RV_IT_VFSGNJX_VR]       = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRFSgnFltCB,    clearFS1:0,negFS2:0, vShape:RVVW_V1F_V1F_V1F},
     [RV_IT_VFORD_VR]         = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRFCmpFltCB,    fpRel:RVFCMP_ORD,    vShape:RVVW_P1I_V1F_V1F},
-    [RV_IT_VFEQ_VR]          = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRFCmpFltCB,    fpRel:RVFCMP_EQ,     vShape:RVVW_P1I_V1F_V1F},
+    [RV_IT_VFEQ_VR]          = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRFCmpFltCB,    fpRel:RVFCMP_EQ,     vShape:RVVW_P1I_V1F_V1F, vKernel:RVVK_FEQ},
     [RV_IT_VFNE_VR]          = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRFCmpFltCB,    fpRel:RVFCMP_NE,     vShape:RVVW_P1I_V1F_V1F},
     [RV_IT_VFLE_VR]          = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRFCmpFltCB,    fpRel:RVFCMP_LE,     vShape:RVVW_P1I_V1F_V1F},
-    [RV_IT_VFLT_VR]          = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRFCmpFltCB,    fpRel:RVFCMP_LT,     vShape:RVVW_P1I_V1F_V1F},
+    [RV_IT_VFLT_VR]          = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRFCmpFltCB,    fpRel:RVFCMP_LT,     vShape:RVVW_P1I_V1F_V1F, vKernel:RVVK_FLT},
     [RV_IT_VFGE_VR]          = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRFCmpFltCB,    fpRel:RVFCMP_GE,     vShape:RVVW_P1I_V1F_V1F},
     [RV_IT_VFGT_VR]          = {fpConfig:RVFP_NORMAL, morph:emitVectorOp, opTCB:emitVRFCmpFltCB,    fpRel:RVFCMP_GT,     vShape:RVVW_P1I_V1F_V1F},
 
@@ -9888,6 +10794,17 @@ VMI_START_END_BLOCK_FN(riscvStartBlock) {
     thisState->FSDirty = False;
     thisState->VSDirty = False;
 
+    // no instruction cache line has been fetched initially
+    thisState->fetchLineMt = -1;
+
+    // mstatus.MPRV key is not validated initially
+    thisState->MPRVKeyMt = False;
+
+    // registers written by the previous instruction are not known initially
+    thisState->cosimXMaskMt = 0;
+    thisState->cosimFMaskMt = 0;
+    thisState->cosimMaskMt  = False;
+
     // current vector configuration is not known initially
     thisState->SEWMt                  = SEWMT_UNKNOWN;
     thisState->VLMULx8Mt              = VLMULx8MT_UNKNOWN;
@@ -9902,6 +10819,14 @@ VMI_START_END_BLOCK_FN(riscvStartBlock) {
         thisState->VLMULx8Mt = prevState->VLMULx8Mt;
         thisState->VLClassMt = prevState->VLClassMt;
     }
+
+    // no opcode mix record exists initially
+    thisState->mixBlockMt = 0;
+
+    // start block translation statistics if required
+    if(riscv->morphStats) {
+        riscvMorphStatsStartBlock(riscv, thisState);
+    }
 }
 
 //
@@ -9918,29 +10843,125 @@ VMI_START_END_BLOCK_FN(riscvEndBlock) {
         "unexpected mismatched blockState at end of block"
     );
 
+    // complete block translation statistics if required
+    if(riscv->morphStats) {
+        riscvMorphStatsEndBlock(riscv, thisState);
+    }
+
     // restore previously-active block state
     riscv->blockState = thisState->prevState;
 }
 
+//
+// Return the emitter family of the instruction being translated (for
+// translation statistics)
+//
+static riscvMorphFamily getMorphFamily(riscvMorphStateP state) {
+
+    riscvIType type = state->info.type;
+
+    if(state->attrs->morph==emitVectorOp) {
+        return RVMF_VECTOR_OP;
+    } else if(state->info.arch & ISA_V) {
+        return RVMF_VECTOR;
+    } else if((type==RV_IT_CSRR_I) || (type==RV_IT_CSRRI_I)) {
+        return RVMF_CSR;
+    } else if(state->info.arch & ISA_DF) {
+        return RVMF_FP;
+    } else {
+        return RVMF_OTHER;
+    }
+}
+
+//
+// Return the class of the instruction being translated (for opcode mix)
+//
+static riscvMixClass getMixClass(riscvMorphStateP state) {
+
+    riscvIType            type   = state->info.type;
+    riscvArchitecture     arch   = state->info.arch;
+    octiaInstructionClass system = (
+        OCL_IC_SYSTEM | OCL_IC_SYSREG | OCL_IC_MMU |
+        OCL_IC_IBARRIER | OCL_IC_DBARRIER
+    );
+
+    if(arch & ISA_V) {
+        return RVOC_VECTOR;
+    } else if(arch & ISA_A) {
+        return RVOC_ATOMIC;
+    } else if(state->info.memBits) {
+        return RVOC_LOAD_STORE;
+    } else if(arch & ISA_DF) {
+        return RVOC_FP;
+    } else if((type==RV_IT_CSRR_I) || (type==RV_IT_CSRRI_I)) {
+        return RVOC_SYSTEM;
+    } else if(state->attrs->iClass & system) {
+        return RVOC_SYSTEM;
+    } else if(arch & ISA_M) {
+        return RVOC_MUL_DIV;
+    } else if(arch & ISA_B) {
+        return RVOC_BITMANIP;
+    } else {
+        return RVOC_INTEGER;
+    }
+}
+
+//
+// Record the instruction in the dynamic opcode mix if required, emitting a
+// call to count executions of the block at its first instruction
+//
+static void emitOpcodeMix(riscvMorphStateP state) {
+
+    riscvP riscv = state->riscv;
+
+    if(riscv->opcodeMix) {
+
+        riscvMixBlockP block = riscvOpcodeMixInstruction(
+            riscv, &state->info, getMixClass(state)
+        );
+
+        if(block) {
+            vmimtArgProcessor();
+            vmimtArgNatAddress(block);
+            vmimtCallAttrs(
+                (vmiCallFn)riscvOpcodeMixEnterBlock, VMCA_NO_INVALIDATE
+            );
+        }
+    }
+}
+
 //
 // Instruction Morpher
 //
 VMI_MORPH_FN(riscvMorph) {
 
-    riscvP          riscv = (riscvP)processor;
+    riscvP          riscv     = (riscvP)processor;
+    Uns64           startNs   = 0;
+    Uns64           decodedNs = 0;
     riscvMorphState state;
 
+    // start translation timing if required
+    if(riscv->morphStats) {
+        startNs = riscvMorphStatsTime();
+    }
+
     // get instruction and instruction type
     riscvDecode(riscv, thisPC, &state.info);
 
+    // record decode completion time if required
+    if(riscv->morphStats) {
+        decodedNs = riscvMorphStatsTime();
+    }
+
     // fill JIT translation state
     state.attrs       = &dispatchTable[state.info.type];
     state.riscv       = riscv;
     state.inDelaySlot = inDelaySlot;
     state.tmpIndex    = 0;
 
-    // clear mask of X registers targeted by this instruction
+    // clear masks of X and F registers targeted by this instruction
     riscv->writtenXMask = 0;
+    riscv->writtenFMask = 0;
 
     // handle fixed point vector instructions that have an implicit dependency
     // on mstatus.FS
@@ -9954,6 +10975,17 @@ VMI_MORPH_FN(riscvMorph) {
         state.info.arch |= ISA_FS;
     }
 
+    // count block executions for the opcode mix, publish co-simulation record
+    // for the previous instruction, fire any matching execute triggers and
+    // record instruction fetch for the cache model if required
+    if(!disableMorph(&state)) {
+        emitOpcodeMix(&state);
+        emitCosimRetire(&state);
+        emitTriggerCheck(&state);
+        emitDebugStepCheck(&state);
+        emitCacheFetch(&state);
+    }
+
     if(disableMorph(&state)) {
 
         // no action if in disassembly mode
@@ -9993,6 +11025,12 @@ VMI_MORPH_FN(riscvMorph) {
             }
         }
 
+        // save X and F registers written by this instruction for
+        // co-simulation
+        riscv->blockState->cosimXMaskMt = riscv->writtenXMask;
+        riscv->blockState->cosimFMaskMt = riscv->writtenFMask;
+        riscv->blockState->cosimMaskMt  = True;
+
     } else {
 
         // here if no morph callback specified
@@ -10001,6 +11039,17 @@ VMI_MORPH_FN(riscvMorph) {
             SRCREF_ARGS(riscv, thisPC)
         );
     }
+
+    // record translation statistics if required
+    if(riscv->morphStats && !disableMorph(&state)) {
+        riscvMorphStatsInstruction(
+            riscv,
+            &state.info,
+            getMorphFamily(&state),
+            decodedNs-startNs,
+            riscvMorphStatsTime()-decodedNs
+        );
+    }
 }
 
 //
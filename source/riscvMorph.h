@@ -139,6 +139,17 @@ void riscvWriteReg(riscvP riscv, riscvRegDesc r, Bool signExtend);
 memEndian riscvGetCurrentDataEndianMT(riscvP riscv);
 
 
+////////////////////////////////////////////////////////////////////////////////
+// FUNCTION PROFILING
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Emit code to record a function return to the given target address if
+// function profiling is active
+//
+void riscvEmitProfileReturn(riscvP riscv, vmiReg tgt);
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // FPU
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,509 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// standard header files
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Imperas header files
+#include "hostapi/impAlloc.h"
+
+// VMI header files
+#include "vmi/vmiMessage.h"
+#include "vmi/vmiRt.h"
+
+// model header files
+#include "riscvBlockState.h"
+#include "riscvMorphStats.h"
+#include "riscvParameters.h"
+#include "riscvStructure.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Number of block size histogram buckets (1, 2-3, 4-7, ... instructions)
+//
+#define MORPH_SIZE_BUCKETS  10
+
+//
+// Number of instruction types and blocks shown in the report
+//
+#define MORPH_REPORT_TYPES  32
+#define MORPH_REPORT_BLOCKS 32
+
+DEFINE_S(morphTypeStats);
+DEFINE_S(morphBlockStats);
+
+//
+// Translation statistics for one instruction type or emitter family
+//
+typedef struct morphTypeStatsS {
+    const char *opcode;         // example opcode name
+    Uns64       morphed;        // number of instructions morphed
+    Uns64       decodeNs;       // host time decoding
+    Uns64       morphNs;        // host time morphing
+} morphTypeStats;
+
+//
+// Translation statistics for one block, identified by its start address
+//
+typedef struct morphBlockStatsS {
+    morphBlockStatsP  next;             // next block in creation order
+    Uns64             PC;               // block start address
+    Uns32             translations;     // number of translations
+    Uns32             modeChanges;      // retranslations in a new mode
+    Uns32             maskChanges;      // retranslations with new blockMask
+    Uns32             keyChanges;       // retranslations with new pmKey
+    Uns32             otherChanges;     // retranslations with same key/mask
+    riscvDMode        mode;             // mode at last translation
+    riscvArchitecture arch;             // blockMask at last translation
+    Uns16             pmKey;            // pmKey at last translation
+} morphBlockStats;
+
+//
+// Translation statistics for one hart
+//
+typedef struct riscvMorphStatsS {
+
+    // instruction statistics
+    morphTypeStats   types[RV_IT_LAST+1];
+    morphTypeStats   families[RVMF_LAST];
+
+    // block statistics
+    Uns64            blocks;            // number of blocks translated
+    Uns64            blockInstrs;       // instructions in translated blocks
+    Uns64            blockNs;           // host time translating blocks
+    Uns64            sizes[MORPH_SIZE_BUCKETS];
+
+    // retranslation statistics
+    vmiRangeTableP   blockTable;        // blocks indexed by address
+    morphBlockStatsP blockFirst;        // first block in creation order
+    morphBlockStatsP blockLast;         // last block in creation order
+    Uns64            retranslations;    // total retranslations
+
+} riscvMorphStats;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// STATISTICS COLLECTION
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return host time in nanoseconds for translation timing
+//
+Uns64 riscvMorphStatsTime(void) {
+
+#if defined(_WIN32)
+
+    // only coarse process time is available without platform headers
+    return (Uns64)clock() * (1000000000ULL/CLOCKS_PER_SEC);
+
+#else
+
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (Uns64)ts.tv_sec*1000000000ULL + ts.tv_nsec;
+
+#endif
+}
+
+//
+// Return statistics for the block starting at the given address
+//
+static morphBlockStatsP getBlockStats(riscvMorphStatsP stats, Uns64 PC) {
+
+    vmiRangeTablePP  tableP = &stats->blockTable;
+    vmiRangeEntryP   entry  = vmirtGetFirstRangeEntry(tableP, PC, PC);
+    morphBlockStatsP block;
+
+    if(entry) {
+
+        block = (morphBlockStatsP)(UnsPS)vmirtGetRangeEntryUserData(entry);
+
+    } else {
+
+        block = STYPE_CALLOC(morphBlockStats);
+
+        block->PC = PC;
+
+        // append to list in creation order
+        if(stats->blockLast) {
+            stats->blockLast->next = block;
+        } else {
+            stats->blockFirst = block;
+        }
+
+        stats->blockLast = block;
+
+        vmirtInsertRangeEntry(tableP, PC, PC, (UnsPS)block);
+    }
+
+    return block;
+}
+
+//
+// Record translation of the block starting at the given address, classifying
+// any retranslation by what has changed since the previous translation
+//
+static void recordBlockTranslation(
+    riscvP           riscv,
+    riscvMorphStatsP stats,
+    Uns64            PC
+) {
+    morphBlockStatsP block = getBlockStats(stats, PC);
+
+    if(!block->translations) {
+        // first translation
+    } else if(block->mode!=riscv->mode) {
+        block->modeChanges++;
+    } else if(block->arch!=riscv->currentArch) {
+        block->maskChanges++;
+    } else if(block->pmKey!=riscv->pmKey) {
+        block->keyChanges++;
+    } else {
+        block->otherChanges++;
+    }
+
+    if(block->translations++) {
+        stats->retranslations++;
+    }
+
+    block->mode  = riscv->mode;
+    block->arch  = riscv->currentArch;
+    block->pmKey = riscv->pmKey;
+}
+
+//
+// Record the start of translation of a code block
+//
+void riscvMorphStatsStartBlock(riscvP riscv, riscvBlockStateP blockState) {
+
+    blockState->morphInstrs  = 0;
+    blockState->morphStartNs = riscvMorphStatsTime();
+}
+
+//
+// Record the end of translation of a code block
+//
+void riscvMorphStatsEndBlock(riscvP riscv, riscvBlockStateP blockState) {
+
+    riscvMorphStatsP stats  = riscv->morphStats;
+    Uns32            instrs = blockState->morphInstrs;
+    Uns32            bucket = 0;
+
+    if(instrs) {
+
+        stats->blocks++;
+        stats->blockInstrs += instrs;
+        stats->blockNs     += riscvMorphStatsTime() - blockState->morphStartNs;
+
+        // histogram bucket is floor(log2(instrs)), saturating
+        while((instrs>>=1) && (bucket<(MORPH_SIZE_BUCKETS-1))) {
+            bucket++;
+        }
+
+        stats->sizes[bucket]++;
+    }
+}
+
+//
+// Record translation of one instruction, with host times spent decoding and
+// morphing it
+//
+void riscvMorphStatsInstruction(
+    riscvP           riscv,
+    riscvInstrInfoP  info,
+    riscvMorphFamily family,
+    Uns64            decodeNs,
+    Uns64            morphNs
+) {
+    riscvMorphStatsP stats      = riscv->morphStats;
+    riscvBlockStateP blockState = riscv->blockState;
+    morphTypeStatsP  type       = &stats->types[info->type];
+    morphTypeStatsP  fam        = &stats->families[family];
+
+    // record block translation at its first instruction
+    if(blockState && !blockState->morphInstrs++) {
+        recordBlockTranslation(riscv, stats, info->thisPC);
+    }
+
+    if(!type->opcode) {
+        type->opcode = info->opcode;
+    }
+
+    type->morphed++;
+    type->decodeNs += decodeNs;
+    type->morphNs  += morphNs;
+
+    fam->morphed++;
+    fam->decodeNs += decodeNs;
+    fam->morphNs  += morphNs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// REPORTING
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Compare instruction types by total translation time (descending)
+//
+static int compareTypeStats(const void *a, const void *b) {
+
+    morphTypeStatsP statsA = *(morphTypeStatsP*)a;
+    morphTypeStatsP statsB = *(morphTypeStatsP*)b;
+    Uns64           timeA  = statsA->decodeNs + statsA->morphNs;
+    Uns64           timeB  = statsB->decodeNs + statsB->morphNs;
+
+    return (timeA<timeB) - (timeA>timeB);
+}
+
+//
+// Compare blocks by translation count (descending)
+//
+static int compareBlockStats(const void *a, const void *b) {
+
+    morphBlockStatsP statsA = *(morphBlockStatsP*)a;
+    morphBlockStatsP statsB = *(morphBlockStatsP*)b;
+
+    return (statsA->translations<statsB->translations) -
+           (statsA->translations>statsB->translations);
+}
+
+//
+// Print one instruction type or emitter family line of the report
+//
+static void printTypeStats(const char *name, morphTypeStatsP stats) {
+
+    char  morphedStr[32];
+    Uns64 totalNs = stats->decodeNs + stats->morphNs;
+
+    snprintf(morphedStr, sizeof(morphedStr), FMT_64u, stats->morphed);
+
+    vmiPrintf(
+        "  %-16s %12s  %12.3f  %12.3f  %10.1f\n",
+        name,
+        morphedStr,
+        stats->decodeNs/1e6,
+        stats->morphNs/1e6,
+        stats->morphed ? (double)totalNs/stats->morphed : 0.0
+    );
+}
+
+//
+// Print translation statistics, including the most expensive instruction types
+// and the most frequently retranslated blocks
+//
+static void printMorphStats(riscvP riscv) {
+
+    static const char *familyNames[RVMF_LAST] = {
+        [RVMF_OTHER]     = "other",
+        [RVMF_FP]        = "floating point",
+        [RVMF_CSR]       = "CSR",
+        [RVMF_VECTOR_OP] = "vector (VOp)",
+        [RVMF_VECTOR]    = "vector (other)",
+    };
+
+    riscvMorphStatsP stats    = riscv->morphStats;
+    Uns32            numTypes = 0;
+    Uns32            numBlock = 0;
+    morphBlockStatsP block;
+    char             countStr[32];
+    Uns32            i;
+
+    vmiPrintf(
+        "Translation statistics for %s:\n",
+        vmirtProcessorName((vmiProcessorP)riscv)
+    );
+
+    // block summary
+    snprintf(countStr, sizeof(countStr), FMT_64u, stats->blocks);
+    vmiPrintf(
+        "  blocks translated %s, mean %.1f instructions, %.1f ns/block\n",
+        countStr,
+        stats->blocks ? (double)stats->blockInstrs/stats->blocks : 0.0,
+        stats->blocks ? (double)stats->blockNs/stats->blocks : 0.0
+    );
+
+    // block size distribution
+    vmiPrintf("  block size            blocks\n");
+
+    for(i=0; i<MORPH_SIZE_BUCKETS; i++) {
+
+        char sizeStr[32];
+
+        if(i==MORPH_SIZE_BUCKETS-1) {
+            snprintf(sizeStr, sizeof(sizeStr), "%u+", 1<<i);
+        } else if(i) {
+            snprintf(sizeStr, sizeof(sizeStr), "%u-%u", 1<<i, (2<<i)-1);
+        } else {
+            snprintf(sizeStr, sizeof(sizeStr), "1");
+        }
+
+        snprintf(countStr, sizeof(countStr), FMT_64u, stats->sizes[i]);
+        vmiPrintf("  %-16s %12s\n", sizeStr, countStr);
+    }
+
+    // emitter family summary
+    vmiPrintf(
+        "  family                morphed  decode ms     morph ms  ns/instr\n"
+    );
+
+    for(i=0; i<RVMF_LAST; i++) {
+        printTypeStats(familyNames[i], &stats->families[i]);
+    }
+
+    // instruction types sorted by total translation time
+    morphTypeStatsP sortedTypes[RV_IT_LAST+1];
+
+    for(i=0; i<=RV_IT_LAST; i++) {
+        if(stats->types[i].morphed) {
+            sortedTypes[numTypes++] = &stats->types[i];
+        }
+    }
+
+    qsort(sortedTypes, numTypes, sizeof(sortedTypes[0]), compareTypeStats);
+
+    vmiPrintf(
+        "  opcode                morphed  decode ms     morph ms  ns/instr\n"
+    );
+
+    for(i=0; (i<numTypes) && (i<MORPH_REPORT_TYPES); i++) {
+
+        morphTypeStatsP type = sortedTypes[i];
+
+        printTypeStats(type->opcode ? : "(undecoded)", type);
+    }
+
+    // retranslated blocks sorted by translation count
+    for(block=stats->blockFirst; block; block=block->next) {
+        numBlock++;
+    }
+
+    morphBlockStatsP sortedBlocks[numBlock ? : 1];
+
+    for(block=stats->blockFirst, i=0; block; block=block->next, i++) {
+        sortedBlocks[i] = block;
+    }
+
+    qsort(sortedBlocks, numBlock, sizeof(sortedBlocks[0]), compareBlockStats);
+
+    snprintf(countStr, sizeof(countStr), FMT_64u, stats->retranslations);
+    vmiPrintf(
+        "  retranslations %s\n"
+        "  PC                 translations      mode      mask       key     other\n",
+        countStr
+    );
+
+    for(
+        i=0;
+        (i<numBlock) && (i<MORPH_REPORT_BLOCKS) &&
+        (sortedBlocks[i]->translations>1);
+        i++
+    ) {
+        char PC[32];
+
+        block = sortedBlocks[i];
+
+        snprintf(PC, sizeof(PC), "0x"FMT_Ax, block->PC);
+
+        vmiPrintf(
+            "  %-18s %12u  %8u  %8u  %8u  %8u\n",
+            PC,
+            block->translations,
+            block->modeChanges,
+            block->maskChanges,
+            block->keyChanges,
+            block->otherChanges
+        );
+    }
+}
+
+//
+// Print translation statistics command
+//
+static VMIRT_COMMAND_PARSE_FN(morphReportCommand) {
+
+    printMorphStats((riscvP)processor);
+
+    return "1";
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION AND DESTRUCTION
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Allocate translation statistics structures if required
+//
+void riscvNewMorphStats(riscvP riscv, riscvParamValuesP params) {
+
+    if(params->morph_stats) {
+
+        riscvMorphStatsP stats = STYPE_CALLOC(riscvMorphStats);
+
+        riscv->morphStats = stats;
+
+        vmirtNewRangeTable(&stats->blockTable);
+
+        // install translation report command
+        vmirtAddCommandParse(
+            (vmiProcessorP)riscv,
+            "morphReport",
+            "show translation statistics",
+            morphReportCommand,
+            VMI_CT_QUERY|VMI_CO_DIAG|VMI_CA_REPORT
+        );
+    }
+}
+
+//
+// Report translation statistics and free translation statistics structures
+//
+void riscvFreeMorphStats(riscvP riscv) {
+
+    riscvMorphStatsP stats = riscv->morphStats;
+
+    if(stats) {
+
+        morphBlockStatsP block;
+        morphBlockStatsP next;
+
+        printMorphStats(riscv);
+
+        for(block=stats->blockFirst; block; block=next) {
+            next = block->next;
+            STYPE_FREE(block);
+        }
+
+        vmirtFreeRangeTable(&stats->blockTable);
+
+        STYPE_FREE(stats);
+
+        riscv->morphStats = 0;
+    }
+}
+
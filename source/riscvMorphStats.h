@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+// basic types
+#include "hostapi/impTypes.h"
+
+// model header files
+#include "riscvDecodeTypes.h"
+#include "riscvTypeRefs.h"
+
+
+//
+// Emitter families used to group translation statistics
+//
+typedef enum riscvMorphFamilyE {
+    RVMF_OTHER,                         // all other instructions
+    RVMF_FP,                            // scalar floating point
+    RVMF_CSR,                           // CSR access
+    RVMF_VECTOR_OP,                     // vector (emitVectorOp)
+    RVMF_VECTOR,                        // vector (other emitters)
+    RVMF_LAST                           // KEEP LAST: for sizing
+} riscvMorphFamily;
+
+//
+// Allocate translation statistics structures if required
+//
+void riscvNewMorphStats(riscvP riscv, riscvParamValuesP params);
+
+//
+// Report translation statistics and free translation statistics structures
+//
+void riscvFreeMorphStats(riscvP riscv);
+
+//
+// Return host time in nanoseconds for translation timing
+//
+Uns64 riscvMorphStatsTime(void);
+
+//
+// Record the start of translation of a code block
+//
+void riscvMorphStatsStartBlock(riscvP riscv, riscvBlockStateP blockState);
+
+//
+// Record the end of translation of a code block
+//
+void riscvMorphStatsEndBlock(riscvP riscv, riscvBlockStateP blockState);
+
+//
+// Record translation of one instruction, with host times spent decoding and
+// morphing it
+//
+void riscvMorphStatsInstruction(
+    riscvP           riscv,
+    riscvInstrInfoP  info,
+    riscvMorphFamily family,
+    Uns64            decodeNs,
+    Uns64            morphNs
+);
+
@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// standard header files
+#include <stdio.h>
+#include <stdlib.h>
+
+// Imperas header files
+#include "hostapi/impAlloc.h"
+
+// VMI header files
+#include "vmi/vmiMessage.h"
+#include "vmi/vmiRt.h"
+
+// model header files
+#include "riscvBlockState.h"
+#include "riscvOpcodeMix.h"
+#include "riscvParameters.h"
+#include "riscvStructure.h"
+#include "riscvUtils.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Initial number of instructions allocated in a block record
+//
+#define MIX_BLOCK_INSTRS 8
+
+DEFINE_S(mixEntry);
+DEFINE_S(mixTotals);
+
+//
+// Number of instructions of one type in a block
+//
+typedef struct mixEntryS {
+    riscvIType type;                    // instruction type
+    Uns32      count;                   // instructions of type in block
+} mixEntry;
+
+//
+// Opcode mix record for one translated block. Counts are updated once per
+// block execution; instructions in a partially-executed block are corrected
+// when the next block is entered.
+//
+typedef struct riscvMixBlockS {
+    riscvMixBlockP next;                // next block in creation order
+    Uns64          executions;          // number of times block entered
+    riscvMode      mode;                // mode in which block was translated
+    Uns32          xlenIndex;           // XLEN of block (0:32, 1:64)
+    Uns32          numInstrs;           // instructions in block
+    Uns32          numEntries;          // distinct instruction types in block
+    Uns32          maxInstrs;           // allocated size of arrays
+    riscvIType    *types;               // instruction types in block order
+    mixEntryP      entries;             // instruction counts by type
+} riscvMixBlock;
+
+//
+// Opcode mix state for one hart
+//
+typedef struct riscvOpcodeMixS {
+
+    // instruction type descriptions
+    const char    *opcodes[RV_IT_LAST+1];   // example opcode name
+    riscvMixClass  classes[RV_IT_LAST+1];   // instruction class
+
+    // block records
+    riscvMixBlockP blockFirst;              // first block in creation order
+    riscvMixBlockP blockLast;               // last block in creation order
+    riscvMixBlockP current;                 // most-recently entered block
+    Uns64          currentICount;           // icount when current was entered
+
+    // corrections for partially-executed blocks
+    Int64          adjustTypes[RV_IT_LAST+1];
+    Int64          adjustModes[RISCV_MODE_LAST];
+    Int64          adjustXLEN[2];
+
+} riscvOpcodeMix;
+
+//
+// Executed instruction totals derived from block records
+//
+typedef struct mixTotalsS {
+    Uns64 total;                        // all executed instructions
+    Uns64 types[RV_IT_LAST+1];          // by instruction type
+    Uns64 classes[RVOC_LAST];           // by instruction class
+    Uns64 modes[RISCV_MODE_LAST];       // by mode
+    Uns64 XLEN[2];                      // by XLEN
+} mixTotals;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// STATISTICS COLLECTION
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Allocate a record for the block being translated
+//
+static riscvMixBlockP newMixBlock(riscvP riscv, riscvOpcodeMixP mix) {
+
+    riscvMixBlockP block = STYPE_CALLOC(riscvMixBlock);
+
+    block->mode      = getCurrentMode(riscv);
+    block->xlenIndex = (riscvGetXlenMode(riscv)==64);
+    block->maxInstrs = MIX_BLOCK_INSTRS;
+    block->types     = STYPE_CALLOC_N(riscvIType, MIX_BLOCK_INSTRS);
+    block->entries   = STYPE_CALLOC_N(mixEntry, MIX_BLOCK_INSTRS);
+
+    // append to list in creation order
+    if(mix->blockLast) {
+        mix->blockLast->next = block;
+    } else {
+        mix->blockFirst = block;
+    }
+
+    mix->blockLast = block;
+
+    return block;
+}
+
+//
+// Append an instruction of the given type to a block record
+//
+static void addMixInstruction(riscvMixBlockP block, riscvIType type) {
+
+    Uns32 i;
+
+    // grow arrays if required
+    if(block->numInstrs==block->maxInstrs) {
+
+        Uns32 maxInstrs = block->maxInstrs*2;
+
+        block->types     = STYPE_REALLOC(block->types, riscvIType, maxInstrs);
+        block->entries   = STYPE_REALLOC(block->entries, mixEntry, maxInstrs);
+        block->maxInstrs = maxInstrs;
+    }
+
+    block->types[block->numInstrs++] = type;
+
+    // blocks are short, so a linear search for an existing entry is adequate
+    for(i=0; i<block->numEntries; i++) {
+        if(block->entries[i].type==type) {
+            block->entries[i].count++;
+            return;
+        }
+    }
+
+    block->entries[i].type  = type;
+    block->entries[i].count = 1;
+    block->numEntries++;
+}
+
+//
+// Record translation of one instruction in the current block, returning the
+// block record if this is the first instruction of the block (in which case a
+// call to riscvOpcodeMixEnterBlock must be emitted)
+//
+riscvMixBlockP riscvOpcodeMixInstruction(
+    riscvP          riscv,
+    riscvInstrInfoP info,
+    riscvMixClass   mixClass
+) {
+    riscvOpcodeMixP  mix        = riscv->opcodeMix;
+    riscvBlockStateP blockState = riscv->blockState;
+    riscvIType       type       = info->type;
+    riscvMixBlockP   result     = 0;
+
+    if(blockState) {
+
+        riscvMixBlockP block = blockState->mixBlockMt;
+
+        // create block record at its first instruction
+        if(!block) {
+            block = result = blockState->mixBlockMt = newMixBlock(riscv, mix);
+        }
+
+        addMixInstruction(block, type);
+
+        if(!mix->opcodes[type]) {
+            mix->opcodes[type] = info->opcode;
+            mix->classes[type] = mixClass;
+        }
+    }
+
+    return result;
+}
+
+//
+// Return the number of instructions in the current block that have not been
+// executed since it was entered
+//
+static Uns32 getUnexecuted(riscvP riscv, riscvOpcodeMixP mix) {
+
+    riscvMixBlockP block    = mix->current;
+    Uns64          executed = vmirtGetICount((vmiProcessorP)riscv);
+
+    executed -= mix->currentICount;
+
+    return (executed<block->numInstrs) ? block->numInstrs-executed : 0;
+}
+
+//
+// Record entry to the given block (called from JIT code)
+//
+void riscvOpcodeMixEnterBlock(riscvP riscv, riscvMixBlockP block) {
+
+    riscvOpcodeMixP mix     = riscv->opcodeMix;
+    riscvMixBlockP  current = mix->current;
+
+    // correct counts for any instructions in the previous block that were not
+    // executed (for example, because of an exception)
+    if(current) {
+
+        Uns32 unexecuted = getUnexecuted(riscv, mix);
+        Uns32 i;
+
+        for(i=current->numInstrs-unexecuted; i<current->numInstrs; i++) {
+            mix->adjustTypes[current->types[i]]--;
+        }
+
+        mix->adjustModes[current->mode]     -= unexecuted;
+        mix->adjustXLEN[current->xlenIndex] -= unexecuted;
+    }
+
+    block->executions++;
+
+    mix->current       = block;
+    mix->currentICount = vmirtGetICount((vmiProcessorP)riscv);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// REPORTING
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Calculate executed instruction totals from block records
+//
+static void getMixTotals(riscvP riscv, mixTotalsP totals) {
+
+    riscvOpcodeMixP mix     = riscv->opcodeMix;
+    riscvMixBlockP  current = mix->current;
+    riscvMixBlockP  block;
+    Uns32           i;
+
+    // corrections for partially-executed blocks
+    for(i=0; i<=RV_IT_LAST; i++) {
+        totals->types[i] = mix->adjustTypes[i];
+    }
+    for(i=0; i<RISCV_MODE_LAST; i++) {
+        totals->modes[i] = mix->adjustModes[i];
+    }
+    for(i=0; i<2; i++) {
+        totals->XLEN[i] = mix->adjustXLEN[i];
+    }
+
+    // counts for each block execution
+    for(block=mix->blockFirst; block; block=block->next) {
+
+        Uns64 instrs = block->executions * block->numInstrs;
+
+        for(i=0; i<block->numEntries; i++) {
+            mixEntryP entry = &block->entries[i];
+            totals->types[entry->type] += block->executions * entry->count;
+        }
+
+        totals->modes[block->mode]     += instrs;
+        totals->XLEN[block->xlenIndex] += instrs;
+    }
+
+    // exclude instructions in the current block not yet executed
+    if(current) {
+
+        Uns32 unexecuted = getUnexecuted(riscv, mix);
+
+        for(i=current->numInstrs-unexecuted; i<current->numInstrs; i++) {
+            totals->types[current->types[i]]--;
+        }
+
+        totals->modes[current->mode]     -= unexecuted;
+        totals->XLEN[current->xlenIndex] -= unexecuted;
+    }
+
+    // derive class totals and overall total from type totals
+    for(i=0; i<RVOC_LAST; i++) {
+        totals->classes[i] = 0;
+    }
+
+    totals->total = 0;
+
+    for(i=0; i<=RV_IT_LAST; i++) {
+        totals->classes[mix->classes[i]] += totals->types[i];
+        totals->total                    += totals->types[i];
+    }
+}
+
+//
+// Print one line of the report
+//
+static void printMixLine(const char *name, Uns64 count, Uns64 total) {
+
+    char countStr[32];
+
+    snprintf(countStr, sizeof(countStr), FMT_64u, count);
+
+    vmiPrintf(
+        "  %-16s %20s  %7.3f%%\n",
+        name,
+        countStr,
+        total ? 100.0*count/total : 0.0
+    );
+}
+
+//
+// Opcode mix report sort context (qsort has no context argument)
+//
+static mixTotalsP sortTotals;
+
+//
+// Compare instruction types by executed count (descending)
+//
+static int compareMixTypes(const void *a, const void *b) {
+
+    Uns64 countA = sortTotals->types[*(riscvIType*)a];
+    Uns64 countB = sortTotals->types[*(riscvIType*)b];
+
+    return (countA<countB) - (countA>countB);
+}
+
+//
+// Print the dynamic opcode mix by instruction class, mode, XLEN and type
+//
+static void printOpcodeMix(riscvP riscv) {
+
+    static const char *classNames[RVOC_LAST] = {
+        [RVOC_INTEGER]    = "integer",
+        [RVOC_LOAD_STORE] = "load/store",
+        [RVOC_MUL_DIV]    = "multiply/divide",
+        [RVOC_BITMANIP]   = "bit manipulation",
+        [RVOC_ATOMIC]     = "atomic",
+        [RVOC_SYSTEM]     = "system",
+        [RVOC_FP]         = "floating point",
+        [RVOC_VECTOR]     = "vector",
+    };
+
+    riscvOpcodeMixP mix      = riscv->opcodeMix;
+    Uns32           numTypes = 0;
+    mixTotals       totals;
+    riscvIType      sortedTypes[RV_IT_LAST+1];
+    char            countStr[32];
+    Uns32           i;
+
+    getMixTotals(riscv, &totals);
+
+    snprintf(countStr, sizeof(countStr), FMT_64u, totals.total);
+    vmiPrintf(
+        "Opcode mix for %s (%s instructions):\n",
+        vmirtProcessorName((vmiProcessorP)riscv),
+        countStr
+    );
+
+    // instruction classes
+    vmiPrintf("  class                          executed  percent\n");
+
+    for(i=0; i<RVOC_LAST; i++) {
+        printMixLine(classNames[i], totals.classes[i], totals.total);
+    }
+
+    // modes
+    vmiPrintf("  mode                           executed  percent\n");
+
+    for(i=0; i<RISCV_MODE_LAST; i++) {
+        if(totals.modes[i]) {
+            printMixLine(riscvGetModeName(i), totals.modes[i], totals.total);
+        }
+    }
+
+    // XLEN
+    vmiPrintf("  XLEN                           executed  percent\n");
+
+    for(i=0; i<2; i++) {
+        if(totals.XLEN[i]) {
+            printMixLine(i ? "64" : "32", totals.XLEN[i], totals.total);
+        }
+    }
+
+    // instruction types sorted by executed count
+    for(i=0; i<=RV_IT_LAST; i++) {
+        if(totals.types[i]) {
+            sortedTypes[numTypes++] = i;
+        }
+    }
+
+    sortTotals = &totals;
+    qsort(sortedTypes, numTypes, sizeof(sortedTypes[0]), compareMixTypes);
+    sortTotals = 0;
+
+    vmiPrintf("  opcode                         executed  percent\n");
+
+    for(i=0; i<numTypes; i++) {
+
+        riscvIType type = sortedTypes[i];
+
+        printMixLine(
+            mix->opcodes[type] ? : "(undecoded)",
+            totals.types[type],
+            totals.total
+        );
+    }
+}
+
+//
+// Print opcode mix command
+//
+static VMIRT_COMMAND_PARSE_FN(opcodeMixReportCommand) {
+
+    printOpcodeMix((riscvP)processor);
+
+    return "1";
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION AND DESTRUCTION
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Allocate opcode mix structures if required
+//
+void riscvNewOpcodeMix(riscvP riscv, riscvParamValuesP params) {
+
+    if(params->opcode_mix) {
+
+        riscv->opcodeMix = STYPE_CALLOC(riscvOpcodeMix);
+
+        // install opcode mix report command
+        vmirtAddCommandParse(
+            (vmiProcessorP)riscv,
+            "opcodeMixReport",
+            "show dynamic opcode mix",
+            opcodeMixReportCommand,
+            VMI_CT_QUERY|VMI_CO_DIAG|VMI_CA_REPORT
+        );
+    }
+}
+
+//
+// Report opcode mix and free opcode mix structures
+//
+void riscvFreeOpcodeMix(riscvP riscv) {
+
+    riscvOpcodeMixP mix = riscv->opcodeMix;
+
+    if(mix) {
+
+        riscvMixBlockP block;
+        riscvMixBlockP next;
+
+        printOpcodeMix(riscv);
+
+        for(block=mix->blockFirst; block; block=next) {
+            next = block->next;
+            STYPE_FREE(block->types);
+            STYPE_FREE(block->entries);
+            STYPE_FREE(block);
+        }
+
+        STYPE_FREE(mix);
+
+        riscv->opcodeMix = 0;
+    }
+}
+
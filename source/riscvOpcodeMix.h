@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+// basic types
+#include "hostapi/impTypes.h"
+
+// model header files
+#include "riscvDecodeTypes.h"
+#include "riscvTypeRefs.h"
+
+
+//
+// Instruction classes used to group the opcode mix
+//
+typedef enum riscvMixClassE {
+    RVOC_INTEGER,                       // other base integer instructions
+    RVOC_LOAD_STORE,                    // scalar loads and stores
+    RVOC_MUL_DIV,                       // integer multiply and divide
+    RVOC_BITMANIP,                      // bit manipulation
+    RVOC_ATOMIC,                        // atomic memory operations
+    RVOC_SYSTEM,                        // CSR, fence and system instructions
+    RVOC_FP,                            // scalar floating point
+    RVOC_VECTOR,                        // vector
+    RVOC_LAST                           // KEEP LAST: for sizing
+} riscvMixClass;
+
+//
+// Allocate opcode mix structures if required
+//
+void riscvNewOpcodeMix(riscvP riscv, riscvParamValuesP params);
+
+//
+// Report opcode mix and free opcode mix structures
+//
+void riscvFreeOpcodeMix(riscvP riscv);
+
+//
+// Record translation of one instruction in the current block, returning the
+// block record if this is the first instruction of the block (in which case a
+// call to riscvOpcodeMixEnterBlock must be emitted)
+//
+riscvMixBlockP riscvOpcodeMixInstruction(
+    riscvP          riscv,
+    riscvInstrInfoP info,
+    riscvMixClass   mixClass
+);
+
+//
+// Record entry to the given block (called from JIT code)
+//
+void riscvOpcodeMixEnterBlock(riscvP riscv, riscvMixBlockP block);
+
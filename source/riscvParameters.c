@@ -277,6 +277,57 @@ static vmiEnumParameter DMModes[] = {
     {0}
 };
 
+//
+// Specify cache model replacement policy
+//
+static vmiEnumParameter cacheReplaceModes[] = {
+    [RVCR_LRU] = {
+        .name        = "LRU",
+        .value       = RVCR_LRU,
+        .description = "Least-recently-used replacement",
+    },
+    [RVCR_FIFO] = {
+        .name        = "FIFO",
+        .value       = RVCR_FIFO,
+        .description = "First-in, first-out replacement",
+    },
+    [RVCR_RANDOM] = {
+        .name        = "random",
+        .value       = RVCR_RANDOM,
+        .description = "Pseudo-random replacement",
+    },
+    // KEEP LAST: terminator
+    {0}
+};
+
+//
+// Specify branch predictor model
+//
+static vmiEnumParameter branchPredictors[] = {
+    [RVBP_NONE] = {
+        .name        = "none",
+        .value       = RVBP_NONE,
+        .description = "No branch predictor model",
+    },
+    [RVBP_BIMODAL] = {
+        .name        = "bimodal",
+        .value       = RVBP_BIMODAL,
+        .description = "Bimodal predictor with 2-bit counters",
+    },
+    [RVBP_GSHARE] = {
+        .name        = "gshare",
+        .value       = RVBP_GSHARE,
+        .description = "Gshare predictor (global history XOR address)",
+    },
+    [RVBP_TAGE] = {
+        .name        = "TAGE",
+        .value       = RVBP_TAGE,
+        .description = "Simplified TAGE predictor with three tagged tables",
+    },
+    // KEEP LAST: terminator
+    {0}
+};
+
 //
 // Return the maximum number of bits that can be specified for CLICCFGMBITS
 //
@@ -713,10 +764,15 @@ static riscvParameter parameters[] = {
     {  RVPV_ALL,     default_debug_mode,           VMI_ENUM_PARAM_SPEC  (riscvParamValues, debug_mode,           DMModes,                   "Specify how Debug mode is implemented")},
     {  RVPV_ALL,     default_debug_address,        VMI_UNS64_PARAM_SPEC (riscvParamValues, debug_address,        0, 0,          -1,         "Specify address to which to jump to enter debug in vectored mode")},
     {  RVPV_ALL,     default_dexc_address,         VMI_UNS64_PARAM_SPEC (riscvParamValues, dexc_address,         0, 0,          -1,         "Specify address to which to jump on debug exception in vectored mode")},
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, trigger_num,          0, 0,          32,         "Specify the number of implemented debug triggers (0 if tselect/tdata1-3 are absent)")},
     {  RVPV_ALL,     0,                            VMI_BOOL_PARAM_SPEC  (riscvParamValues, verbose,              False,                     "Specify verbose output messages")},
+    {  RVPV_ALL,     0,                            VMI_BOOL_PARAM_SPEC  (riscvParamValues, enable_profile,       False,                     "Specify whether guest function profiling is enabled (a callgrind-format profile is written at exit)")},
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, profile_sample,       0, 0,          -1,         "Specify number of instructions between call stack samples (0 disables sampling; folded stacks are written at exit)")},
+    {  RVPV_ALL,     0,                            VMI_STRING_PARAM_SPEC(riscvParamValues, profile_file,         "callgrind.out",           "Specify function profile file name prefix (the hart name is appended)")},
     {  RVPV_MPCORE,  default_numHarts,             VMI_UNS32_PARAM_SPEC (riscvParamValues, numHarts,             0, 0,          32,         "Specify the number of hart contexts in a multiprocessor")},
     {  RVPV_S,       default_updatePTEA,           VMI_BOOL_PARAM_SPEC  (riscvParamValues, updatePTEA,           False,                     "Specify whether hardware update of PTE A bit is supported")},
     {  RVPV_S,       default_updatePTED,           VMI_BOOL_PARAM_SPEC  (riscvParamValues, updatePTED,           False,                     "Specify whether hardware update of PTE D bit is supported")},
+    {  RVPV_S,       0,                            VMI_BOOL_PARAM_SPEC  (riscvParamValues, tlb_prefill,          False,                     "Specify whether a TLB miss also creates TLB entries for valid neighbouring page table entries in the same 64-byte line")},
     {  RVPV_ALL,     default_unaligned,            VMI_BOOL_PARAM_SPEC  (riscvParamValues, unaligned,            False,                     "Specify whether the processor supports unaligned memory accesses")},
     {  RVPV_A,       default_unalignedAMO,         VMI_BOOL_PARAM_SPEC  (riscvParamValues, unalignedAMO,         False,                     "Specify whether the processor supports unaligned memory accesses for AMO instructions")},
     {  RVPV_ALL,     default_wfi_is_nop,           VMI_BOOL_PARAM_SPEC  (riscvParamValues, wfi_is_nop,           False,                     "Specify whether WFI should be treated as a NOP (if not, halt while waiting for interrupts)")},
@@ -809,6 +865,47 @@ static riscvParameter parameters[] = {
     {  RVPV_CLIC,    default_intthresh_undefined,  VMI_BOOL_PARAM_SPEC  (riscvParamValues, intthresh_undefined,  False,                     "Specify that mintthreash, sintthresh and uintthresh CSRs are undefined")},
     {  RVPV_CLIC,    default_mclicbase_undefined,  VMI_BOOL_PARAM_SPEC  (riscvParamValues, mclicbase_undefined,  False,                     "Specify that mclicbase CSR is undefined")},
 
+    // cache model configuration
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, cache_line,           64, 4,         4096,       "Specify cache line size in bytes for the cache model")},
+    {  RVPV_ALL,     0,                            VMI_ENUM_PARAM_SPEC  (riscvParamValues, cache_replace,        cacheReplaceModes,         "Specify cache model replacement policy")},
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, L1I_size,             0, 0,          -1,         "Specify L1 instruction cache size in bytes for the cache model (0 if absent)")},
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, L1I_ways,             2, 1,          64,         "Specify L1 instruction cache associativity for the cache model")},
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, L1D_size,             0, 0,          -1,         "Specify L1 data cache size in bytes for the cache model (0 if absent)")},
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, L1D_ways,             4, 1,          64,         "Specify L1 data cache associativity for the cache model")},
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, L2_size,              0, 0,          -1,         "Specify unified L2 cache size in bytes for the cache model (0 if absent)")},
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, L2_ways,              8, 1,          64,         "Specify unified L2 cache associativity for the cache model")},
+
+    // branch trace and predictor configuration
+    {  RVPV_ALL,     0,                            VMI_STRING_PARAM_SPEC(riscvParamValues, branch_trace,         "",                        "Specify branch trace file name prefix (the hart name is appended; empty if branch trace disabled)")},
+    {  RVPV_ALL,     0,                            VMI_ENUM_PARAM_SPEC  (riscvParamValues, branch_predictor,     branchPredictors,          "Specify branch predictor model for which misprediction statistics are reported")},
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, branch_predictor_bits,12, 4,         20,         "Specify log2 of the number of branch predictor table entries")},
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, branch_ras_depth,     16, 0,         256,        "Specify branch predictor return address stack depth (0 if absent)")},
+
+    // co-simulation configuration
+    {  RVPV_ALL,     0,                            VMI_STRING_PARAM_SPEC(riscvParamValues, cosim_shm,            "",                        "Specify co-simulation shared memory object name prefix (the hart name is appended; empty if not used)")},
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, cosim_ring,           4096, 2,       1<<20,      "Specify number of records in the co-simulation ring (rounded up to a power of two)")},
+    {  RVPV_ALL,     0,                            VMI_BOOL_PARAM_SPEC  (riscvParamValues, cosim_stepping,       False,                     "Specify that the co-simulation testbench controls stepping from the first instruction")},
+    {  RVPV_ALL,     0,                            VMI_STRING_PARAM_SPEC(riscvParamValues, cosim_log,            "",                        "Specify file to which the local co-simulation consumer writes retire records (empty if not used)")},
+    {  RVPV_ALL,     0,                            VMI_STRING_PARAM_SPEC(riscvParamValues, cosim_expect,         "",                        "Specify file of expected retire records compared by the local co-simulation consumer (empty if not used)")},
+
+    // stimulus record/replay configuration
+    {  RVPV_ALL,     0,                            VMI_STRING_PARAM_SPEC(riscvParamValues, stimulus_record,      "",                        "Specify file name prefix to which input port events are recorded (the hart name is appended; empty if not used)")},
+    {  RVPV_ALL,     0,                            VMI_STRING_PARAM_SPEC(riscvParamValues, stimulus_replay,      "",                        "Specify file name prefix from which input port events are replayed (the hart name is appended; empty if not used)")},
+
+    // fault injection campaign configuration
+    {  RVPV_ALL,     0,                            VMI_STRING_PARAM_SPEC(riscvParamValues, fault_campaign,       "",                        "Specify fault injection campaign file (empty if not used)")},
+    {  RVPV_ALL,     0,                            VMI_STRING_PARAM_SPEC(riscvParamValues, fault_report,         "fault_report.txt",        "Specify fault injection campaign report file")},
+    {  RVPV_ALL,     0,                            VMI_UNS32_PARAM_SPEC (riscvParamValues, fault_jobs,           0, 0,          1024,       "Specify maximum number of concurrent fault injection runs (0 for one per host core)")},
+    {  RVPV_ALL,     0,                            VMI_UNS64_PARAM_SPEC (riscvParamValues, fault_timeout,        0, 0,          -1,         "Specify instructions after injection before a fault injection run is classified as a hang (0 to derive from the golden run)")},
+    {  RVPV_ALL,     0,                            VMI_UNS64_PARAM_SPEC (riscvParamValues, fault_sig_addr,       0, 0,          -1,         "Specify physical address of memory included in the fault injection signature")},
+    {  RVPV_ALL,     0,                            VMI_UNS64_PARAM_SPEC (riscvParamValues, fault_sig_size,       0, 0,          -1,         "Specify size of memory included in the fault injection signature (0 if none)")},
+
+    // translation statistics configuration
+    {  RVPV_ALL,     0,                            VMI_BOOL_PARAM_SPEC  (riscvParamValues, morph_stats,          False,                     "Specify that translation statistics are collected and reported at the end of simulation")},
+
+    // opcode mix configuration
+    {  RVPV_ALL,     0,                            VMI_BOOL_PARAM_SPEC  (riscvParamValues, opcode_mix,           False,                     "Specify that the dynamic opcode mix is counted and reported at the end of simulation")},
+
     // KEEP LAST
     {  RVPV_ALL,     0,                            VMI_END_PARAM}
 };
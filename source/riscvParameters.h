@@ -41,12 +41,17 @@ typedef struct riscvParamValuesS {
     VMI_ENUM_PARAM(fp16_version);
     VMI_ENUM_PARAM(mstatus_fs_mode);
     VMI_BOOL_PARAM(verbose);
+    VMI_BOOL_PARAM(enable_profile);
+    VMI_UNS32_PARAM(profile_sample);
+    VMI_STRING_PARAM(profile_file);
     VMI_UNS32_PARAM(numHarts);
     VMI_BOOL_PARAM(debug_mode);
     VMI_UNS64_PARAM(debug_address);
     VMI_UNS64_PARAM(dexc_address);
+    VMI_UNS32_PARAM(trigger_num);
     VMI_BOOL_PARAM(updatePTEA);
     VMI_BOOL_PARAM(updatePTED);
+    VMI_BOOL_PARAM(tlb_prefill);
     VMI_BOOL_PARAM(unaligned);
     VMI_BOOL_PARAM(unalignedAMO);
     VMI_BOOL_PARAM(wfi_is_nop);
@@ -139,6 +144,45 @@ typedef struct riscvParamValuesS {
     VMI_BOOL_PARAM(intthresh_undefined);
     VMI_BOOL_PARAM(mclicbase_undefined);
 
+    // cache model configuration
+    VMI_UNS32_PARAM(cache_line);
+    VMI_ENUM_PARAM(cache_replace);
+    VMI_UNS32_PARAM(L1I_size);
+    VMI_UNS32_PARAM(L1I_ways);
+    VMI_UNS32_PARAM(L1D_size);
+    VMI_UNS32_PARAM(L1D_ways);
+    VMI_UNS32_PARAM(L2_size);
+    VMI_UNS32_PARAM(L2_ways);
+
+    // branch trace and predictor configuration
+    VMI_STRING_PARAM(branch_trace);
+    VMI_ENUM_PARAM(branch_predictor);
+    VMI_UNS32_PARAM(branch_predictor_bits);
+    VMI_UNS32_PARAM(branch_ras_depth);
+
+    // co-simulation configuration
+    VMI_STRING_PARAM(cosim_shm);
+    VMI_UNS32_PARAM(cosim_ring);
+    VMI_BOOL_PARAM(cosim_stepping);
+    VMI_STRING_PARAM(cosim_log);
+    VMI_STRING_PARAM(cosim_expect);
+
+    // stimulus record/replay configuration
+    VMI_STRING_PARAM(stimulus_record);
+    VMI_STRING_PARAM(stimulus_replay);
+
+    // fault injection campaign configuration
+    VMI_STRING_PARAM(fault_campaign);
+    VMI_STRING_PARAM(fault_report);
+    VMI_UNS32_PARAM(fault_jobs);
+    VMI_UNS64_PARAM(fault_timeout);
+    VMI_UNS64_PARAM(fault_sig_addr);
+    VMI_UNS64_PARAM(fault_sig_size);
+
+    // translation statistics configuration
+    VMI_BOOL_PARAM(morph_stats);
+    VMI_BOOL_PARAM(opcode_mix);
+
 } riscvParamValues;
 
 //
@@ -0,0 +1,1219 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// standard header files
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Imperas header files
+#include "hostapi/impAlloc.h"
+
+// VMI header files
+#include "vmi/vmiMessage.h"
+#include "vmi/vmiRt.h"
+
+// model header files
+#include "riscvBlockState.h"
+#include "riscvMessage.h"
+#include "riscvProfile.h"
+#include "riscvRegisters.h"
+#include "riscvStructure.h"
+#include "riscvUtils.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Maximum depth of the shadow call stack (deeper calls are not recorded)
+//
+#define PROFILE_STACK_MAX   1024
+
+//
+// Number of functions shown in the flat profile report
+//
+#define PROFILE_REPORT_NUM  32
+
+//
+// Number of hash buckets used to accumulate stack samples
+//
+#define PROFILE_SAMPLE_HASH 4096
+
+//
+// Maximum number of frames recovered by a frame pointer unwind
+//
+#define PROFILE_UNWIND_MAX  64
+
+//
+// Size in words of the per-hart buffer of raw stack samples (must hold at least
+// one sample of a full shadow stack)
+//
+#define PROFILE_RING_WORDS  16384
+
+DEFINE_S(profileArc);
+DEFINE_S(profileFn);
+DEFINE_S(profileFrame);
+DEFINE_S(profileSample);
+
+//
+// Statistics for calls from one function to another
+//
+typedef struct profileArcS {
+    profileArcP next;           // next arc from the same caller
+    profileFnP  callee;         // called function
+    Uns64       calls;          // number of calls
+    Uns64       inclI;          // inclusive instructions in callee
+    Uns64       inclC;          // inclusive cycles in callee
+} profileArc;
+
+//
+// Statistics for one function, identified by its entry address
+//
+typedef struct profileFnS {
+    profileFnP  next;           // next function in creation order
+    profileArcP arcs;           // calls made from this function
+    Uns64       addr;           // function entry address
+    Uns64       calls;          // number of calls
+    Uns64       selfI;          // exclusive instructions
+    Uns64       selfC;          // exclusive cycles
+    Uns64       inclI;          // inclusive instructions
+    Uns64       inclC;          // inclusive cycles
+    Uns32       active;         // activations on the shadow stack
+} profileFn;
+
+//
+// Shadow call stack entry
+//
+typedef struct profileFrameS {
+    profileFnP  fn;             // active function
+    profileArcP arc;            // arc used to enter function (0 for root)
+    Uns64       retAddr;        // expected return address
+    Uns64       startI;         // instruction count at entry
+    Uns64       startC;         // cycle count at entry
+    Uns64       childI;         // inclusive instructions in callees
+    Uns64       childC;         // inclusive cycles in callees
+    Bool        trap;           // whether frame was entered by a trap
+} profileFrame;
+
+//
+// Accumulated count for one sampled stack (function entry addresses from the
+// shadow stack or return addresses from a frame pointer unwind, from the
+// outermost frame, followed by the sampled PC)
+//
+typedef struct profileSampleS {
+    profileSampleP next;        // next sample in the same hash bucket
+    Uns64         *addrs;       // stack addresses
+    Uns64          count;       // number of times this stack was sampled
+    Uns32          hash;        // hash of stack addresses
+    Uns32          num;         // number of stack addresses
+    Bool           unwound;     // whether from a frame pointer unwind
+} profileSample;
+
+//
+// Function profiling state for one hart
+//
+typedef struct riscvProfileS {
+    char          *file;        // output file name prefix
+    Bool           callGraph;   // whether to write callgrind profile
+    Uns32          interval;    // instructions between samples (0 if none)
+    Bool           sampling;    // whether stack sampling is active
+    vmiModelTimerP sampleTimer; // stack sampling timer
+    Uns64          samples;     // total samples taken
+    Uns32          sampleNum;   // number of distinct sampled stacks
+    Uns32          ringNext;    // next free word in raw sample buffer
+    vmiRangeTableP fnTable;     // functions indexed by entry address
+    Uns64          lastTarget;  // most recent register call target
+    profileFnP     lastFn;      // function for most recent register target
+    profileFnP     fnFirst;     // first function in creation order
+    profileFnP     fnLast;      // last function in creation order
+    Uns64          lost;        // calls not recorded (stack overflow)
+    Uns32          depth;       // current shadow stack depth
+    profileFrame   stack[PROFILE_STACK_MAX];
+    profileSampleP sampleTable[PROFILE_SAMPLE_HASH];
+    Uns64          ring[PROFILE_RING_WORDS];
+} riscvProfile;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// UTILITIES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return instructions executed by the hart
+//
+inline static Uns64 getProfileInstructions(riscvP riscv) {
+    return vmirtGetExecutedICount((vmiProcessorP)riscv);
+}
+
+//
+// Return cycles elapsed on the hart (including cycles halted in WFI)
+//
+inline static Uns64 getProfileCycles(riscvP riscv) {
+    return vmirtGetICount((vmiProcessorP)riscv);
+}
+
+//
+// Return the name of the symbol containing the given address, or NULL if
+// there is none
+//
+static const char *findProfileSymbol(riscvP riscv, Uns64 addr) {
+
+    vmiSymbolFileCP file = 0;
+
+    while((file=vmirtNextSymbolFile((vmiProcessorP)riscv, file))) {
+
+        vmiSymbolCP symbol = vmirtGetSymbolByAddr(file, addr);
+
+        if(symbol) {
+            return vmirtGetSymbolName(symbol);
+        }
+    }
+
+    return 0;
+}
+
+//
+// Return the name of the symbol containing the given address, or a
+// hexadecimal representation of the address if there is none
+//
+static const char *getProfileSymbol(
+    riscvP riscv,
+    Uns64  addr,
+    char  *buffer,
+    Uns32  bufferLen
+) {
+    const char *result = findProfileSymbol(riscv, addr);
+
+    if(!result) {
+        snprintf(buffer, bufferLen, "0x"FMT_Ax, addr);
+        result = buffer;
+    }
+
+    return result;
+}
+
+//
+// Return statistics for the function with the given entry address, creating
+// them if required
+//
+static profileFnP getProfileFn(riscvProfileP profile, Uns64 addr) {
+
+    vmiRangeTablePP tableP = &profile->fnTable;
+    vmiRangeEntryP  entry  = vmirtGetFirstRangeEntry(tableP, addr, addr);
+    profileFnP      fn;
+
+    if(entry) {
+
+        fn = (profileFnP)(UnsPS)vmirtGetRangeEntryUserData(entry);
+
+    } else {
+
+        fn = STYPE_CALLOC(profileFn);
+
+        fn->addr = addr;
+
+        // append to list in creation order
+        if(profile->fnLast) {
+            profile->fnLast->next = fn;
+        } else {
+            profile->fnFirst = fn;
+        }
+
+        profile->fnLast = fn;
+
+        vmirtInsertRangeEntry(tableP, addr, addr, (UnsPS)fn);
+    }
+
+    return fn;
+}
+
+//
+// Return a Boolean indicating if the function has been entered (statistics are
+// also created when calls to constant addresses are translated)
+//
+inline static Bool isProfileFnUsed(profileFnP fn) {
+    return fn->calls || fn->active || fn->selfI || fn->arcs;
+}
+
+//
+// Return statistics for calls from the caller to the callee, creating them if
+// required
+//
+static profileArcP getProfileArc(profileFnP caller, profileFnP callee) {
+
+    profileArcP arc;
+
+    for(arc=caller->arcs; arc && (arc->callee!=callee); arc=arc->next) {
+        // no action
+    }
+
+    if(!arc) {
+        arc           = STYPE_CALLOC(profileArc);
+        arc->callee   = callee;
+        arc->next     = caller->arcs;
+        caller->arcs  = arc;
+    }
+
+    return arc;
+}
+
+//
+// Push a frame for the given function on the shadow stack
+//
+static void pushProfileFrame(
+    riscvP      riscv,
+    profileFnP  fn,
+    profileArcP arc,
+    Uns64       retAddr
+) {
+    riscvProfileP profile = riscv->profile;
+
+    if(profile->depth==PROFILE_STACK_MAX) {
+
+        // stack is full: attribute callee to caller
+        profile->lost++;
+
+    } else {
+
+        profileFrameP frame = &profile->stack[profile->depth++];
+
+        frame->fn      = fn;
+        frame->arc     = arc;
+        frame->retAddr = retAddr;
+        frame->startI  = getProfileInstructions(riscv);
+        frame->startC  = getProfileCycles(riscv);
+        frame->childI  = 0;
+        frame->childC  = 0;
+        frame->trap    = False;
+
+        fn->active++;
+    }
+}
+
+//
+// Pop the topmost frame from the shadow stack, attributing its counts
+//
+static void popProfileFrame(riscvP riscv) {
+
+    riscvProfileP profile = riscv->profile;
+    profileFrameP frame   = &profile->stack[--profile->depth];
+    profileFnP    fn      = frame->fn;
+    Uns64         inclI   = getProfileInstructions(riscv) - frame->startI;
+    Uns64         inclC   = getProfileCycles(riscv)       - frame->startC;
+
+    // attribute exclusive counts
+    fn->selfI += inclI - frame->childI;
+    fn->selfC += inclC - frame->childC;
+
+    // attribute inclusive counts for the outermost activation only, so that
+    // recursive calls are not counted more than once
+    if(!--fn->active) {
+        fn->inclI += inclI;
+        fn->inclC += inclC;
+    }
+
+    // attribute inclusive counts to the arc used to enter the function
+    if(frame->arc) {
+        frame->arc->inclI += inclI;
+        frame->arc->inclC += inclC;
+    }
+
+    // attribute inclusive counts to any caller
+    if(profile->depth) {
+        frame[-1].childI += inclI;
+        frame[-1].childC += inclC;
+    }
+}
+
+//
+// Push a root frame for the function containing the current PC
+//
+static void pushProfileRoot(riscvP riscv) {
+
+    riscvProfileP profile = riscv->profile;
+    Uns64         PC      = vmirtGetPC((vmiProcessorP)riscv);
+
+    pushProfileFrame(riscv, getProfileFn(profile, PC), 0, 0);
+}
+
+//
+// Pop all frames from the shadow stack
+//
+static void popProfileAll(riscvP riscv) {
+
+    while(riscv->profile->depth) {
+        popProfileFrame(riscv);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// STACK SAMPLING
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return hash of the given stack addresses
+//
+static Uns32 hashProfileStack(Uns64 *addrs, Uns32 num) {
+
+    Uns64 hash = 0xcbf29ce484222325ULL;
+    Uns32 i;
+
+    for(i=0; i<num; i++) {
+        hash = (hash ^ addrs[i]) * 0x100000001b3ULL;
+    }
+
+    return hash ^ (hash>>32);
+}
+
+//
+// Add one sample of the given stack addresses
+//
+static void addProfileSample(
+    riscvProfileP profile,
+    Uns64        *addrs,
+    Uns32         num,
+    Bool          unwound
+) {
+    Uns32           hash    = hashProfileStack(addrs, num);
+    profileSamplePP bucketP = &profile->sampleTable[hash%PROFILE_SAMPLE_HASH];
+    profileSampleP  sample;
+
+    // look for an existing sample of this stack
+    for(sample=*bucketP; sample; sample=sample->next) {
+        if(
+            (sample->hash==hash)       &&
+            (sample->num==num)         &&
+            (sample->unwound==unwound) &&
+            !memcmp(sample->addrs, addrs, num*sizeof(addrs[0]))
+        ) {
+            break;
+        }
+    }
+
+    // create a new sample if required
+    if(!sample) {
+
+        sample          = STYPE_CALLOC(profileSample);
+        sample->addrs   = STYPE_CALLOC_N(Uns64, num);
+        sample->hash    = hash;
+        sample->num     = num;
+        sample->unwound = unwound;
+        sample->next    = *bucketP;
+        *bucketP        = sample;
+
+        memcpy(sample->addrs, addrs, num*sizeof(addrs[0]));
+
+        profile->sampleNum++;
+    }
+
+    sample->count++;
+}
+
+//
+// Accumulate all raw samples in the per-hart buffer and empty it (each raw
+// sample is a header word holding the address count and unwind flag, followed
+// by the addresses)
+//
+static void drainProfileSamples(riscvProfileP profile) {
+
+    Uns32 i, num;
+
+    for(i=0; i<profile->ringNext; i+=num+1) {
+
+        Uns64 header = profile->ring[i];
+
+        num = header>>1;
+
+        addProfileSample(profile, &profile->ring[i+1], num, header&1);
+    }
+
+    profile->ringNext = 0;
+}
+
+//
+// Fill the given array with the shadow stack and current PC, returning the
+// number of addresses
+//
+static Uns32 getShadowStack(riscvP riscv, Uns64 *addrs) {
+
+    riscvProfileP profile = riscv->profile;
+    Uns32         depth   = profile->depth;
+    Uns32         i;
+
+    for(i=0; i<depth; i++) {
+        addrs[i] = profile->stack[i].fn->addr;
+    }
+
+    addrs[depth] = vmirtGetPC((vmiProcessorP)riscv);
+
+    return depth+1;
+}
+
+//
+// Read one word of a stack frame (an artifact access, so that sampling has no
+// side effects on the simulated system)
+//
+static Uns64 readFrameWord(
+    memDomainP domain,
+    memEndian  endian,
+    Uns64      addr,
+    Uns32      bytes
+) {
+    if(bytes==4) {
+        return vmirtRead4ByteDomain(domain, addr, endian, MEM_AA_FALSE);
+    } else {
+        return vmirtRead8ByteDomain(domain, addr, endian, MEM_AA_FALSE);
+    }
+}
+
+//
+// Fill the given array with return addresses found by walking the frame
+// pointer chain in s0 (using the standard frame layout, with the return
+// address and previous frame pointer in the two words below the frame
+// pointer), followed by the current PC, returning the number of addresses. The
+// walk stops at a null, misaligned or non-increasing frame pointer.
+//
+static Uns32 unwindFramePointers(riscvP riscv, Uns64 *addrs) {
+
+    memDomainP domain = vmirtGetProcessorDataDomain((vmiProcessorP)riscv);
+    memEndian  endian = riscvGetDataEndian(riscv, getCurrentMode(riscv));
+    Uns32      bytes  = riscvGetXlenMode(riscv)/8;
+    Uns64      mask   = (bytes==4) ? 0xffffffffULL : -1ULL;
+    Uns64      fp     = riscv->x[RV_REG_X_S0] & mask;
+    Uns64      prevFP = 0;
+    Uns64      frames[PROFILE_UNWIND_MAX];
+    Uns32      num    = 0;
+    Uns32      i;
+
+    while(
+        (num<PROFILE_UNWIND_MAX) &&
+        (fp>prevFP)              &&
+        (fp>=2*bytes)            &&
+        !(fp & (bytes-1))
+    ) {
+        Uns64 ra = readFrameWord(domain, endian, fp-bytes, bytes) & mask;
+
+        if(ra) {
+
+            // record the address of the call rather than the return address,
+            // so that calls at the end of a function are attributed to it
+            frames[num++] = ra-2;
+
+            prevFP = fp;
+            fp     = readFrameWord(domain, endian, fp-2*bytes, bytes) & mask;
+
+        } else {
+
+            // null return address terminates the chain
+            prevFP = fp;
+        }
+    }
+
+    // addresses are recorded from the outermost frame
+    for(i=0; i<num; i++) {
+        addrs[i] = frames[num-i-1];
+    }
+
+    addrs[num] = vmirtGetPC((vmiProcessorP)riscv);
+
+    return num+1;
+}
+
+//
+// Sample the call stack and current PC into the per-hart raw sample buffer,
+// using the shadow stack if it is maintained and the frame pointer chain
+// otherwise (raw samples are accumulated only when the buffer is full or at
+// the end of simulation)
+//
+static void takeProfileSample(riscvP riscv) {
+
+    riscvProfileP profile = riscv->profile;
+    Bool          unwound = !(riscv->pmKey & PMK_PROFILE);
+    Uns64        *record;
+    Uns32         num;
+
+    // make room for a sample of a full shadow stack
+    if((profile->ringNext+PROFILE_STACK_MAX+2) > PROFILE_RING_WORDS) {
+        drainProfileSamples(profile);
+    }
+
+    record = &profile->ring[profile->ringNext];
+
+    if(unwound) {
+        num = unwindFramePointers(riscv, record+1);
+    } else {
+        num = getShadowStack(riscv, record+1);
+    }
+
+    record[0] = (num<<1) | unwound;
+
+    profile->ringNext += num+1;
+    profile->samples++;
+}
+
+//
+// Stack sampling timer callback
+//
+static VMI_ICOUNT_FN(profileSampleCB) {
+
+    riscvP        riscv   = (riscvP)processor;
+    riscvProfileP profile = riscv->profile;
+
+    // sample only while profiling is active
+    if(profile->sampling) {
+        takeProfileSample(riscv);
+    }
+
+    vmirtSetModelTimer(profile->sampleTimer, profile->interval);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// REPORTING
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Write profile in callgrind format (suitable for kcachegrind and
+// callgrind_annotate)
+//
+static void writeProfile(riscvP riscv) {
+
+    riscvProfileP profile = riscv->profile;
+    const char   *name    = vmirtProcessorName((vmiProcessorP)riscv);
+    Uns32         len     = strlen(profile->file) + strlen(name) + 2;
+    char          path[len];
+    char          buffer[32];
+    FILE         *f;
+    profileFnP    fn;
+    profileArcP   arc;
+
+    // construct per-hart file name
+    snprintf(path, len, "%s.%s", profile->file, name);
+
+    if(!(f=fopen(path, "w"))) {
+
+        vmiMessage("W", CPU_PREFIX"_PFO",
+            NO_SRCREF_FMT "Cannot open profile file '%s'",
+            NO_SRCREF_ARGS(riscv), path
+        );
+
+    } else {
+
+        fprintf(f, "version: 1\n");
+        fprintf(f, "creator: riscvOVPsim\n");
+        fprintf(f, "cmd: %s\n", name);
+        fprintf(f, "positions: instr\n");
+        fprintf(f, "events: Ir Cycles\n\n");
+
+        for(fn=profile->fnFirst; fn; fn=fn->next) {
+
+            if(isProfileFnUsed(fn)) {
+
+                fprintf(f,
+                    "fn=%s\n",
+                    getProfileSymbol(riscv, fn->addr, buffer, sizeof(buffer))
+                );
+                fprintf(f,
+                    "0x"FMT_Ax" "FMT_64u" "FMT_64u"\n",
+                    fn->addr, fn->selfI, fn->selfC
+                );
+
+                for(arc=fn->arcs; arc; arc=arc->next) {
+
+                    profileFnP callee = arc->callee;
+
+                    fprintf(f,
+                        "cfn=%s\n",
+                        getProfileSymbol(
+                            riscv, callee->addr, buffer, sizeof(buffer)
+                        )
+                    );
+                    fprintf(f,
+                        "calls="FMT_64u" 0x"FMT_Ax"\n",
+                        arc->calls, callee->addr
+                    );
+                    fprintf(f,
+                        "0x"FMT_Ax" "FMT_64u" "FMT_64u"\n",
+                        fn->addr, arc->inclI, arc->inclC
+                    );
+                }
+
+                fprintf(f, "\n");
+            }
+        }
+
+        fclose(f);
+
+        if(riscv->verbose) {
+            vmiMessage("I", CPU_PREFIX"_PFW",
+                NO_SRCREF_FMT "Function profile written to '%s'",
+                NO_SRCREF_ARGS(riscv), path
+            );
+        }
+    }
+}
+
+//
+// Folded stack line with sample count
+//
+typedef struct foldedStackS {
+    char  *stack;
+    Uns64  count;
+} foldedStack, *foldedStackP;
+
+//
+// Compare folded stacks by name
+//
+static int compareFoldedStack(const void *a, const void *b) {
+
+    foldedStackP stackA = (foldedStackP)a;
+    foldedStackP stackB = (foldedStackP)b;
+
+    return strcmp(stackA->stack, stackB->stack);
+}
+
+//
+// Return folded representation of the given sample (semicolon-separated
+// function names from the outermost frame)
+//
+static char *getFoldedStack(riscvP riscv, profileSampleP sample) {
+
+    Uns32       num = sample->num;
+    const char *names[num];
+    char        buffers[num][32];
+    Uns32       len = 1;
+    char       *result;
+    char       *tail;
+    Uns32       i;
+
+    // the function containing the sampled PC replaces the innermost function
+    // from the shadow stack (so tail-called functions are identified) unless
+    // it has no symbol; an unwound stack holds only return addresses, so the
+    // sampled PC is always shown
+    if((num>1) && !sample->unwound) {
+        num--;
+    }
+
+    for(i=0; i<num; i++) {
+        names[i] = getProfileSymbol(
+            riscv, sample->addrs[i], buffers[i], sizeof(buffers[i])
+        );
+    }
+
+    if(num<sample->num) {
+
+        const char *leaf = findProfileSymbol(riscv, sample->addrs[num]);
+
+        if(leaf) {
+            names[num-1] = leaf;
+        }
+    }
+
+    for(i=0; i<num; i++) {
+        len += strlen(names[i]) + 1;
+    }
+
+    result = tail = STYPE_CALLOC_N(char, len);
+
+    for(i=0; i<num; i++) {
+        tail += sprintf(tail, "%s%s", i ? ";" : "", names[i]);
+    }
+
+    return result;
+}
+
+//
+// Write stack samples in folded format (suitable for flamegraph.pl), merging
+// stacks that differ only in sampled addresses within the same functions
+//
+static void writeSamples(riscvP riscv) {
+
+    riscvProfileP profile = riscv->profile;
+    const char   *name    = vmirtProcessorName((vmiProcessorP)riscv);
+    Uns32         len     = strlen(profile->file) + strlen(name) + 9;
+    Uns32         num     = profile->sampleNum;
+    foldedStackP  stacks  = STYPE_CALLOC_N(foldedStack, num);
+    char          path[len];
+    FILE         *f;
+    Uns32         i, j;
+
+    // construct per-hart file name
+    snprintf(path, len, "%s.%s.folded", profile->file, name);
+
+    // construct folded stacks
+    for(i=0, j=0; i<PROFILE_SAMPLE_HASH; i++) {
+
+        profileSampleP sample;
+
+        for(sample=profile->sampleTable[i]; sample; sample=sample->next) {
+            stacks[j].stack = getFoldedStack(riscv, sample);
+            stacks[j].count = sample->count;
+            j++;
+        }
+    }
+
+    qsort(stacks, num, sizeof(stacks[0]), compareFoldedStack);
+
+    if(!(f=fopen(path, "w"))) {
+
+        vmiMessage("W", CPU_PREFIX"_PFO",
+            NO_SRCREF_FMT "Cannot open profile file '%s'",
+            NO_SRCREF_ARGS(riscv), path
+        );
+
+    } else {
+
+        for(i=0; i<num; i=j) {
+
+            Uns64 count = 0;
+
+            for(j=i; (j<num) && !strcmp(stacks[i].stack, stacks[j].stack); j++) {
+                count += stacks[j].count;
+            }
+
+            fprintf(f, "%s "FMT_64u"\n", stacks[i].stack, count);
+        }
+
+        fclose(f);
+
+        if(riscv->verbose) {
+            vmiMessage("I", CPU_PREFIX"_PFW",
+                NO_SRCREF_FMT "Stack samples written to '%s'",
+                NO_SRCREF_ARGS(riscv), path
+            );
+        }
+    }
+
+    for(i=0; i<num; i++) {
+        STYPE_FREE(stacks[i].stack);
+    }
+
+    STYPE_FREE(stacks);
+}
+
+//
+// Compare functions by exclusive instruction count (descending)
+//
+static int compareProfileFn(const void *a, const void *b) {
+
+    profileFnP fnA = *(profileFnP*)a;
+    profileFnP fnB = *(profileFnP*)b;
+
+    return (fnA->selfI<fnB->selfI) - (fnA->selfI>fnB->selfI);
+}
+
+//
+// Print a flat profile of the functions with the highest exclusive
+// instruction counts (in the style of gprof)
+//
+static void printFlatProfile(riscvP riscv) {
+
+    riscvProfileP profile = riscv->profile;
+    Uns64         totalI  = 0;
+    Uns32         num     = 0;
+    char          buffer[32];
+    profileFnP    fn;
+    Uns32         i;
+
+    // count functions and instructions
+    for(fn=profile->fnFirst; fn; fn=fn->next) {
+        if(isProfileFnUsed(fn)) {
+            totalI += fn->selfI;
+            num++;
+        }
+    }
+
+    // sort functions by exclusive instruction count
+    profileFnP sorted[num ? : 1];
+
+    for(fn=profile->fnFirst, i=0; fn; fn=fn->next) {
+        if(isProfileFnUsed(fn)) {
+            sorted[i++] = fn;
+        }
+    }
+
+    qsort(sorted, num, sizeof(sorted[0]), compareProfileFn);
+
+    vmiPrintf(
+        "Flat profile for %s ("FMT_64u" instructions, "FMT_64u" lost calls):\n"
+        "  %%self        self instr        incl instr      calls  name\n",
+        vmirtProcessorName((vmiProcessorP)riscv), totalI, profile->lost
+    );
+
+    for(i=0; (i<num) && (i<PROFILE_REPORT_NUM); i++) {
+
+        char selfI[32];
+        char inclI[32];
+        char calls[32];
+
+        fn = sorted[i];
+
+        snprintf(selfI, sizeof(selfI), FMT_64u, fn->selfI);
+        snprintf(inclI, sizeof(inclI), FMT_64u, fn->inclI);
+        snprintf(calls, sizeof(calls), FMT_64u, fn->calls);
+
+        vmiPrintf(
+            "  %6.2f  %16s  %16s  %9s  %s\n",
+            totalI ? (100.0*fn->selfI)/totalI : 0.0,
+            selfI, inclI, calls,
+            getProfileSymbol(riscv, fn->addr, buffer, sizeof(buffer))
+        );
+    }
+}
+
+//
+// Print flat profile (counts for active functions are attributed only when
+// they return)
+//
+static VMIRT_COMMAND_PARSE_FN(profileReportCommand) {
+
+    riscvP riscv = (riscvP)processor;
+
+    if(riscv->profile) {
+        printFlatProfile(riscv);
+    }
+
+    return "1";
+}
+
+//
+// Enable function profiling
+//
+static VMIRT_COMMAND_PARSE_FN(profileStartCommand) {
+
+    riscvSetProfileActive((riscvP)processor, True);
+
+    return "1";
+}
+
+//
+// Disable function profiling
+//
+static VMIRT_COMMAND_PARSE_FN(profileStopCommand) {
+
+    riscvSetProfileActive((riscvP)processor, False);
+
+    return "1";
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// JIT CODE CALLBACKS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return statistics for the function at the given target address, for use
+// with riscvProfileCallFn (called when a call to a constant address is
+// translated)
+//
+riscvProfileFnP riscvProfileGetFn(riscvP riscv, Uns64 target) {
+    return getProfileFn(riscv->profile, target & -2);
+}
+
+//
+// Record a call to the given function (called from JIT code)
+//
+void riscvProfileCallFn(riscvP riscv, riscvProfileFnP callee, Uns64 linkPC) {
+
+    riscvProfileP profile = riscv->profile;
+
+    // if the stack is empty (unexpected), start it from the calling function
+    if(!profile->depth) {
+        pushProfileRoot(riscv);
+    }
+
+    if(profile->depth) {
+
+        profileFrameP caller = &profile->stack[profile->depth-1];
+        profileArcP   arc    = getProfileArc(caller->fn, callee);
+
+        callee->calls++;
+        arc->calls++;
+
+        pushProfileFrame(riscv, callee, arc, linkPC);
+    }
+}
+
+//
+// Record a call to the function at the given target address (called from JIT
+// code for calls to register addresses, which usually repeat the previous
+// target)
+//
+void riscvProfileCall(riscvP riscv, Uns64 target, Uns64 linkPC) {
+
+    riscvProfileP profile = riscv->profile;
+
+    target &= -2;
+
+    if(!profile->lastFn || (profile->lastTarget!=target)) {
+        profile->lastTarget = target;
+        profile->lastFn     = getProfileFn(profile, target);
+    }
+
+    riscvProfileCallFn(riscv, profile->lastFn, linkPC);
+}
+
+//
+// Record a return to the given target address (called from JIT code)
+//
+void riscvProfileReturn(riscvP riscv, Uns64 target) {
+
+    riscvProfileP profile = riscv->profile;
+    Int32         i;
+
+    target &= -2;
+
+    // find the most recent frame returning to the target, ignoring the root
+    // frame (returns that match no frame are treated as simple jumps, which
+    // handles longjmp and context switches)
+    for(i=profile->depth-1; i>0; i--) {
+
+        if(profile->stack[i].retAddr==target) {
+
+            // pop this frame and any frames above it
+            while(profile->depth>i) {
+                popProfileFrame(riscv);
+            }
+
+            return;
+        }
+    }
+}
+
+//
+// Record entry to a trap handler at the given address, which is treated as a
+// call from the interrupted function (called on exception entry)
+//
+void riscvProfileTrap(riscvP riscv, Uns64 handler) {
+
+    riscvProfileP profile = riscv->profile;
+    Uns32         depth   = profile->depth;
+
+    // a return address of zero is never matched by a normal return
+    riscvProfileCall(riscv, handler, 0);
+
+    // mark the handler frame so that it is unwound by the trap return
+    if(profile->depth>depth) {
+        profile->stack[profile->depth-1].trap = True;
+    }
+}
+
+//
+// Record a return from a trap handler, unwinding frames up to and including
+// the most recent trap frame (called on exception return)
+//
+void riscvProfileTrapReturn(riscvP riscv) {
+
+    riscvProfileP profile = riscv->profile;
+    Int32         i;
+
+    // find the most recent trap frame, ignoring the root frame (a return with
+    // no trap frame, for example the initial switch to a less-privileged mode,
+    // is treated as a simple jump)
+    for(i=profile->depth-1; i>0; i--) {
+
+        if(profile->stack[i].trap) {
+
+            // pop this frame and any frames above it
+            while(profile->depth>i) {
+                popProfileFrame(riscv);
+            }
+
+            return;
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION AND DESTRUCTION
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Enable or disable function profiling
+//
+void riscvSetProfileActive(riscvP riscv, Bool enable) {
+
+    riscvProfileP profile = riscv->profile;
+    Bool          active  = (riscv->pmKey & PMK_PROFILE) != 0;
+
+    if(!profile) {
+
+        // no action if profiling structures are absent
+
+    } else {
+
+        // stack sampling follows the requested state
+        profile->sampling = enable;
+
+        if(!profile->callGraph) {
+
+            // shadow stack instrumentation is only required for call-graph
+            // profiling (samples unwind the frame pointer chain instead)
+
+        } else if(enable && !active) {
+
+            // flush dictionaries the first time profiling is enabled, so that
+            // blocks translated without profiling checks are retranslated
+            if(!riscv->useProfile) {
+                riscv->useProfile = True;
+                vmirtFlushAllDicts((vmiProcessorP)riscv);
+            }
+
+            // start a new shadow stack from the current function
+            riscv->pmKey |= PMK_PROFILE;
+            pushProfileRoot(riscv);
+
+        } else if(!enable && active) {
+
+            // attribute counts for all active functions
+            riscv->pmKey &= ~PMK_PROFILE;
+            popProfileAll(riscv);
+        }
+    }
+}
+
+//
+// Allocate function profiling structures and enable profiling
+//
+void riscvNewProfile(
+    riscvP      riscv,
+    const char *file,
+    Bool        callGraph,
+    Uns32       interval
+) {
+    riscvProfileP profile = STYPE_CALLOC(riscvProfile);
+
+    // save output file name and output options
+    profile->file      = STYPE_CALLOC_N(char, strlen(file)+1);
+    profile->callGraph = callGraph;
+    profile->interval  = interval;
+    strcpy(profile->file, file);
+
+    // allocate function lookup table
+    vmirtNewRangeTable(&profile->fnTable);
+
+    riscv->profile = profile;
+
+    // install profiling commands
+    vmirtAddCommandParse(
+        (vmiProcessorP)riscv,
+        "profileStart",
+        "start function profiling",
+        profileStartCommand,
+        VMI_CT_MODE|VMI_CO_DIAG|VMI_CA_CONTROL
+    );
+    vmirtAddCommandParse(
+        (vmiProcessorP)riscv,
+        "profileStop",
+        "stop function profiling",
+        profileStopCommand,
+        VMI_CT_MODE|VMI_CO_DIAG|VMI_CA_CONTROL
+    );
+    vmirtAddCommandParse(
+        (vmiProcessorP)riscv,
+        "profileReport",
+        "show flat function profile",
+        profileReportCommand,
+        VMI_CT_QUERY|VMI_CO_DIAG|VMI_CA_REPORT
+    );
+
+    // start stack sampling timer if required
+    if(interval) {
+        profile->sampleTimer = vmirtCreateModelTimer(
+            (vmiProcessorP)riscv, profileSampleCB, 1, 0
+        );
+        vmirtSetModelTimer(profile->sampleTimer, interval);
+    }
+
+    // enable profiling from the start
+    riscvSetProfileActive(riscv, True);
+}
+
+//
+// Write any function profile and free profiling structures
+//
+void riscvFreeProfile(riscvP riscv) {
+
+    riscvProfileP profile = riscv->profile;
+
+    if(profile) {
+
+        profileFnP fn;
+        profileFnP nextFn;
+        Uns32      i;
+
+        // attribute counts for active functions and write profile
+        popProfileAll(riscv);
+
+        if(profile->callGraph && profile->fnFirst) {
+            writeProfile(riscv);
+        }
+
+        // write stack samples
+        drainProfileSamples(profile);
+
+        if(profile->samples) {
+            writeSamples(riscv);
+        }
+
+        // free stack sampling timer
+        if(profile->sampleTimer) {
+            vmirtDeleteModelTimer(profile->sampleTimer);
+        }
+
+        // free stack samples
+        for(i=0; i<PROFILE_SAMPLE_HASH; i++) {
+
+            profileSampleP sample;
+            profileSampleP nextSample;
+
+            for(sample=profile->sampleTable[i]; sample; sample=nextSample) {
+                nextSample = sample->next;
+                STYPE_FREE(sample->addrs);
+                STYPE_FREE(sample);
+            }
+        }
+
+        // free function and arc statistics
+        for(fn=profile->fnFirst; fn; fn=nextFn) {
+
+            profileArcP arc;
+            profileArcP nextArc;
+
+            for(arc=fn->arcs; arc; arc=nextArc) {
+                nextArc = arc->next;
+                STYPE_FREE(arc);
+            }
+
+            nextFn = fn->next;
+            STYPE_FREE(fn);
+        }
+
+        vmirtFreeRangeTable(&profile->fnTable);
+        STYPE_FREE(profile->file);
+        STYPE_FREE(profile);
+
+        riscv->profile = 0;
+    }
+}
+
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+// basic types
+#include "hostapi/impTypes.h"
+
+// model header files
+#include "riscvTypeRefs.h"
+
+
+//
+// Opaque handle to statistics for one profiled function
+//
+typedef struct profileFnS *riscvProfileFnP;
+
+//
+// Allocate function profiling structures and enable profiling, with optional
+// callgrind output and optional stack sampling every interval instructions
+//
+void riscvNewProfile(
+    riscvP      riscv,
+    const char *file,
+    Bool        callGraph,
+    Uns32       interval
+);
+
+//
+// Write any function profile and free profiling structures
+//
+void riscvFreeProfile(riscvP riscv);
+
+//
+// Enable or disable function profiling
+//
+void riscvSetProfileActive(riscvP riscv, Bool enable);
+
+//
+// Return statistics for the function at the given target address, for use
+// with riscvProfileCallFn (called when a call to a constant address is
+// translated)
+//
+riscvProfileFnP riscvProfileGetFn(riscvP riscv, Uns64 target);
+
+//
+// Record a call to the given function (called from JIT code)
+//
+void riscvProfileCallFn(riscvP riscv, riscvProfileFnP callee, Uns64 linkPC);
+
+//
+// Record a call to the function at the given target address (called from JIT
+// code)
+//
+void riscvProfileCall(riscvP riscv, Uns64 target, Uns64 linkPC);
+
+//
+// Record a return to the given target address (called from JIT code)
+//
+void riscvProfileReturn(riscvP riscv, Uns64 target);
+
+//
+// Record entry to a trap handler at the given address, which is treated as a
+// call from the interrupted function (called on exception entry)
+//
+void riscvProfileTrap(riscvP riscv, Uns64 handler);
+
+//
+// Record a return from a trap handler, unwinding frames up to and including
+// the most recent trap frame (called on exception return)
+//
+void riscvProfileTrapReturn(riscvP riscv);
+
@@ -35,6 +35,7 @@
 #define RV_REG_X_RA      1
 #define RV_REG_X_SP      2
 #define RV_REG_X_GP      3
+#define RV_REG_X_S0      8
 
 // morph-time macros to calculate offsets to registers in a RISCV structure
 #define RISCV_CPU_OFFSET(_R)    VMI_CPU_OFFSET(riscvP, _R)
@@ -58,7 +59,14 @@
 #define RISCV_VACTIVE_MASK      RISCV_CPU_TEMP(vActiveMask)
 #define RISCV_VTMP              RISCV_CPU_TEMP(vTmp)
 #define RISCV_VSTATE            RISCV_CPU_TEMP(vState)
+#define RISCV_CACHE_VA          RISCV_CPU_TEMP(cacheVA)
+#define RISCV_CACHE_LINE        RISCV_CPU_REG(cacheLine)
+#define RISCV_CACHE_HITS        RISCV_CPU_REG(cacheHits)
+#define RISCV_BRANCH_MAP_BITS   RISCV_CPU_REG(branchMapBits)
+#define RISCV_BRANCH_MAP_NUM    RISCV_CPU_REG(branchMapNum)
 #define RISCV_FF                RISCV_CPU_REG(vFirstFault)
+#define RISCV_VZERO_PENDING     RISCV_CPU_REG(vZeroPending)
+#define RISCV_COSIM_VMASK       RISCV_CPU_REG(cosimVMask)
 #define RISCV_VLMAX             RISCV_CPU_TEMP(vlMax)
 #define RISCV_OFFSETS_LMULx2    RISCV_CPU_REG(offsetsLMULx2)
 #define RISCV_OFFSETS_LMULx4    RISCV_CPU_REG(offsetsLMULx4)
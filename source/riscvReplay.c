@@ -0,0 +1,407 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// standard header files
+#include <stdio.h>
+#include <string.h>
+
+// Imperas header files
+#include "hostapi/impAlloc.h"
+
+// VMI header files
+#include "vmi/vmiMessage.h"
+#include "vmi/vmiRt.h"
+
+// model header files
+#include "riscvMessage.h"
+#include "riscvParameters.h"
+#include "riscvReplay.h"
+#include "riscvStructure.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Stimulus log header
+//
+#define REPLAY_MAGIC    "RVSL"
+#define REPLAY_VERSION  1
+
+//
+// Stimulus record/replay state
+//
+typedef struct riscvReplayS {
+    FILE               *file;       // stimulus log
+    char               *path;       // stimulus log file name
+    Bool                replaying;  // whether replaying (otherwise recording)
+    Bool                nextValid;  // whether next replay event is valid
+    Uns32               portNum;    // number of input ports
+    riscvInterruptInfoP *ports;     // input ports by index
+    Uns64               events;     // number of events recorded or replayed
+    Uns64               lastTime;   // time of last event
+    Uns32               nextIndex;  // port index of next replay event
+    Uns32               nextValue;  // value of next replay event
+    vmiModelTimerP      timer;      // replay event timer
+} riscvReplay;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// LOG ENCODING
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Write ULEB128-encoded value to the stimulus log
+//
+static void putULEB(FILE *file, Uns64 value) {
+
+    do {
+
+        Uns8 byte = value & 0x7f;
+
+        value >>= 7;
+
+        if(value) {
+            byte |= 0x80;
+        }
+
+        fputc(byte, file);
+
+    } while(value);
+}
+
+//
+// Read ULEB128-encoded value from the stimulus log, returning False at end of
+// file
+//
+static Bool getULEB(FILE *file, Uns64 *value) {
+
+    Uns64 result = 0;
+    Uns32 shift  = 0;
+    Int32 byte;
+
+    do {
+
+        if(((byte=fgetc(file))==EOF) || (shift>=64)) {
+            return False;
+        }
+
+        result |= (Uns64)(byte & 0x7f) << shift;
+        shift  += 7;
+
+    } while(byte & 0x80);
+
+    *value = result;
+
+    return True;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// RECORD AND REPLAY
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return current time used for event timestamps (this is the instruction count
+// plus any cycles spent halted, so that events that wake a halted hart are
+// replayed at the same point as the model timer)
+//
+inline static Uns64 getReplayTime(riscvP riscv) {
+    return vmirtGetICount((vmiProcessorP)riscv);
+}
+
+//
+// Input port callback when recording or replaying: recorded events are logged
+// and passed to the port callback; live events are ignored when replaying
+//
+static VMI_NET_CHANGE_FN(replayNetCB) {
+
+    riscvInterruptInfoP ii     = userData;
+    riscvP              riscv  = ii->hart;
+    riscvReplayP        replay = riscv->replay;
+
+    if(!replay->replaying) {
+
+        Uns64 now = getReplayTime(riscv);
+
+        // log event as time delta, port index and value
+        putULEB(replay->file, now-replay->lastTime);
+        putULEB(replay->file, ii->index);
+        putULEB(replay->file, newValue);
+
+        replay->lastTime = now;
+        replay->events++;
+
+        ii->portCB(userData, newValue);
+    }
+}
+
+//
+// Read the next replay event
+//
+static void readEvent(riscvReplayP replay) {
+
+    Uns64 delta;
+    Uns64 index;
+    Uns64 value;
+
+    replay->nextValid = (
+        getULEB(replay->file, &delta) &&
+        getULEB(replay->file, &index) &&
+        getULEB(replay->file, &value)
+    );
+
+    if(replay->nextValid) {
+        replay->lastTime += delta;
+        replay->nextIndex = index;
+        replay->nextValue = value;
+    }
+}
+
+//
+// Schedule the replay timer for the next event
+//
+static void scheduleEvent(riscvP riscv, riscvReplayP replay) {
+
+    if(replay->nextValid) {
+
+        Uns64 now   = getReplayTime(riscv);
+        Uns64 delta = (replay->lastTime>now) ? replay->lastTime-now : 1;
+
+        vmirtSetModelTimer(replay->timer, delta);
+    }
+}
+
+//
+// Replay all events due at the current time and schedule the next event
+//
+static VMI_ICOUNT_FN(replayTimerCB) {
+
+    riscvP       riscv  = (riscvP)processor;
+    riscvReplayP replay = riscv->replay;
+    Uns64        now    = getReplayTime(riscv);
+
+    while(replay->nextValid && (replay->lastTime<=now)) {
+
+        if(replay->nextIndex<replay->portNum) {
+
+            riscvInterruptInfoP ii = replay->ports[replay->nextIndex];
+
+            ii->portCB(ii, replay->nextValue);
+            replay->events++;
+        }
+
+        readEvent(replay);
+    }
+
+    scheduleEvent(riscv, replay);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// CONSTRUCTION AND DESTRUCTION
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return True if the port is an input with a callback
+//
+inline static Bool isInputPort(riscvNetPortP port) {
+    return (port->desc.type==vmi_NP_INPUT) && port->desc.netChangeCB;
+}
+
+//
+// Return the number of input ports
+//
+static Uns32 getInputPortNum(riscvP riscv) {
+
+    riscvNetPortP this;
+    Uns32         result = 0;
+
+    for(this=riscv->netPorts; this; this=this->next) {
+        if(isInputPort(this)) {
+            result++;
+        }
+    }
+
+    return result;
+}
+
+//
+// Install the record/replay callback on all input ports
+//
+static void wrapInputPorts(riscvP riscv, riscvReplayP replay) {
+
+    riscvNetPortP this;
+    Uns32         i = 0;
+
+    replay->portNum = getInputPortNum(riscv);
+    replay->ports   = STYPE_CALLOC_N(riscvInterruptInfoP, replay->portNum);
+
+    // save original callbacks and install record/replay callback
+    for(this=riscv->netPorts; this; this=this->next) {
+
+        if(isInputPort(this)) {
+
+            this->ii.index  = i;
+            this->ii.portCB = this->desc.netChangeCB;
+
+            this->desc.netChangeCB = replayNetCB;
+
+            replay->ports[i++] = &this->ii;
+        }
+    }
+}
+
+//
+// Validate the stimulus log header, returning True if it matches this hart
+//
+static Bool readHeader(riscvP riscv, FILE *file, const char *path) {
+
+    char  magic[sizeof(REPLAY_MAGIC)-1];
+    Uns64 version = 0;
+    Uns64 portNum = 0;
+    Bool  ok      = (
+        (fread(magic, sizeof(magic), 1, file)==1) &&
+        !memcmp(magic, REPLAY_MAGIC, sizeof(magic)) &&
+        getULEB(file, &version) &&
+        (version==REPLAY_VERSION) &&
+        getULEB(file, &portNum) &&
+        (portNum==getInputPortNum(riscv))
+    );
+
+    if(!ok) {
+        vmiMessage("W", CPU_PREFIX"_SLH",
+            NO_SRCREF_FMT "Stimulus log '%s' does not match this hart - "
+            "replay disabled",
+            NO_SRCREF_ARGS(riscv), path
+        );
+    }
+
+    return ok;
+}
+
+//
+// Allocate stimulus record/replay structures if required (net ports must
+// already have been created)
+//
+void riscvNewReplay(riscvP riscv, riscvParamValuesP params) {
+
+    const char *record    = params->stimulus_record;
+    const char *play      = params->stimulus_replay;
+    Bool        replaying = play[0];
+    const char *file      = replaying ? play : record;
+
+    if(replaying && record[0]) {
+        vmiMessage("W", CPU_PREFIX"_SLRR",
+            NO_SRCREF_FMT "Both 'stimulus_record' and 'stimulus_replay' "
+            "specified - stimulus is not recorded",
+            NO_SRCREF_ARGS(riscv)
+        );
+    }
+
+    if(file[0]) {
+
+        const char *name = vmirtProcessorName((vmiProcessorP)riscv);
+        Uns32       len  = strlen(file) + strlen(name) + 2;
+        char       *path = STYPE_CALLOC_N(char, len);
+        FILE       *log;
+
+        // construct per-hart file name
+        snprintf(path, len, "%s.%s", file, name);
+
+        if(!(log=fopen(path, replaying ? "rb" : "wb"))) {
+
+            vmiMessage("W", CPU_PREFIX"_SLO",
+                NO_SRCREF_FMT "Cannot open stimulus log '%s'",
+                NO_SRCREF_ARGS(riscv), path
+            );
+
+            STYPE_FREE(path);
+
+        } else if(replaying && !readHeader(riscv, log, path)) {
+
+            fclose(log);
+            STYPE_FREE(path);
+
+        } else {
+
+            riscvReplayP replay = STYPE_CALLOC(riscvReplay);
+
+            replay->file      = log;
+            replay->path      = path;
+            replay->replaying = replaying;
+
+            riscv->replay = replay;
+
+            wrapInputPorts(riscv, replay);
+
+            if(!replaying) {
+
+                // write header
+                fwrite(REPLAY_MAGIC, sizeof(REPLAY_MAGIC)-1, 1, log);
+                putULEB(log, REPLAY_VERSION);
+                putULEB(log, replay->portNum);
+
+            } else {
+
+                // schedule the first event
+                replay->timer = vmirtCreateModelTimer(
+                    (vmiProcessorP)riscv, replayTimerCB, 1, 0
+                );
+
+                readEvent(replay);
+                scheduleEvent(riscv, replay);
+            }
+        }
+    }
+}
+
+//
+// Close any stimulus log and free stimulus record/replay structures
+//
+void riscvFreeReplay(riscvP riscv) {
+
+    riscvReplayP replay = riscv->replay;
+
+    if(replay) {
+
+        fclose(replay->file);
+
+        if(replay->timer) {
+            vmirtDeleteModelTimer(replay->timer);
+        }
+
+        if(riscv->verbose) {
+            vmiMessage("I", CPU_PREFIX"_SLE",
+                NO_SRCREF_FMT FMT_64u" stimulus events %s '%s'",
+                NO_SRCREF_ARGS(riscv), replay->events,
+                replay->replaying ? "replayed from" : "recorded to",
+                replay->path
+            );
+        }
+
+        STYPE_FREE(replay->ports);
+        STYPE_FREE(replay->path);
+        STYPE_FREE(replay);
+
+        riscv->replay = 0;
+    }
+}
+
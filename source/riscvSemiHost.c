@@ -53,6 +53,7 @@ inline static Uns32 getRegBits(riscvP riscv) {
 // Morph return from an opaque intercepted function
 //
 VMI_INT_RETURN_FN(riscvIntReturn) {
+    riscvEmitProfileReturn((riscvP)processor, RISCV_LR);
     vmimtUncondJumpReg(0, RISCV_LR, VMI_NOREG, vmi_JH_RETURN);
 }
 
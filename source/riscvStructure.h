@@ -76,6 +76,22 @@ typedef struct riscvNetValueS {
     Bool _u2;           // (for alignment)
 } riscvNetValue;
 
+//
+// State of a multi-instruction step in progress (Debug mode)
+//
+typedef struct riscvMultiStepS {
+    Uns64                remaining;     // steps remaining (0 if no step limit)
+    Uns64                base;          // instruction count when timer armed
+    Uns64                stopPC;        // stop address (if stopPCValid)
+    riscvDebugStepCondFn condition;     // stop condition (if any)
+    void                *userData;      // stop condition client data
+    Bool                 active;        // whether step is in progress
+    Bool                 useStopPC;     // whether this step stops at stopPC
+    Bool                 stopPCValid;   // whether translated code checks stopPC
+    Bool                 WFIEnable;     // interrupts enabled after WFI
+    Bool                 _u1[4];        // (for alignment)
+} riscvMultiStep, *riscvMultiStepP;
+
 //
 // Container for PMP configuration registers
 //
@@ -120,8 +136,10 @@ typedef struct riscvBasicIntStateS {
 // This holds processor and vector information for an interrupt
 //
 typedef struct riscvInterruptInfoS {
-    riscvP hart;
-    Uns32  userData;
+    riscvP         hart;
+    Uns32          userData;
+    Uns32          index;       // port index (stimulus record/replay)
+    vmiNetChangeFn portCB;      // port callback (stimulus record/replay)
 } riscvInterruptInfo, *riscvInterruptInfoP;
 
 //
@@ -179,6 +197,7 @@ typedef struct riscvS {
     Bool               externalActive:1;// whether external CSR access active
     Bool               inSaveRestore :1;// is save/restore active?
     Bool               useTMode      :1;// has transaction mode been enabled?
+    Bool               useProfile    :1;// has function profiling been enabled?
     Bool               rmCheckValid  :1;// whether RM valid check required
     Bool               checkEndian   :1;// whether endian check required
     riscvVTypeFmt      vtypeFormat   :1;// vtype format (vector extension)
@@ -198,7 +217,14 @@ typedef struct riscvS {
     memEndian          dendian;         // data endianness
     memEndian          iendian;         // instruction endianness
     Uns64              jumpBase;        // address of jump instruction
+    Uns64              cacheVA;         // cache model access address
+    Uns64              cacheLine;       // last data cache line accessed
+    Uns64              cacheHits;       // data accesses filtered in JIT code
+    Uns32              branchMapBits;   // pending branch trace outcome bits
+    Uns32              branchMapNum;    // number of pending outcome bits
     Uns32              writtenXMask;    // mask of written X registers
+    Uns32              writtenFMask;    // mask of written F registers
+    Uns32              cosimVMask;      // V registers possibly written
 
     // Configuration and parameter definitions
     riscvParamValuesP  paramValues;     // specified parameters (construction only)
@@ -223,6 +249,7 @@ typedef struct riscvS {
     // LR/SC support
     Uns64              exclusiveTag;    // tag for active exclusive access
     Uns64              exclusiveTagMask;// mask for active exclusive access
+    memDomainP         exclusiveDomain; // domain of exclusive access monitor
 
     // Counter/timer support
     Uns64              baseCycles;      // base cycle count
@@ -230,6 +257,18 @@ typedef struct riscvS {
 
     // Debug
     vmiRegInfoP        regInfo[2];      // register views (normal and debug)
+    riscvTriggerP      trigger;         // debug trigger state
+    riscvRegGroupsP    regGroups;       // register group bulk access index
+
+    // Profiling
+    riscvProfileP      profile;         // function profiling state
+    riscvCacheP        cache;           // cache model state
+    riscvBranchP       branch;          // branch trace and predictor state
+    riscvCosimP        cosim;           // co-simulation state
+    riscvReplayP       replay;          // stimulus record/replay state
+    riscvFaultP        fault;           // fault injection campaign state
+    riscvMorphStatsP   morphStats;      // translation statistics
+    riscvOpcodeMixP    opcodeMix;       // dynamic opcode mix
 
     // Parameters
     vmiEnumParameterP  variantList;     // supported variants
@@ -251,6 +290,7 @@ typedef struct riscvS {
 
     // Timers
     vmiModelTimerP     stepTimer;       // Debug mode single-step timer
+    riscvMultiStep     multiStep;       // Debug mode multi-instruction step
 
     // CSR support
     vmiRangeTableP     csrTable;        // per-CSR lookup table
@@ -289,6 +329,11 @@ typedef struct riscvS {
     Uns64              vTmp;                 	// vector operation temporary
     UnsPS              vBase[NUM_BASE_REGS];  	// indexed base registers
     Uns32             *v;                     	// vector registers (configurable size)
+    Uns8              *vKernelBuffer;         	// whole-register kernel results
+    Uns32              vKernelHostFP;         	// simulator host FP environment
+    Bool               vKernelHostValid;      	// is vKernelHostFP valid?
+    Uns32              vZeroPending;          	// registers with deferred tail zero
+    Uns16              vZeroFrom[VREG_NUM];   	// deferred tail zero byte offsets
 
 } riscv;
 
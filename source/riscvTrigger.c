@@ -0,0 +1,1141 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+// standard header files
+#include <string.h>
+
+// Imperas header files
+#include "hostapi/impAlloc.h"
+
+// VMI header files
+#include "vmi/vmiRt.h"
+
+// model header files
+#include "riscvExceptions.h"
+#include "riscvStructure.h"
+#include "riscvTrigger.h"
+#include "riscvUtils.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// TYPES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Supported trigger types (tdata1.type)
+//
+typedef enum triggerTypeE {
+    TT_NONE     = 0,            // no trigger
+    TT_MCONTROL = 2,            // address/data match trigger
+    TT_ICOUNT   = 3,            // instruction count trigger
+    TT_ITRIGGER = 4,            // interrupt trigger
+    TT_ETRIGGER = 5,            // exception trigger
+} triggerType;
+
+//
+// Supported mcontrol match types (tdata1.match)
+//
+typedef enum triggerMatchE {
+    TM_EQ,                      // value equals tdata2
+    TM_NAPOT,                   // top bits of value match tdata2
+    TM_GE,                      // value greater than or equal to tdata2
+    TM_LT,                      // value less than tdata2
+    TM_LAST                     // KEEP LAST: for sizing
+} triggerMatch;
+
+//
+// Trigger actions (tdata1.action)
+//
+typedef enum triggerActionE {
+    TA_BREAKPOINT,              // raise breakpoint exception
+    TA_DEBUG,                   // enter Debug mode
+} triggerAction;
+
+//
+// Field positions in tdata1 that do not depend on XLEN
+//
+#define MC_LOAD         0
+#define MC_STORE        1
+#define MC_EXECUTE      2
+#define MC_MODES        3
+#define MC_MATCH        7
+#define MC_ACTION       12
+#define MC_TIMING       18
+#define MC_SELECT       19
+#define MC_HIT          20
+#define IC_MODES        6
+#define IC_COUNT        10
+#define IC_HIT          24
+
+//
+// Field positions in tdata1 relative to XLEN
+//
+#define TD1_TYPE(_XLEN)     ((_XLEN)-4)
+#define TD1_DMODE(_XLEN)    ((_XLEN)-5)
+#define TD1_IEHIT(_XLEN)    ((_XLEN)-6)
+#define TD1_MASKMAX(_XLEN)  ((_XLEN)-11)
+
+//
+// Extract a field from a tdata1 value
+//
+#define TD1_FIELD(_V, _SHIFT, _BITS) (((_V)>>(_SHIFT)) & ((1ULL<<(_BITS))-1))
+
+//
+// One trigger
+//
+typedef struct triggerS {
+    triggerType   type;         // trigger type
+    triggerMatch  match;        // match type (mcontrol)
+    triggerAction action;       // action when trigger fires
+    Uns8          modes;        // enabled modes (bitmask of 1<<riscvMode)
+    Bool          dmode;        // only writable in Debug mode
+    Bool          hit;          // trigger has fired
+    Bool          select;       // match data rather than address (mcontrol)
+    Bool          load;         // match loads (mcontrol)
+    Bool          store;        // match stores (mcontrol)
+    Bool          execute;      // match instruction execution (mcontrol)
+    Bool          counting;     // instruction count active (icount)
+    Uns32         count;        // remaining instructions (icount)
+    Uns64         tdata2;       // match value or cause mask
+} trigger, *triggerP;
+
+//
+// One installed memory watch range
+//
+typedef struct triggerWatchS {
+    memDomainP domain;          // watched domain
+    Uns64      low;             // low address
+    Uns64      high;            // high address
+    Bool       isStore;         // whether write callback
+} triggerWatch, *triggerWatchP;
+
+//
+// Debug trigger state
+//
+typedef struct riscvTriggerS {
+    triggerP       triggers;    // implemented triggers
+    Uns32          num;         // number of implemented triggers
+    Uns32          tselect;     // selected trigger
+    triggerWatchP  watches;     // installed memory watches
+    Uns32          watchNum;    // number of installed memory watches
+    Uns32          watchMax;    // size of watch table
+    vmiModelTimerP icountTimer; // instruction count trigger timer
+    Uns64          icountBase;  // instruction count when timer was set
+    Bool           pending;     // whether a trigger action is pending
+    triggerAction  pendAction;  // pending action
+    Uns64          pendTval;    // pending breakpoint trap value
+} riscvTrigger;
+
+
+////////////////////////////////////////////////////////////////////////////////
+// UTILITIES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Return the currently-selected trigger
+//
+inline static triggerP getSelected(riscvTriggerP tr) {
+    return &tr->triggers[tr->tselect];
+}
+
+//
+// Is the trigger enabled in the given mode?
+//
+inline static Bool enabledInMode(triggerP t, riscvMode mode) {
+    return t->modes & (1<<mode);
+}
+
+//
+// Return the mask of modes that may be enabled for a trigger
+//
+static Uns8 getValidModes(riscvP riscv) {
+
+    Uns8 result = 1<<RISCV_MODE_M;
+
+    if(riscvHasMode(riscv, RISCV_MODE_S)) {
+        result |= 1<<RISCV_MODE_S;
+    }
+    if(riscvHasMode(riscv, RISCV_MODE_U)) {
+        result |= 1<<RISCV_MODE_U;
+    }
+
+    return result;
+}
+
+//
+// Compose mode enable bits u/s/m, which are at offsets 0, 1 and 3 from shift
+//
+inline static Uns64 composeModes(triggerP t, Uns32 shift) {
+    return (Uns64)t->modes << shift;
+}
+
+//
+// Extract mode enable bits u/s/m, which are at offsets 0, 1 and 3 from shift
+//
+inline static Uns8 extractModes(riscvP riscv, Uns64 value, Uns32 shift) {
+    return (value>>shift) & getValidModes(riscv);
+}
+
+//
+// Return the address mask for the current XLEN
+//
+inline static Uns64 getXLENMask(riscvP riscv) {
+
+    Uns32 XLEN = riscvGetXlenMode(riscv);
+
+    return (XLEN==64) ? -1 : ((1ULL<<XLEN)-1);
+}
+
+//
+// Does the value match an mcontrol trigger?
+//
+static Bool matchValue(triggerP t, Uns64 value) {
+
+    Uns64 tdata2 = t->tdata2;
+
+    switch(t->match) {
+
+        case TM_EQ:
+            return value==tdata2;
+
+        case TM_NAPOT: {
+            Uns64 mask = tdata2 ^ (tdata2+1);
+            return (value & ~mask) == (tdata2 & ~mask);
+        }
+
+        case TM_GE:
+            return value>=tdata2;
+
+        case TM_LT:
+            return value<tdata2;
+
+        default:
+            return False;
+    }
+}
+
+//
+// Get the address range matched by an mcontrol trigger, returning False if
+// no address can match
+//
+static Bool getMatchRange(triggerP t, Uns64 mask, Uns64 *lowP, Uns64 *highP) {
+
+    Uns64 tdata2 = t->tdata2;
+
+    if(t->select) {
+
+        // data value triggers must watch all addresses
+        *lowP  = 0;
+        *highP = mask;
+
+    } else if(t->match==TM_EQ) {
+
+        *lowP  = tdata2;
+        *highP = tdata2;
+
+    } else if(t->match==TM_NAPOT) {
+
+        Uns64 napot = tdata2 ^ (tdata2+1);
+
+        *lowP  = tdata2 & ~napot;
+        *highP = tdata2 | napot;
+
+    } else if(t->match==TM_GE) {
+
+        *lowP  = tdata2;
+        *highP = mask;
+
+    } else if(tdata2) {
+
+        *lowP  = 0;
+        *highP = tdata2-1;
+
+    } else {
+
+        return False;
+    }
+
+    // clamp range to addressable region
+    if(*lowP>mask) {
+        return False;
+    } else if(*highP>mask) {
+        *highP = mask;
+    }
+
+    return True;
+}
+
+//
+// Does the trigger match loads or stores?
+//
+inline static Bool isDataTrigger(triggerP t) {
+    return (t->type==TT_MCONTROL) && (t->load || t->store) && t->modes;
+}
+
+//
+// Does the trigger match instruction execution?
+//
+inline static Bool isExecuteTrigger(triggerP t) {
+    return (t->type==TT_MCONTROL) && t->execute && t->modes;
+}
+
+//
+// Does the execute trigger match the instruction in the given mode?
+//
+static Bool matchExecute(
+    triggerP  t,
+    riscvMode mode,
+    Uns64     thisPC,
+    Uns32     instruction
+) {
+    return (
+        isExecuteTrigger(t) &&
+        enabledInMode(t, mode) &&
+        matchValue(t, t->select ? instruction : thisPC)
+    );
+}
+
+//
+// Mark an action pending, to be taken before the next instruction fetch
+// (only the first action is recorded)
+//
+static void setPending(riscvP riscv, triggerP t, Uns64 tval) {
+
+    riscvTriggerP tr = riscv->trigger;
+
+    t->hit = True;
+
+    if(!tr->pending) {
+
+        tr->pending    = True;
+        tr->pendAction = t->action;
+        tr->pendTval   = tval;
+
+        vmirtDoSynchronousInterrupt((vmiProcessorP)riscv);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// LOAD/STORE TRIGGERS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Handle a watched load or store
+//
+static void doDataWatch(
+    riscvP      riscv,
+    Uns64       VA,
+    Uns32       bytes,
+    const void *value,
+    Bool        isStore
+) {
+    riscvTriggerP tr    = riscv->trigger;
+    riscvMode     mode  = getCurrentMode(riscv);
+    Uns64         data  = 0;
+    Uns64         last  = VA+bytes-1;
+    Uns32         i;
+
+    // get data value for data triggers (least-significant 64 bits)
+    if(value) {
+        memcpy(&data, value, (bytes>8) ? 8 : bytes);
+    }
+
+    for(i=0; i<tr->num; i++) {
+
+        triggerP t = &tr->triggers[i];
+        Uns64    low;
+        Uns64    high;
+
+        if(!isDataTrigger(t) || !enabledInMode(t, mode)) {
+            // trigger not active
+        } else if(isStore ? !t->store : !t->load) {
+            // access type does not match
+        } else if(t->select) {
+            if(value && matchValue(t, data)) {
+                setPending(riscv, t, VA);
+            }
+        } else if(!getMatchRange(t, -1, &low, &high)) {
+            // no address can match
+        } else if((VA<=high) && (last>=low)) {
+            setPending(riscv, t, VA);
+        }
+    }
+}
+
+//
+// Load watch callback
+//
+static VMI_MEM_WATCH_FN(triggerLoadCB) {
+
+    riscvP riscv = userData;
+
+    if(((vmiProcessorP)riscv==processor) && !inDebugMode(riscv)) {
+        doDataWatch(riscv, VA, bytes, value, False);
+    }
+}
+
+//
+// Store watch callback
+//
+static VMI_MEM_WATCH_FN(triggerStoreCB) {
+
+    riscvP riscv = userData;
+
+    if(((vmiProcessorP)riscv==processor) && !inDebugMode(riscv)) {
+        doDataWatch(riscv, VA, bytes, value, True);
+    }
+}
+
+//
+// Remove all installed memory watches
+//
+static void removeWatches(riscvP riscv) {
+
+    riscvTriggerP tr = riscv->trigger;
+    Uns32         i;
+
+    for(i=0; i<tr->watchNum; i++) {
+
+        triggerWatchP w = &tr->watches[i];
+
+        if(w->isStore) {
+            vmirtRemoveWriteCallback(
+                w->domain, 0, w->low, w->high, triggerStoreCB, riscv
+            );
+        } else {
+            vmirtRemoveReadCallback(
+                w->domain, 0, w->low, w->high, triggerLoadCB, riscv
+            );
+        }
+    }
+
+    tr->watchNum = 0;
+}
+
+//
+// Install one memory watch
+//
+static void addWatch(
+    riscvP     riscv,
+    memDomainP domain,
+    Uns64      low,
+    Uns64      high,
+    Bool       isStore
+) {
+    riscvTriggerP tr = riscv->trigger;
+    triggerWatchP w;
+
+    // extend watch table if required
+    if(tr->watchNum==tr->watchMax) {
+        tr->watchMax = tr->watchMax ? tr->watchMax*2 : 8;
+        tr->watches  = STYPE_REALLOC(tr->watches, triggerWatch, tr->watchMax);
+    }
+
+    w = &tr->watches[tr->watchNum++];
+
+    w->domain  = domain;
+    w->low     = low;
+    w->high    = high;
+    w->isStore = isStore;
+
+    if(isStore) {
+        vmirtAddWriteCallback(domain, 0, low, high, triggerStoreCB, riscv);
+    } else {
+        vmirtAddReadCallback(domain, 0, low, high, triggerLoadCB, riscv);
+    }
+}
+
+//
+// Return the distinct data domains that can be used by explicit loads and
+// stores, returning the number of domains
+//
+static Uns32 getDataDomains(riscvP riscv, memDomainP domains[]) {
+
+    Uns32 num = 0;
+    Uns32 mode;
+
+    for(mode=0; mode<RISCV_MODE_LAST; mode++) {
+
+        memDomainP candidates[2] = {
+            riscv->physDomains[mode][0], riscv->vmDomains[mode][0]
+        };
+        Uns32      i;
+
+        for(i=0; i<2; i++) {
+
+            memDomainP domain = candidates[i];
+            Uns32      j;
+
+            for(j=0; domain && (j<num); j++) {
+                if(domains[j]==domain) {
+                    domain = 0;
+                }
+            }
+
+            if(domain) {
+                domains[num++] = domain;
+            }
+        }
+    }
+
+    return num;
+}
+
+//
+// Reinstall memory watches for all load and store triggers; each access is
+// checked against the trigger only when it hits a watched range, so accesses
+// elsewhere run at full speed
+//
+static void refreshWatches(riscvP riscv) {
+
+    riscvTriggerP tr = riscv->trigger;
+    memDomainP    domains[RISCV_MODE_LAST*2];
+    Uns32         domainNum;
+    Uns32         i;
+
+    // remove existing watches
+    removeWatches(riscv);
+
+    // get data domains
+    domainNum = getDataDomains(riscv, domains);
+
+    for(i=0; i<tr->num; i++) {
+
+        triggerP t = &tr->triggers[i];
+
+        if(isDataTrigger(t)) {
+
+            Uns32 j;
+
+            for(j=0; j<domainNum; j++) {
+
+                memDomainP domain = domains[j];
+                Uns32      bits   = vmirtGetDomainAddressBits(domain);
+                Uns64      mask   = (bits==64) ? -1 : ((1ULL<<bits)-1);
+                Uns64      low;
+                Uns64      high;
+
+                if(getMatchRange(t, mask, &low, &high)) {
+
+                    if(t->load) {
+                        addWatch(riscv, domain, low, high, False);
+                    }
+                    if(t->store) {
+                        addWatch(riscv, domain, low, high, True);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// INSTRUCTION COUNT TRIGGERS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Update remaining counts of active instruction count triggers with the
+// number of instructions executed since the timer was set, returning a mask
+// of triggers that have reached zero
+//
+static Uns32 syncICount(riscvP riscv) {
+
+    riscvTriggerP tr      = riscv->trigger;
+    Uns64         now     = vmirtGetICount((vmiProcessorP)riscv);
+    Uns64         elapsed = now - tr->icountBase;
+    Uns32         expired = 0;
+    Uns32         i;
+
+    for(i=0; i<tr->num; i++) {
+
+        triggerP t = &tr->triggers[i];
+
+        if(t->counting) {
+
+            t->count = (elapsed>=t->count) ? 0 : t->count-elapsed;
+
+            if(!t->count) {
+                expired |= 1<<i;
+            }
+        }
+    }
+
+    tr->icountBase = now;
+
+    return expired;
+}
+
+//
+// Restart the instruction count timer for triggers enabled in the current
+// mode
+//
+static void restartICount(riscvP riscv) {
+
+    riscvTriggerP tr    = riscv->trigger;
+    riscvMode     mode  = getCurrentMode(riscv);
+    Bool          DM    = inDebugMode(riscv);
+    Uns32         delta = 0;
+    Uns32         i;
+
+    for(i=0; i<tr->num; i++) {
+
+        triggerP t = &tr->triggers[i];
+
+        t->counting = (
+            (t->type==TT_ICOUNT) && t->count && !DM && enabledInMode(t, mode)
+        );
+
+        if(t->counting && (!delta || (t->count<delta))) {
+            delta = t->count;
+        }
+    }
+
+    if(delta) {
+        vmirtSetModelTimer(tr->icountTimer, delta);
+    } else {
+        vmirtClearModelTimer(tr->icountTimer);
+    }
+}
+
+//
+// Update instruction count triggers, marking an action pending for any that
+// have reached zero
+//
+static void updateICount(riscvP riscv) {
+
+    riscvTriggerP tr      = riscv->trigger;
+    Uns32         expired = syncICount(riscv);
+    Uns32         i;
+
+    for(i=0; expired; i++, expired>>=1) {
+        if(expired&1) {
+            setPending(riscv, &tr->triggers[i], 0);
+        }
+    }
+
+    restartICount(riscv);
+}
+
+//
+// Instruction count trigger timer callback
+//
+static VMI_ICOUNT_FN(triggerICountCB) {
+    updateICount((riscvP)processor);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// TRIGGER REGISTER ACCESS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Compose tdata1 value for a trigger
+//
+static Uns64 composeTData1(riscvP riscv, triggerP t) {
+
+    Uns32 XLEN   = riscvGetXlenMode(riscv);
+    Uns64 result = (
+        ((Uns64)t->type  << TD1_TYPE(XLEN)) |
+        ((Uns64)t->dmode << TD1_DMODE(XLEN))
+    );
+
+    if(t->type==TT_MCONTROL) {
+
+        result |= (
+            ((Uns64)(XLEN-1)   << TD1_MASKMAX(XLEN)) |
+            ((Uns64)t->hit     << MC_HIT)            |
+            ((Uns64)t->select  << MC_SELECT)         |
+            ((Uns64)t->action  << MC_ACTION)         |
+            ((Uns64)t->match   << MC_MATCH)          |
+            composeModes(t, MC_MODES)                |
+            ((Uns64)t->execute << MC_EXECUTE)        |
+            ((Uns64)t->store   << MC_STORE)          |
+            ((Uns64)t->load    << MC_LOAD)
+        );
+
+        // timing is 1 (after) for load and store triggers and 0 (before)
+        // for execute triggers
+        if(!t->execute && (t->load || t->store)) {
+            result |= 1ULL<<MC_TIMING;
+        }
+
+    } else if(t->type==TT_ICOUNT) {
+
+        result |= (
+            ((Uns64)t->hit   << IC_HIT)   |
+            ((Uns64)t->count << IC_COUNT) |
+            composeModes(t, IC_MODES)     |
+            t->action
+        );
+
+    } else {
+
+        result |= (
+            ((Uns64)t->hit << TD1_IEHIT(XLEN)) |
+            composeModes(t, IC_MODES)          |
+            t->action
+        );
+    }
+
+    return result & getXLENMask(riscv);
+}
+
+//
+// Return legalized action
+//
+inline static triggerAction getAction(triggerP t, Uns32 action) {
+    return (action==TA_DEBUG) && t->dmode ? TA_DEBUG : TA_BREAKPOINT;
+}
+
+//
+// Update trigger from tdata1 value (WARL fields are legalized)
+//
+static void writeTData1(riscvP riscv, triggerP t, Uns64 value) {
+
+    Uns32       XLEN   = riscvGetXlenMode(riscv);
+    triggerType type   = TD1_FIELD(value, TD1_TYPE(XLEN), 4);
+    Uns64       tdata2 = t->tdata2;
+    Uns32       match;
+
+    // unsupported types revert to a disabled address/data match trigger, so
+    // that debuggers enumerating triggers always find them
+    if((type<TT_MCONTROL) || (type>TT_ETRIGGER)) {
+        type  = TT_MCONTROL;
+        value = 0;
+    }
+
+    // clear all fields except tdata2
+    memset(t, 0, sizeof(*t));
+
+    t->type   = type;
+    t->tdata2 = tdata2;
+
+    // dmode is writable only in Debug mode
+    if(riscv->configInfo.debug_mode && inDebugMode(riscv)) {
+        t->dmode = TD1_FIELD(value, TD1_DMODE(XLEN), 1);
+    }
+
+    if(type==TT_MCONTROL) {
+
+        match = TD1_FIELD(value, MC_MATCH, 4);
+
+        t->hit     = TD1_FIELD(value, MC_HIT,     1);
+        t->select  = TD1_FIELD(value, MC_SELECT,  1);
+        t->action  = getAction(t, TD1_FIELD(value, MC_ACTION, 4));
+        t->match   = (match<TM_LAST) ? match : TM_EQ;
+        t->modes   = extractModes(riscv, value, MC_MODES);
+        t->execute = TD1_FIELD(value, MC_EXECUTE, 1);
+        t->store   = TD1_FIELD(value, MC_STORE,   1);
+        t->load    = TD1_FIELD(value, MC_LOAD,    1);
+
+    } else if(type==TT_ICOUNT) {
+
+        t->hit    = TD1_FIELD(value, IC_HIT,   1);
+        t->count  = TD1_FIELD(value, IC_COUNT, 14);
+        t->action = getAction(t, TD1_FIELD(value, 0, 6));
+        t->modes  = extractModes(riscv, value, IC_MODES);
+
+    } else {
+
+        t->hit    = TD1_FIELD(value, TD1_IEHIT(XLEN), 1);
+        t->action = getAction(t, TD1_FIELD(value, 0, 6));
+        t->modes  = extractModes(riscv, value, IC_MODES);
+    }
+}
+
+//
+// Has the set of instructions matched by execute triggers changed?
+//
+static Bool executeChanged(triggerP old, triggerP new) {
+
+    if(!isExecuteTrigger(old) && !isExecuteTrigger(new)) {
+        return False;
+    } else {
+        return (
+            (isExecuteTrigger(old) != isExecuteTrigger(new)) ||
+            (old->modes            != new->modes)            ||
+            (old->match            != new->match)            ||
+            (old->select           != new->select)           ||
+            (old->tdata2           != new->tdata2)
+        );
+    }
+}
+
+//
+// Has the set of addresses watched by load/store triggers changed?
+//
+static Bool dataChanged(triggerP old, triggerP new) {
+
+    if(!isDataTrigger(old) && !isDataTrigger(new)) {
+        return False;
+    } else {
+        return (
+            (old->load   != new->load)   ||
+            (old->store  != new->store)  ||
+            (old->modes  != new->modes)  ||
+            (old->match  != new->match)  ||
+            (old->select != new->select) ||
+            (old->tdata2 != new->tdata2)
+        );
+    }
+}
+
+//
+// Refresh derived state after a trigger has been modified
+//
+static void refreshTrigger(riscvP riscv, triggerP old, triggerP new) {
+
+    // execute triggers are compiled into translated code, so code translated
+    // with the old configuration must be discarded (writes that change only
+    // hit, action or load/store fields do not affect translated code)
+    if(executeChanged(old, new)) {
+        vmirtFlushAllDicts((vmiProcessorP)riscv);
+    }
+
+    // reinstall memory watches if load/store triggers have changed
+    if(dataChanged(old, new)) {
+        refreshWatches(riscv);
+    }
+
+    // restart instruction count triggers
+    restartICount(riscv);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// PUBLIC INTERFACE
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Allocate debug trigger structures if required
+//
+void riscvNewTrigger(riscvP riscv) {
+
+    Uns32 num = riscv->configInfo.trigger_num;
+
+    if(num) {
+
+        riscvTriggerP tr = STYPE_CALLOC(riscvTrigger);
+
+        tr->num         = num;
+        tr->triggers    = STYPE_CALLOC_N(trigger, num);
+        tr->icountTimer = vmirtCreateModelTimer(
+            (vmiProcessorP)riscv, triggerICountCB, 1, 0
+        );
+
+        riscv->trigger = tr;
+    }
+}
+
+//
+// Free debug trigger structures
+//
+void riscvFreeTrigger(riscvP riscv) {
+
+    riscvTriggerP tr = riscv->trigger;
+
+    if(tr) {
+
+        removeWatches(riscv);
+
+        vmirtDeleteModelTimer(tr->icountTimer);
+
+        STYPE_FREE(tr->watches);
+        STYPE_FREE(tr->triggers);
+        STYPE_FREE(tr);
+
+        riscv->trigger = 0;
+    }
+}
+
+//
+// Reset all triggers
+//
+void riscvTriggerReset(riscvP riscv) {
+
+    riscvTriggerP tr = riscv->trigger;
+
+    if(tr) {
+
+        Bool  flush = False;
+        Uns32 i;
+
+        for(i=0; i<tr->num; i++) {
+
+            triggerP t = &tr->triggers[i];
+
+            flush |= isExecuteTrigger(t);
+
+            memset(t, 0, sizeof(*t));
+
+            t->type = TT_MCONTROL;
+        }
+
+        if(flush) {
+            vmirtFlushAllDicts((vmiProcessorP)riscv);
+        }
+
+        tr->tselect = 0;
+        tr->pending = False;
+
+        removeWatches(riscv);
+
+        // restart instruction count timer from the current instruction count
+        syncICount(riscv);
+        restartICount(riscv);
+    }
+}
+
+//
+// Read tselect
+//
+Uns64 riscvTriggerReadTSelect(riscvP riscv) {
+    return riscv->trigger->tselect;
+}
+
+//
+// Write tselect (values selecting unimplemented triggers are ignored)
+//
+Uns64 riscvTriggerWriteTSelect(riscvP riscv, Uns64 newValue) {
+
+    riscvTriggerP tr = riscv->trigger;
+
+    if(newValue<tr->num) {
+        tr->tselect = newValue;
+    }
+
+    return tr->tselect;
+}
+
+//
+// Read tdata1-tdata3 for the selected trigger (index 1-3)
+//
+Uns64 riscvTriggerReadTData(riscvP riscv, Uns32 index) {
+
+    riscvTriggerP tr = riscv->trigger;
+    triggerP      t  = getSelected(tr);
+
+    // bring instruction count up to date
+    if(t->counting) {
+        updateICount(riscv);
+    }
+
+    if(index==1) {
+        return composeTData1(riscv, t);
+    } else if(index==2) {
+        return t->tdata2 & getXLENMask(riscv);
+    } else {
+        return 0;
+    }
+}
+
+//
+// Write tdata1-tdata3 for the selected trigger (index 1-3)
+//
+Uns64 riscvTriggerWriteTData(riscvP riscv, Uns32 index, Uns64 newValue) {
+
+    riscvTriggerP tr = riscv->trigger;
+    triggerP      t  = getSelected(tr);
+    trigger       old;
+
+    // bring instruction counts of all triggers up to date, so that the timer
+    // is restarted from the current instruction count after the write
+    updateICount(riscv);
+    old = *t;
+
+    // triggers owned by Debug mode are not writable outside it
+    if(t->dmode && !inDebugMode(riscv)) {
+        // no action
+    } else if(index==1) {
+        writeTData1(riscv, t, newValue);
+        refreshTrigger(riscv, &old, t);
+    } else if(index==2) {
+        t->tdata2 = newValue & getXLENMask(riscv);
+        refreshTrigger(riscv, &old, t);
+    }
+
+    return riscvTriggerReadTData(riscv, index);
+}
+
+//
+// Does any enabled execute trigger match the instruction being translated in
+// the current mode?
+//
+Bool riscvTriggerExecuteMatch(riscvP riscv, Uns64 thisPC, Uns32 instruction) {
+
+    riscvTriggerP tr   = riscv->trigger;
+    riscvMode     mode = getCurrentMode(riscv);
+    Uns32         i;
+
+    for(i=0; tr && (i<tr->num); i++) {
+        if(matchExecute(&tr->triggers[i], mode, thisPC, instruction)) {
+            return True;
+        }
+    }
+
+    return False;
+}
+
+//
+// Fire execute triggers matching the instruction before it executes (timing
+// 0, so the instruction does not execute)
+//
+void riscvTriggerExecute(riscvP riscv, Uns64 thisPC, Uns32 instruction) {
+
+    riscvTriggerP tr    = riscv->trigger;
+    riscvMode     mode  = getCurrentMode(riscv);
+    Bool          fired = False;
+    Bool          debug = False;
+    Uns32         i;
+
+    for(i=0; i<tr->num; i++) {
+
+        triggerP t = &tr->triggers[i];
+
+        if(matchExecute(t, mode, thisPC, instruction)) {
+            t->hit = True;
+            fired  = True;
+            debug |= (t->action==TA_DEBUG);
+        }
+    }
+
+    // Debug mode entry takes priority over breakpoint exception
+    if(fired) {
+        riscvTakeTriggerAction(riscv, debug, thisPC);
+    }
+}
+
+//
+// Note a trap for itrigger and etrigger triggers; the action is taken before
+// the first instruction of the trap handler
+//
+void riscvTriggerTrap(riscvP riscv, Bool isInt, Uns32 ecode, riscvMode modeY) {
+
+    riscvTriggerP tr   = riscv->trigger;
+    triggerType   type = isInt ? TT_ITRIGGER : TT_ETRIGGER;
+    Uns32         i;
+
+    for(i=0; i<tr->num; i++) {
+
+        triggerP t = &tr->triggers[i];
+
+        if(
+            (t->type==type) &&
+            enabledInMode(t, modeY) &&
+            (ecode<64) &&
+            (t->tdata2 & (1ULL<<ecode))
+        ) {
+            setPending(riscv, t, 0);
+        }
+    }
+}
+
+//
+// Refresh instruction count triggers after a mode change (counting applies
+// only to enabled modes)
+//
+void riscvTriggerRefreshMode(riscvP riscv) {
+    updateICount(riscv);
+}
+
+//
+// Is a trigger action pending?
+//
+Bool riscvTriggerPending(riscvP riscv) {
+
+    riscvTriggerP tr = riscv->trigger;
+
+    return tr && tr->pending;
+}
+
+//
+// Take any pending trigger action
+//
+void riscvTriggerTakePending(riscvP riscv) {
+
+    riscvTriggerP tr = riscv->trigger;
+
+    tr->pending = False;
+
+    riscvTakeTriggerAction(riscv, tr->pendAction==TA_DEBUG, tr->pendTval);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// SAVE/RESTORE SUPPORT
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Save/restore field keys
+//
+#define RV_TRIGGERS "triggers"
+
+//
+// Save trigger state not covered by register read/write API
+//
+void riscvTriggerSave(
+    riscvP              riscv,
+    vmiSaveContextP     cxt,
+    vmiSaveRestorePhase phase
+) {
+    riscvTriggerP tr = riscv->trigger;
+
+    if(tr && (phase==SRT_END_CORE)) {
+
+        // bring instruction counts up to date
+        syncICount(riscv);
+
+        vmirtSave(cxt, RV_TRIGGERS, tr->triggers, tr->num*sizeof(trigger));
+        VMIRT_SAVE_FIELD(cxt, tr, tselect);
+        VMIRT_SAVE_FIELD(cxt, tr, pending);
+        VMIRT_SAVE_FIELD(cxt, tr, pendAction);
+        VMIRT_SAVE_FIELD(cxt, tr, pendTval);
+    }
+}
+
+//
+// Restore trigger state not covered by register read/write API
+//
+void riscvTriggerRestore(
+    riscvP              riscv,
+    vmiRestoreContextP  cxt,
+    vmiSaveRestorePhase phase
+) {
+    riscvTriggerP tr = riscv->trigger;
+
+    if(tr && (phase==SRT_END_CORE)) {
+
+        vmirtRestore(cxt, RV_TRIGGERS, tr->triggers, tr->num*sizeof(trigger));
+        VMIRT_RESTORE_FIELD(cxt, tr, tselect);
+        VMIRT_RESTORE_FIELD(cxt, tr, pending);
+        VMIRT_RESTORE_FIELD(cxt, tr, pendAction);
+        VMIRT_RESTORE_FIELD(cxt, tr, pendTval);
+
+        // discard code translated with previous execute triggers
+        vmirtFlushAllDicts((vmiProcessorP)riscv);
+
+        // refresh memory watches and instruction count timer
+        refreshWatches(riscv);
+        tr->icountBase = vmirtGetICount((vmiProcessorP)riscv);
+        restartICount(riscv);
+    }
+}
+
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+// basic types
+#include "hostapi/impTypes.h"
+
+// model header files
+#include "riscvMode.h"
+#include "riscvTypeRefs.h"
+
+
+//
+// Allocate debug trigger structures if required
+//
+void riscvNewTrigger(riscvP riscv);
+
+//
+// Free debug trigger structures
+//
+void riscvFreeTrigger(riscvP riscv);
+
+//
+// Reset all triggers
+//
+void riscvTriggerReset(riscvP riscv);
+
+//
+// Read tselect
+//
+Uns64 riscvTriggerReadTSelect(riscvP riscv);
+
+//
+// Write tselect
+//
+Uns64 riscvTriggerWriteTSelect(riscvP riscv, Uns64 newValue);
+
+//
+// Read tdata1-tdata3 for the selected trigger (index 1-3)
+//
+Uns64 riscvTriggerReadTData(riscvP riscv, Uns32 index);
+
+//
+// Write tdata1-tdata3 for the selected trigger (index 1-3)
+//
+Uns64 riscvTriggerWriteTData(riscvP riscv, Uns32 index, Uns64 newValue);
+
+//
+// Does any enabled execute trigger match the instruction being translated in
+// the current mode?
+//
+Bool riscvTriggerExecuteMatch(riscvP riscv, Uns64 thisPC, Uns32 instruction);
+
+//
+// Fire execute triggers matching the instruction before it executes
+//
+void riscvTriggerExecute(riscvP riscv, Uns64 thisPC, Uns32 instruction);
+
+//
+// Note a trap for itrigger and etrigger triggers
+//
+void riscvTriggerTrap(riscvP riscv, Bool isInt, Uns32 ecode, riscvMode modeY);
+
+//
+// Refresh instruction count triggers after a mode change
+//
+void riscvTriggerRefreshMode(riscvP riscv);
+
+//
+// Is a trigger action pending?
+//
+Bool riscvTriggerPending(riscvP riscv);
+
+//
+// Take any pending trigger action
+//
+void riscvTriggerTakePending(riscvP riscv);
+
+//
+// Save trigger state not covered by register read/write API
+//
+void riscvTriggerSave(
+    riscvP              riscv,
+    vmiSaveContextP     cxt,
+    vmiSaveRestorePhase phase
+);
+
+//
+// Restore trigger state not covered by register read/write API
+//
+void riscvTriggerRestore(
+    riscvP              riscv,
+    vmiRestoreContextP  cxt,
+    vmiSaveRestorePhase phase
+);
+
@@ -24,7 +24,10 @@
 
 DEFINE_S (riscv);
 DEFINE_S (riscvBlockState);
+DEFINE_S (riscvBranch);
 DEFINE_S (riscvBusPort);
+DEFINE_S (riscvCache);
+DEFINE_S (riscvCosim);
 DEFINE_U (riscvCLICIntState);
 DEFINE_S (riscvCLICOutState);
 DEFINE_S (riscvCSRRemap);
@@ -35,16 +38,24 @@ DEFINE_CS(riscvCSRAttrs);
 DEFINE_S (riscvExceptionDesc);
 DEFINE_CS(riscvExceptionDesc);
 DEFINE_S (riscvExtCB);
+DEFINE_S (riscvFault);
 DEFINE_CS(riscvExtConfig);
 DEFINE_CS(riscvExtInstrAttrs);
 DEFINE_S (riscvExtInstrInfo);
 DEFINE_CS(riscvExtMorphAttr);
 DEFINE_S (riscvExtMorphState);
 DEFINE_S (riscvInstrInfo);
+DEFINE_S (riscvMixBlock);
 DEFINE_S (riscvNetPort);
+DEFINE_S (riscvOpcodeMix);
 DEFINE_CS(riscvMorphAttr);
 DEFINE_S (riscvMorphState);
+DEFINE_S (riscvMorphStats);
 DEFINE_S (riscvParamValues);
 DEFINE_S (riscvPendEnab);
+DEFINE_S (riscvProfile);
+DEFINE_S (riscvRegGroups);
+DEFINE_S (riscvReplay);
 DEFINE_S (riscvTLB);
+DEFINE_S (riscvTrigger);
 
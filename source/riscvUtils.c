@@ -17,6 +17,9 @@
  *
  */
 
+// standard header files
+#include <string.h>
+
 // VMI header files
 #include "vmi/vmiCxt.h"
 #include "vmi/vmiMessage.h"
@@ -25,12 +28,14 @@
 
 // model header files
 #include "riscvBlockState.h"
+#include "riscvCache.h"
 #include "riscvDecode.h"
 #include "riscvExceptions.h"
 #include "riscvFunctions.h"
 #include "riscvMessage.h"
 #include "riscvMode.h"
 #include "riscvStructure.h"
+#include "riscvTrigger.h"
 #include "riscvUtils.h"
 #include "riscvVariant.h"
 #include "riscvVM.h"
@@ -357,9 +362,20 @@ void riscvSetMode(riscvP riscv, riscvMode mode) {
     // have changed while taking an exception even if mode has not changed)
     riscvVMRefreshMPRVDomain(riscv);
 
+    // the cache model filters repeated accesses by virtual address, which
+    // may now be mapped differently
+    if(riscv->cache) {
+        riscvCacheRefreshMapping(riscv);
+    }
+
     // set step breakpoint if required
     riscvSetStepBreakpoint(riscv);
 
+    // pause or resume instruction count triggers if required
+    if(riscv->trigger) {
+        riscvTriggerRefreshMode(riscv);
+    }
+
     // update active mode output signal (external CLIC)
     writeNet(riscv, riscv->sec_lvl_Handle, mode);
 }
@@ -570,6 +586,37 @@ vmiReg riscvGetVReg(riscvP riscv, Uns32 index) {
     return vmimtGetExtReg((vmiProcessorP)riscv, value);
 }
 
+//
+// Complete any deferred tail zeroing of the indexed vector register below the
+// given byte offset
+//
+void riscvVZeroPending(riscvP riscv, Uns32 index, Uns32 end) {
+
+    Uns32 vRegBytes = riscv->configInfo.VLEN/8;
+    Uns32 mask      = 1<<index;
+    Uns32 from      = riscv->vZeroFrom[index];
+
+    // clamp to register size
+    if(end>vRegBytes) {
+        end = vRegBytes;
+    }
+
+    if((riscv->vZeroPending & mask) && (from<end)) {
+
+        Uns8 *vBytes = (Uns8 *)&riscv->v[index*vRegBytes/4];
+
+        // zero the part of the deferred tail that is now observed
+        memset(&vBytes[from], 0, end-from);
+
+        // either reduce or remove the deferred tail
+        if(end<vRegBytes) {
+            riscv->vZeroFrom[index] = end;
+        } else {
+            riscv->vZeroPending &= ~mask;
+        }
+    }
+}
+
 //
 // Return index for the first feature identified by the given feature id
 //
@@ -676,17 +723,34 @@ static VMI_MEM_WATCH_FN(abortEA) {
 //
 static void updateExclusiveAccessCallback(riscvP riscv, Bool install) {
 
-    memDomainP domain  = vmirtGetProcessorDataDomain((vmiProcessorP)riscv);
-    Uns32      bits    = vmirtGetDomainAddressBits(domain);
-    Uns64      mask    = (bits==64) ? -1 : ((1ULL<<bits)-1);
-    Uns64      simLow  = mask & riscv->exclusiveTag;
-    Uns64      simHigh = mask & (simLow + ~riscv->exclusiveTagMask);
-
-    // install or remove a watchpoint on the current exclusive access address
+    // the monitor is installed on the domain used by explicit loads and stores
+    // (the mstatus.MPRV domain, if that is selected by the polymorphic key in
+    // Machine mode) and removed from the domain on which it was installed
     if(install) {
-        vmirtAddWriteCallback(domain, 0, simLow, simHigh, abortEA, riscv);
-    } else {
-        vmirtRemoveWriteCallback(domain, 0, simLow, simHigh, abortEA, riscv);
+        riscv->exclusiveDomain = (
+            riscvVMGetMPRVDomainMT(riscv) ? :
+            vmirtGetProcessorDataDomain((vmiProcessorP)riscv)
+        );
+    }
+
+    memDomainP domain = riscv->exclusiveDomain;
+
+    if(domain) {
+
+        Uns32 bits    = vmirtGetDomainAddressBits(domain);
+        Uns64 mask    = (bits==64) ? -1 : ((1ULL<<bits)-1);
+        Uns64 simLow  = mask & riscv->exclusiveTag;
+        Uns64 simHigh = mask & (simLow + ~riscv->exclusiveTagMask);
+
+        // install or remove a watchpoint on the current exclusive access
+        // address
+        if(install) {
+            vmirtAddWriteCallback(domain, 0, simLow, simHigh, abortEA, riscv);
+        } else {
+            vmirtRemoveWriteCallback(
+                domain, 0, simLow, simHigh, abortEA, riscv
+            );
+        }
     }
 }
 
@@ -123,6 +123,12 @@ const char *riscvGetVRegName(Uns32 index);
 //
 vmiReg riscvGetVReg(riscvP riscv, Uns32 index);
 
+//
+// Complete any deferred tail zeroing of the indexed vector register below the
+// given byte offset
+//
+void riscvVZeroPending(riscvP riscv, Uns32 index, Uns32 end);
+
 //
 // Get character identifier for the first feature identified by the given
 // feature id
@@ -31,6 +31,7 @@
 #include "vmi/vmiTypes.h"
 
 // Model header files
+#include "riscvBlockState.h"
 #include "riscvCLIC.h"
 #include "riscvExceptions.h"
 #include "riscvFunctions.h"
@@ -81,6 +82,9 @@ typedef struct tlbEntryS {
     // entry low physical address
     Uns64 PA;
 
+    // address of leaf page table entry from which the entry was created
+    Uns64 PTEAddr;
+
     // simulated ASID when mapped (including MSTATUS bits that affect it)
     riscvSimASID simASID;
 
@@ -103,12 +107,29 @@ typedef struct tlbEntryS {
 
 } tlbEntry;
 
+//
+// Number of entries in the artifact translation cache (must be a power of 2)
+//
+#define ARTIFACT_CACHE_SIZE 64
+
+//
+// Structure representing one entry in the artifact translation cache, holding
+// the result of a page table walk made by an artifact access (debugger or tool
+// access)
+//
+typedef struct artifactEntryS {
+    Bool     valid;         // whether the entry is valid
+    Uns64    satp;          // satp (mode, ASID and root table) at walk time
+    tlbEntry entry;         // translation from the page table walk
+} artifactEntry, *artifactEntryP;
+
 //
 // Structure representing a TLB
 //
 typedef struct riscvTLBS {
     vmiRangeTableP lut;     // range LUT entry (for fast lookup by address)
     tlbEntryP      free;    // list of free TLB entries available for reuse
+    artifactEntry  artifact[ARTIFACT_CACHE_SIZE];   // artifact translations
 } riscvTLB;
 
 //
@@ -400,6 +421,13 @@ inline static memDomainP getPTWDomain(riscvP riscv) {
     return getPMPDomainPriv(riscv, RISCV_MODE_SUPERVISOR, MEM_PRIV_RW);
 }
 
+//
+// Return the size of a page table entry in the current translation mode
+//
+inline static Uns32 getPTEBytes(riscvP riscv) {
+    return (RD_CSR_FIELD(riscv, satp, MODE)==VAM_Sv32) ? 4 : 8;
+}
+
 //
 // Read an entry from a page table (returning invalid all-zero entry if the
 // lookup fails)
@@ -748,8 +776,9 @@ static riscvException tlbLookupSv32(
     entry->lowVA  = VA.raw & -size;
     entry->highVA = entry->lowVA + size - 1;
 
-    // fill TLB entry low physical address
-    entry->PA = PA.raw;
+    // fill TLB entry low physical address and leaf entry address
+    entry->PA      = PA.raw;
+    entry->PTEAddr = PTEAddr;
 
     // fill TLB entry attributes
     entry->priv = PTE.fields.priv;
@@ -940,8 +969,9 @@ static riscvException tlbLookupSv39(
     entry->lowVA  = VA.raw & -size;
     entry->highVA = entry->lowVA + size - 1;
 
-    // fill TLB entry low physical address
-    entry->PA = PA.raw;
+    // fill TLB entry low physical address and leaf entry address
+    entry->PA      = PA.raw;
+    entry->PTEAddr = PTEAddr;
 
     // fill TLB entry attributes
     entry->priv = PTE.fields.priv;
@@ -1132,8 +1162,9 @@ static riscvException tlbLookupSv48(
     entry->lowVA  = VA.raw & -size;
     entry->highVA = entry->lowVA + size - 1;
 
-    // fill TLB entry low physical address
-    entry->PA = PA.raw;
+    // fill TLB entry low physical address and leaf entry address
+    entry->PA      = PA.raw;
+    entry->PTEAddr = PTEAddr;
 
     // fill TLB entry attributes
     entry->priv = PTE.fields.priv;
@@ -1500,6 +1531,28 @@ static tlbEntryP nextTLBEntryRange(
     return getTLBEntryForRange(riscv, tlb, lowVA, highVA, lutEntry);
 }
 
+//
+// Return the artifact translation cache entry for the passed VA
+//
+inline static artifactEntryP getArtifactEntry(riscvTLBP tlb, Uns64 VA) {
+    return &tlb->artifact[(VA>>RISCV_PAGE_SHIFT) & (ARTIFACT_CACHE_SIZE-1)];
+}
+
+//
+// Invalidate all entries in the artifact translation cache
+//
+static void invalidateArtifactCache(riscvTLBP tlb) {
+
+    if(tlb) {
+
+        Uns32 i;
+
+        for(i=0; i<ARTIFACT_CACHE_SIZE; i++) {
+            tlb->artifact[i].valid = False;
+        }
+    }
+}
+
 //
 // Delete TLB entries that overlap the passed range in the TLB
 //
@@ -1908,6 +1961,56 @@ static riscvException tlbLookup(
     return result;
 }
 
+//
+// Fill byref argument 'entry' from the artifact translation cache if it holds
+// a translation for the passed address made with the current satp that allows
+// the access, returning a boolean indicating whether this succeeded. Entries
+// needing a D bit update are never used, so that the page table walk decides
+// how these are handled.
+//
+static Bool artifactLookup(
+    riscvP    riscv,
+    riscvTLBP tlb,
+    riscvMode mode,
+    tlbEntryP entry,
+    memPriv   requiredPriv
+) {
+    Uns64          VA = entry->lowVA;
+    artifactEntryP ae = getArtifactEntry(tlb, VA);
+    Bool           ok = (
+        ae->valid &&
+        (ae->satp==RD_CSR(riscv, satp)) &&
+        (VA>=ae->entry.lowVA) &&
+        (VA<=ae->entry.highVA) &&
+        (ae->entry.D || !(requiredPriv&MEM_PRIV_W)) &&
+        checkEntryPermission(riscv, mode, &ae->entry, requiredPriv)
+    );
+
+    if(ok) {
+        *entry = ae->entry;
+    }
+
+    return ok;
+}
+
+//
+// Record the result of a page table walk made by an artifact access in the
+// artifact translation cache
+//
+static void artifactFill(
+    riscvP    riscv,
+    riscvTLBP tlb,
+    Uns64     VA,
+    tlbEntryP entry
+) {
+
+    artifactEntryP ae = getArtifactEntry(tlb, VA);
+
+    ae->valid = True;
+    ae->satp  = RD_CSR(riscv, satp);
+    ae->entry = *entry;
+}
+
 //
 // Take exception on invalid access
 //
@@ -1922,6 +2025,90 @@ static void handleInvalidAccess(
     }
 }
 
+//
+// Return a raw page table entry in the current translation mode as an Sv39
+// entry (Sv48 entries have the same layout, and Sv32 entries differ only in
+// the width of the PPN field)
+//
+static Sv39Entry getPTEFields(riscvP riscv, Uns64 raw) {
+
+    Sv39Entry result = {raw:raw};
+
+    if(getPTEBytes(riscv)==4) {
+
+        Sv32Entry entry32 = {raw:raw};
+
+        result.fields.PPN = entry32.fields.PPN;
+        result.fields._u1 = 0;
+    }
+
+    return result;
+}
+
+//
+// Set the D bit in the leaf page table entry of a TLB entry that is written
+// for the first time, without repeating the page table walk. The leaf entry is
+// read again to check that it still matches the TLB entry and allows the
+// write. Returns False if the update cannot be done this way, in which case
+// the TLB entry must be discarded and the page table walk repeated.
+//
+static Bool updateEntryD(
+    riscvP         riscv,
+    tlbEntryP      entry,
+    memAccessAttrs attrs
+) {
+    memDomainP domain     = getPTWDomain(riscv);
+    Uns32      entryBytes = getPTEBytes(riscv);
+    Uns64      PTEAddr    = entry->PTEAddr;
+    Sv39Entry  PTE;
+
+    // artifact accesses must not modify page tables, and if the D bit is not
+    // updated by hardware the walk generates the page fault
+    if(riscv->artifactAccess || !updatePTED(riscv)) {
+        return False;
+    }
+
+    // read leaf entry again
+    PTE = getPTEFields(
+        riscv, readPageTableEntry(riscv, domain, PTEAddr, entryBytes, attrs)
+    );
+
+    // use the table walk if the entry cannot be read or has changed
+    if(
+        riscv->PTWBadAddr ||
+        !PTE.fields.V ||
+        !PTE.fields.A ||
+        (PTE.fields.priv != entry->priv) ||
+        (PTE.fields.U != entry->U) ||
+        (PTE.fields.PPN != (entry->PA>>RISCV_PAGE_SHIFT))
+    ) {
+        return False;
+    }
+
+    // write entry with D bit set
+    PTE.fields.D = 1;
+    writePageTableEntry(riscv, domain, PTEAddr, entryBytes, attrs, PTE.raw);
+
+    // use the table walk to report the error if the entry is not writable
+    if(riscv->PTWBadAddr) {
+        return False;
+    }
+
+    // existing mappings do not allow writes, so remove them
+    unmapTLBEntry(riscv, entry);
+
+    // entry is now dirty
+    entry->D = 1;
+
+    // emit debug if required
+    if(RISCV_DEBUG_MMU(riscv)) {
+        vmiPrintf("UPDATE TLB ENTRY D:\n");
+        dumpTLBEntry(riscv, entry);
+    }
+
+    return True;
+}
+
 //
 // Validate that the TLB entry has sufficient permissions
 //
@@ -1944,10 +2131,14 @@ static tlbEntryP validateTLBEntryPriv(
         // specified permissions are inadequate
         entry = 0;
 
-    } else if((requiredPriv&MEM_PRIV_W) && !entry->D) {
-
-        // writing using an entry not marked as dirty: discard the entry and
-        // reload it (will write the entry marked as dirty)
+    } else if(
+        (requiredPriv&MEM_PRIV_W) &&
+        !entry->D &&
+        !updateEntryD(riscv, entry, attrs)
+    ) {
+        // writing using an entry not marked as dirty that could not be updated
+        // in place: discard the entry and reload it (will write the entry
+        // marked as dirty)
         deleteTLBEntry(riscv, riscv->tlb, entry);
         entry = 0;
 
@@ -1965,6 +2156,103 @@ static tlbEntryP validateTLBEntryPriv(
     return entry;
 }
 
+//
+// Size of the block of page table entries read when prefilling the TLB
+//
+#define PTE_LINE_BYTES 64
+
+//
+// Extract page table entry with the given index from a line of entries
+//
+static Uns64 getLinePTE(
+    const Uns8 *line,
+    Uns32       index,
+    Uns32       entryBytes,
+    memEndian   endian
+) {
+    const Uns8 *bytes  = line + (index*entryBytes);
+    Uns64       result = 0;
+    Uns32       i;
+
+    for(i=0; i<entryBytes; i++) {
+
+        Uns32 byte = (endian==MEM_ENDIAN_BIG) ? i : entryBytes-1-i;
+
+        result = (result<<8) | bytes[byte];
+    }
+
+    return result;
+}
+
+//
+// Having created TLB entry 'walked' from a leaf page table entry at the lowest
+// level, create TLB entries for other valid leaf entries in the same line of
+// the page table. Entries are created only if they would not require hardware
+// update of A or D bits, so that these updates still happen when the page is
+// first accessed. Entries are mapped lazily, when they are first used.
+//
+static void prefillTLBEntries(
+    riscvP         riscv,
+    riscvTLBP      tlb,
+    tlbEntryP      walked,
+    memAccessAttrs attrs
+) {
+    Uns32      entryBytes = getPTEBytes(riscv);
+    Uns32      numPTEs    = PTE_LINE_BYTES/entryBytes;
+    Uns64      lineAddr   = walked->PTEAddr & -PTE_LINE_BYTES;
+    Uns32      walkIndex  = (walked->PTEAddr-lineAddr)/entryBytes;
+    Uns64      lineVA     = walked->lowVA - (walkIndex*RISCV_PAGE_SIZE);
+    memDomainP domain     = getPTWDomain(riscv);
+    memEndian  endian     = riscvGetDataEndian(riscv, RISCV_MODE_SUPERVISOR);
+    Uns8       line[PTE_LINE_BYTES];
+    Uns32      i;
+
+    // read the line of page table entries in PTW context
+    riscv->PTWActive  = True;
+    riscv->PTWBadAddr = False;
+    vmirtReadNByteDomain(domain, lineAddr, line, PTE_LINE_BYTES, 0, attrs);
+    riscv->PTWActive  = False;
+
+    // no action if the line is not readable
+    if(riscv->PTWBadAddr) {
+        return;
+    }
+
+    for(i=0; i<numPTEs; i++) {
+
+        Uns64     raw   = getLinePTE(line, i, entryBytes, endian);
+        Sv39Entry PTE   = getPTEFields(riscv, raw);
+        Uns64     lowVA = lineVA + (i*RISCV_PAGE_SIZE);
+        memPriv   priv  = PTE.fields.priv;
+
+        if(i==walkIndex) {
+            // entry created by the table walk
+        } else if(!PTE.fields.V || !priv) {
+            // invalid or non-leaf entry
+        } else if((priv&MEM_PRIV_RW) == MEM_PRIV_W) {
+            // reserved permission combination
+        } else if(!PTE.fields.A || ((priv&MEM_PRIV_W) && !PTE.fields.D)) {
+            // first access would require A or D bit update or fault
+        } else if(!findTLBEntry(riscv, tlb, lowVA)) {
+
+            tlbEntry tmp = {
+                lowVA   : lowVA,
+                highVA  : lowVA + RISCV_PAGE_SIZE - 1,
+                PA      : (Uns64)PTE.fields.PPN << RISCV_PAGE_SHIFT,
+                PTEAddr : lineAddr + (i*entryBytes),
+                simASID : getSimASID(riscv),
+                priv    : priv,
+                U       : PTE.fields.U,
+                G       : getG(riscv, PTE.fields.G),
+                A       : 1,
+                D       : PTE.fields.D,
+            };
+
+            allocateTLBEntry(riscv, tlb, &tmp, attrs);
+        }
+    }
+}
+
 //
 // Find or create a TLB entry for the passed VA
 //
@@ -1992,13 +2280,22 @@ static tlbEntryP findOrCreateTLBEntry(
 
         tlbEntry tmp;
 
+        riscvException exception = 0;
+
         // seed temporary entry
         initialEntry(&tmp, riscv, VA);
 
-        // do table walk
-        riscvException exception = tlbLookup(
-            riscv, mode, &tmp, requiredPriv, attrs
-        );
+        // artifact accesses use the artifact translation cache if possible,
+        // otherwise do table walk (recording the result of an artifact walk
+        // in the cache)
+        if(!riscv->artifactAccess) {
+            exception = tlbLookup(riscv, mode, &tmp, requiredPriv, attrs);
+        } else if(!artifactLookup(riscv, tlb, mode, &tmp, requiredPriv)) {
+            exception = tlbLookup(riscv, mode, &tmp, requiredPriv, attrs);
+            if(!exception) {
+                artifactFill(riscv, tlb, VA, &tmp);
+            }
+        }
 
         // do lookup
         if(exception) {
@@ -2007,6 +2304,16 @@ static tlbEntryP findOrCreateTLBEntry(
             entry = allocateTLBEntry(riscv, tlb, &tmp, attrs);
         }
 
+        // create TLB entries for neighbouring page table entries if required
+        if(
+            entry &&
+            riscv->configInfo.tlb_prefill &&
+            !entry->artifact &&
+            (entry->highVA-entry->lowVA+1 == RISCV_PAGE_SIZE)
+        ) {
+            prefillTLBEntries(riscv, tlb, entry, attrs);
+        }
+
         // validate permissions
         entry = validateTLBEntryPriv(
             riscv, mode, entry, requiredPriv, attrs, miP
@@ -2642,6 +2949,131 @@ static void mapPMA(
 // TLB / PMP UPDATE
 ////////////////////////////////////////////////////////////////////////////////
 
+//
+// Maximum size of a single VMI alias (4Gb)
+//
+#define VMI_PAGE_MAX 0x100000000ULL
+
+//
+// Maximum number of VMI_PAGE_MAX aliases created for a large page on a miss
+//
+#define MAP_TILES_MAX 16
+
+//
+// Maximum number of neighbouring TLB entries coalesced on each side of an
+// entry when it is mapped
+//
+#define COALESCE_MAX 16
+
+//
+// Return the privilege with which a TLB entry would be mapped in the given
+// mode (write privilege is discarded if the entry is not dirty)
+//
+static memPriv getEntryMapPriv(riscvP riscv, riscvMode mode, tlbEntryP entry) {
+
+    memPriv priv = checkEntryPermission(riscv, mode, entry, MEM_PRIV_NONE);
+
+    if(!entry->D) {
+        priv &= ~MEM_PRIV_W;
+    }
+
+    return priv;
+}
+
+//
+// Return any TLB entry adjacent to the range lowVA:highVA that can be mapped
+// with the same alias as 'entry': it must be physically contiguous with the
+// range and have the same ASID attributes and effective privilege
+//
+static tlbEntryP getCoalesceEntry(
+    riscvP    riscv,
+    riscvMode mode,
+    tlbEntryP entry,
+    Uns64     lowVA,
+    Uns64     highVA,
+    Uns64     VAtoPA,
+    memPriv   priv,
+    Bool      above
+) {
+    Uns64     VA = above ? highVA+1 : lowVA-1;
+    tlbEntryP n  = 0;
+
+    if(above ? (VA<=highVA) : (VA>=lowVA)) {
+
+        // address wraps
+
+    } else if(!(n=findTLBEntry(riscv, riscv->tlb, VA))) {
+
+        // no neighbouring entry
+
+    } else if((getEntryLowPA(n)-getEntryLowVA(n)) != VAtoPA) {
+
+        // neighbour is not physically contiguous
+        n = 0;
+
+    } else if((n->G!=entry->G) || (n->U!=entry->U)) {
+
+        // neighbour has different ASID attributes
+        n = 0;
+
+    } else if(getEntryMapPriv(riscv, mode, n) != priv) {
+
+        // neighbour has different effective privilege
+        n = 0;
+
+    } else if((highVA-lowVA+1) + (n->highVA-n->lowVA+1) > VMI_PAGE_MAX) {
+
+        // combined alias would be too large
+        n = 0;
+    }
+
+    return n;
+}
+
+//
+// Extend the range lowVA:highVA mapped for 'entry' to include contiguous
+// neighbouring TLB entries in the given mode, marking them as mapped
+//
+static void coalesceTLBEntries(
+    riscvP    riscv,
+    riscvMode mode,
+    tlbEntryP entry,
+    Uns64    *lowVAP,
+    Uns64    *highVAP,
+    Uns64     VAtoPA,
+    memPriv   priv
+) {
+    Uns32 above;
+
+    for(above=0; above<2; above++) {
+
+        tlbEntryP n;
+        Uns32     i;
+
+        for(
+            i=0;
+            (i<COALESCE_MAX) && (n=getCoalesceEntry(
+                riscv, mode, entry, *lowVAP, *highVAP, VAtoPA, priv, above
+            ));
+            i++
+        ) {
+            // unmap the neighbour in domains affected by any ASID change and
+            // give it the simulated ASID of the entry
+            unmapTLBEntryNewASID(riscv, n, entry->simASID);
+            n->simASID = entry->simASID;
+
+            // neighbour is now mapped in this mode
+            n->isMapped |= getModeMask(mode);
+
+            if(above) {
+                *highVAP = n->highVA;
+            } else {
+                *lowVAP  = n->lowVA;
+            }
+        }
+    }
+}
+
 //
 // Map memory virtual addresses in virtual domain to the specified range in the
 // corresponding PMP domain
@@ -2654,29 +3086,52 @@ static void mapTLBEntry(
     memPriv     requiredPriv,
     tlbMapInfoP miP
 ) {
-    memDomainP domainP    = getPMPDomainPriv(riscv, mode, requiredPriv);
-    Uns64      lowPA      = getEntryLowPA(entry);
-    Uns64      highPA     = getEntryHighPA(entry);
-    Uns64      lowVA      = getEntryLowVA(entry);
-    Uns32      ASIDMask   = getEntryASIDMask(entry, mode);
-    Uns32      ASID       = getEntrySimASID(entry);
-    memPriv    priv       = miP->priv;
-    Uns64      size       = highPA-lowPA+1;
-    Uns64      vmiPageMax = 0x100000000ULL;
-    Uns64      VAtoPA     = lowPA-lowVA;
-
-    // restrict mapping size to VMI maximum (4Gb)
-    if(size>vmiPageMax) {
-        size   = vmiPageMax;
-        lowVA  = miP->lowVA & -size;
-        lowPA  = lowVA + VAtoPA;
-        highPA = lowPA + size - 1;
+    memDomainP domainP  = getPMPDomainPriv(riscv, mode, requiredPriv);
+    Uns64      lowVA    = getEntryLowVA(entry);
+    Uns64      highVA   = getEntryHighVA(entry);
+    Uns32      ASIDMask = getEntryASIDMask(entry, mode);
+    Uns32      ASID     = getEntrySimASID(entry);
+    memPriv    priv     = miP->priv;
+    Uns64      VAtoPA   = getEntryLowPA(entry)-lowVA;
+    Uns64      size     = highVA-lowVA+1;
+    Uns64      tile;
+    Uns64      offset;
+    Uns64      lowPA;
+    Uns64      highPA;
+
+    if(size>VMI_PAGE_MAX) {
+
+        // a large page is mapped as a number of aliases of the VMI maximum
+        // size (4Gb), restricted to an aligned window containing the access
+        if(size>(VMI_PAGE_MAX*MAP_TILES_MAX)) {
+            size   = VMI_PAGE_MAX*MAP_TILES_MAX;
+            lowVA  = miP->lowVA & -size;
+            highVA = lowVA + size - 1;
+        }
+
+        tile = VMI_PAGE_MAX;
+
+    } else {
+
+        // a small page is mapped together with any contiguous neighbours
+        coalesceTLBEntries(
+            riscv, mode, entry, &lowVA, &highVA, VAtoPA, priv
+        );
+
+        tile = size = highVA-lowVA+1;
     }
 
     // create virtual mapping
-    vmirtAliasMemoryVM(
-        domainP, domainV, lowPA, highPA, lowVA, 0, priv, ASIDMask, ASID
-    );
+    for(offset=0; offset<size; offset+=tile) {
+
+        lowPA  = lowVA + offset + VAtoPA;
+        highPA = lowPA + tile - 1;
+
+        vmirtAliasMemoryVM(
+            domainP, domainV, lowPA, highPA, lowVA+offset, 0, priv,
+            ASIDMask, ASID
+        );
+    }
 
     // determine physical bounds of original access
     lowPA  = miP->lowVA  + VAtoPA;
@@ -2693,7 +3148,7 @@ static void mapTLBEntry(
 
     // indicate mapped range
     miP->lowVA  = lowVA;
-    miP->highVA = lowVA + size - 1;
+    miP->highVA = highVA;
 }
 
 //
@@ -2870,11 +3325,20 @@ static Uns32 maskASID(riscvP riscv, Uns32 ASID) {
     return ASID & getASIDMask(riscv);
 }
 
+//
+// Invalidate artifact translation cache (the cache is not architectural, so it
+// is discarded completely on any satp write or sfence.vma)
+//
+void riscvVMInvalidateArtifact(riscvP riscv) {
+    invalidateArtifactCache(riscv->tlb);
+}
+
 //
 // Invalidate entire TLB
 //
 void riscvVMInvalidateAll(riscvP riscv) {
     invalidateTLBEntriesRange(riscv, riscv->tlb, 0, RISCV_MAX_ADDR, MM_ANY, 0);
+    invalidateArtifactCache(riscv->tlb);
 }
 
 //
@@ -2883,6 +3347,7 @@ void riscvVMInvalidateAll(riscvP riscv) {
 void riscvVMInvalidateAllASID(riscvP riscv, Uns32 ASID) {
     ASID = maskASID(riscv, ASID);
     invalidateTLBEntriesRange(riscv, riscv->tlb, 0, RISCV_MAX_ADDR, MM_ASID, ASID);
+    invalidateArtifactCache(riscv->tlb);
 }
 
 //
@@ -2890,6 +3355,7 @@ void riscvVMInvalidateAllASID(riscvP riscv, Uns32 ASID) {
 //
 void riscvVMInvalidateVA(riscvP riscv, Uns64 VA) {
     invalidateTLBEntriesRange(riscv, riscv->tlb, VA, VA, MM_ANY, 0);
+    invalidateArtifactCache(riscv->tlb);
 }
 
 //
@@ -2898,6 +3364,91 @@ void riscvVMInvalidateVA(riscvP riscv, Uns64 VA) {
 void riscvVMInvalidateVAASID(riscvP riscv, Uns64 VA, Uns32 ASID) {
     ASID = maskASID(riscv, ASID);
     invalidateTLBEntriesRange(riscv, riscv->tlb, VA, VA, MM_ASID, ASID);
+    invalidateArtifactCache(riscv->tlb);
+}
+
+//
+// Inject a fault into any TLB entry for the given address by inverting the
+// given bit of its physical page number, returning False if there is no entry
+// or the bit is beyond the physical address size
+//
+Bool riscvVMInjectTLBFault(riscvP riscv, Uns64 VA, Uns32 bit) {
+
+    riscvTLBP tlb   = riscv->tlb;
+    Bool      bitOK = (bit+RISCV_PAGE_SHIFT) < riscv->extBits;
+    tlbEntryP entry = (tlb && bitOK) ? findTLBEntry(riscv, tlb, VA) : 0;
+
+    if(entry) {
+
+        // remove existing mappings so that the corrupted entry is used when
+        // the address is next accessed
+        unmapTLBEntry(riscv, entry);
+
+        entry->PA ^= 1ULL << (bit+RISCV_PAGE_SHIFT);
+    }
+
+    return entry ? True : False;
+}
+
+//
+// Return the physical address for a virtual address accessed using the given
+// domain (or the processor code or data domain if NULL), using any existing
+// TLB entry, or the address itself if the domain is not virtually mapped
+//
+Uns64 riscvVMGetPhysicalAddress(
+    riscvP     riscv,
+    memDomainP domain,
+    Uns64      VA,
+    Bool       isCode
+) {
+    vmiProcessorP processor = (vmiProcessorP)riscv;
+    riscvTLBP     tlb       = riscv->tlb;
+    tlbEntryP     entry     = 0;
+    Int32         mode;
+
+    // use the current code or data domain if none is given
+    if(domain) {
+        // no action
+    } else if(isCode) {
+        domain = vmirtGetProcessorCodeDomain(processor);
+    } else {
+        domain = vmirtGetProcessorDataDomain(processor);
+    }
+
+    // look for a TLB entry if the domain is virtually mapped
+    for(mode=RISCV_MODE_LAST-1; tlb && !entry && (mode>=0); mode--) {
+        if(getDomainType(riscv, domain, mode, isCode)==DT_VIRT) {
+            entry = findTLBEntry(riscv, tlb, VA);
+        }
+    }
+
+    return entry ? entry->PA + (VA-entry->lowVA) : VA;
+}
+
+//
+// Shift of effective data access mode in polymorphic key
+//
+#define PMK_MPRV_MODE_SHIFT 10
+
+//
+// Return the data domain for explicit accesses in the given mode
+//
+static memDomainP getModeDataDomain(riscvP riscv, riscvMode mode) {
+
+    memDomainP domain = 0;
+
+    // look for virtual domain for this mode if required
+    if(RD_CSR_FIELD(riscv, satp, MODE)) {
+        domain = riscv->vmDomains[mode][0];
+    }
+
+    // look for physical domain for this mode if MMU is not enabled or the
+    // domain is not VM-managed
+    if(!domain) {
+        domain = riscv->physDomains[mode][0];
+    }
+
+    return domain;
 }
 
 //
@@ -2905,10 +3456,10 @@ void riscvVMInvalidateVAASID(riscvP riscv, Uns64 VA, Uns32 ASID) {
 //
 void riscvVMRefreshMPRVDomain(riscvP riscv) {
 
-    // get current VM enable and mode
-    Bool       VM     = RD_CSR_FIELD(riscv, satp, MODE);
     riscvMode  mode   = getCurrentMode(riscv);
-    memDomainP domain = 0;
+    riscvMode  dmode  = mode;
+    Uns16      key    = 0;
+    memDomainP domain;
 
     // if mstatus.MPRV is set, use that mode
     if(getMPRV(riscv)) {
@@ -2933,29 +3484,82 @@ void riscvVMRefreshMPRVDomain(riscvP riscv) {
             );
         }
 
-        mode = modeMPP;
+        dmode = modeMPP;
     }
 
     // record data access mode (affects endianness)
-    riscv->dmode = mode;
+    riscv->dmode = dmode;
 
-    // look for virtual domain for this mode if required
-    if(VM) {
-        domain = riscv->vmDomains[mode][0];
-    }
+    if((dmode!=mode) && riscvVMUseMPRVKey(riscv)) {
 
-    // look for physical domain for this mode if MMU is not enabled or the
-    // domain is not VM-managed
-    if(!domain) {
-        domain = riscv->physDomains[mode][0];
+        // in Machine mode, loads and stores are translated to use the effective
+        // domain explicitly, selected by the polymorphic key, so the processor
+        // data domain remains the Machine mode domain
+        key = PMK_MPRV | (dmode<<PMK_MPRV_MODE_SHIFT);
+
+        if(RD_CSR_FIELD(riscv, satp, MODE)) {
+            key |= PMK_MPRV_VM;
+        }
+
+        domain = getModeDataDomain(riscv, mode);
+
+    } else {
+
+        // otherwise, use the effective domain as the processor data domain
+        domain = getModeDataDomain(riscv, dmode);
     }
 
+    // update mstatus.MPRV part of polymorphic key
+    riscv->pmKey = (riscv->pmKey & ~(PMK_MPRV|PMK_MPRV_MODE|PMK_MPRV_VM)) | key;
+
     // switch to the indicated domain if it is not current
     if(domain && (domain!=vmirtGetProcessorDataDomain((vmiProcessorP)riscv))) {
         vmirtSetProcessorDataDomain((vmiProcessorP)riscv, domain);
     }
 }
 
+//
+// Are loads and stores translated in the current mode sensitive to the
+// mstatus.MPRV polymorphic key?
+//
+Bool riscvVMUseMPRVKey(riscvP riscv) {
+    return (
+        (riscv->mode==RISCV_DMODE_MACHINE) &&
+        riscvHasMode(riscv, RISCV_MODE_USER)
+    );
+}
+
+//
+// Return the explicit data domain to use for loads and stores translated with
+// the current polymorphic key, or NULL if the processor data domain should be
+// used
+//
+memDomainP riscvVMGetMPRVDomainMT(riscvP riscv) {
+
+    memDomainP domain = 0;
+
+    if(riscv->pmKey & PMK_MPRV) {
+        domain = getModeDataDomain(riscv, riscv->dmode);
+    }
+
+    return domain;
+}
+
+//
+// Switch the processor data domain to the mstatus.MPRV domain (if enable is
+// True) or back to the current mode domain (if enable is False) around
+// accesses that cannot specify an explicit domain
+//
+void riscvVMSetMPRVDataDomain(riscvP riscv, Bool enable) {
+
+    riscvMode  mode   = enable ? riscv->dmode : getCurrentMode(riscv);
+    memDomainP domain = getModeDataDomain(riscv, mode);
+
+    if(domain && (domain!=vmirtGetProcessorDataDomain((vmiProcessorP)riscv))) {
+        vmirtSetProcessorDataDomain((vmiProcessorP)riscv, domain);
+    }
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // TLB SAVE/RESTORE SUPPORT
@@ -3050,6 +3654,7 @@ static void restoreVM(riscvP riscv, vmiRestoreContextP cxt) {
 
     if(tlb) {
         invalidateTLBEntriesRange(riscv, tlb, 0, RISCV_MAX_ADDR, MM_ANY, 0);
+        invalidateArtifactCache(tlb);
         restoreTLB(riscv, tlb, cxt);
     }
 }
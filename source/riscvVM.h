@@ -48,6 +48,11 @@ void riscvVMFree(riscvP riscv);
 //
 void riscvVMSetASID(riscvP riscv);
 
+//
+// Invalidate artifact translation cache
+//
+void riscvVMInvalidateArtifact(riscvP riscv);
+
 //
 // Invalidate entire TLB
 //
@@ -68,6 +73,25 @@ void riscvVMInvalidateVA(riscvP riscv, Uns64 VA);
 //
 void riscvVMInvalidateVAASID(riscvP riscv, Uns64 VA, Uns32 ASID);
 
+//
+// Inject a fault into any TLB entry for the given address by inverting the
+// given bit of its physical page number, returning False if there is no entry
+// or the bit is beyond the physical address size
+//
+Bool riscvVMInjectTLBFault(riscvP riscv, Uns64 VA, Uns32 bit);
+
+//
+// Return the physical address for a virtual address accessed using the given
+// domain (or the processor code or data domain if NULL), using any existing
+// TLB entry, or the address itself if the domain is not virtually mapped
+//
+Uns64 riscvVMGetPhysicalAddress(
+    riscvP     riscv,
+    memDomainP domain,
+    Uns64      VA,
+    Bool       isCode
+);
+
 //
 // Read the indexed PMP configuration register
 //
@@ -110,6 +134,25 @@ void riscvVMResetPMP(riscvP riscv);
 //
 void riscvVMRefreshMPRVDomain(riscvP riscv);
 
+//
+// Are loads and stores translated in the current mode sensitive to the
+// mstatus.MPRV polymorphic key?
+//
+Bool riscvVMUseMPRVKey(riscvP riscv);
+
+//
+// Return the explicit data domain to use for loads and stores translated with
+// the current polymorphic key, or NULL if the processor data domain should be
+// used
+//
+memDomainP riscvVMGetMPRVDomainMT(riscvP riscv);
+
+//
+// Switch the processor data domain to the mstatus.MPRV domain (if enable is
+// True) or back to the current mode domain (if enable is False)
+//
+void riscvVMSetMPRVDataDomain(riscvP riscv, Bool enable);
+
 //
 // Save VM state not covered by register read/write API
 //
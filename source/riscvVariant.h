@@ -259,6 +259,25 @@ typedef enum riscvDMModeE {
     RVDM_HALT,                          // Debug mode implemented as halt
 } riscvDMMode;
 
+//
+// Supported cache model replacement policies
+//
+typedef enum riscvCacheReplaceE {
+    RVCR_LRU,                           // least-recently-used (default)
+    RVCR_FIFO,                          // first-in, first-out
+    RVCR_RANDOM,                        // pseudo-random
+} riscvCacheReplace;
+
+//
+// Supported conditional branch predictor models
+//
+typedef enum riscvBranchPredictorE {
+    RVBP_NONE,                          // no predictor model (default)
+    RVBP_BIMODAL,                       // bimodal 2-bit counters
+    RVBP_GSHARE,                        // gshare global history
+    RVBP_TAGE,                          // simplified TAGE
+} riscvBranchPredictor;
+
 // macro returning User Architecture version
 #define RISCV_USER_VERSION(_P)      ((_P)->configInfo.user_version)
 
@@ -0,0 +1,1191 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+// standard header files
+#include <fenv.h>
+#include <math.h>
+#include <string.h>
+
+// host intrinsic header files
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// VMI header files
+#include "vmi/vmiTypes.h"
+
+// model header files
+#include "riscvCSR.h"
+#include "riscvStructure.h"
+#include "riscvVectorKernel.h"
+
+
+////////////////////////////////////////////////////////////////////////////////
+// HOST FLOATING POINT ENVIRONMENT
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// The floating point kernels run on the host FPU. They depend on these parts
+// of the host floating point environment:
+// - rounding mode, which is set from frm;
+// - exception flags, which are cleared before each kernel and read after it;
+// - flush-to-zero and denormals-are-zero modes (MXCSR FTZ/DAZ on x86 hosts),
+//   which are left as the simulator set them and instead made harmless: any
+//   denormal operand and any underflow (which is signalled when a result is
+//   flushed) cause a fall back to the per-element implementation.
+// The simulator environment is read once, at the first kernel call made by
+// the processor. Each call then loads the kernel environment derived from it
+// and loads the simulator environment again afterwards; on x86-64 hosts each
+// of these is a single MXCSR load. Host exception flags raised before the call
+// are not preserved: the simulator holds floating point flags in the processor
+// structure, and kernel calls are made with VMCA_FP_RESTORE.
+//
+// Kernels are called through function tables, so that the compiler cannot
+// move their floating point operations across the environment accesses; this
+// file must not be compiled with options that assume the default floating
+// point environment (for example, -ffast-math).
+//
+
+#if defined(__x86_64__)
+
+//
+// MXCSR fields
+//
+#define MXCSR_IE    0x0001      // invalid operation flag
+#define MXCSR_ZE    0x0004      // divide-by-zero flag
+#define MXCSR_OE    0x0008      // overflow flag
+#define MXCSR_UE    0x0010      // underflow flag
+#define MXCSR_PE    0x0020      // precision flag
+#define MXCSR_FLAGS 0x003f      // all exception flags
+#define MXCSR_MASKS 0x1f80      // all exception masks
+#define MXCSR_RC    0x6000      // rounding control
+
+#endif
+
+//
+// Return host rounding mode for the current frm, or -1 if there is no host
+// equivalent
+//
+static Int32 getHostRounding(riscvP riscv) {
+
+    static const Int32 map[8] = {
+#if defined(__x86_64__)
+        [0] = 0x0000,           // MXCSR.RC round to nearest
+        [1] = 0x6000,           // MXCSR.RC round toward zero
+        [2] = 0x2000,           // MXCSR.RC round down
+        [3] = 0x4000,           // MXCSR.RC round up
+#else
+        [0] = FE_TONEAREST,
+        [1] = FE_TOWARDZERO,
+        [2] = FE_DOWNWARD,
+        [3] = FE_UPWARD,
+#endif
+        [4] = -1,               // round to nearest, ties to max magnitude
+        [5] = -1,
+        [6] = -1,
+        [7] = -1
+    };
+
+    return map[RD_CSR_FIELD(riscv, fcsr, frm)];
+}
+
+//
+// Enter the kernel floating point environment with the given host rounding
+// mode, reading the simulator environment if this is the first kernel call
+//
+static void enterKernelFP(riscvP riscv, Int32 rounding) {
+
+#if defined(__x86_64__)
+
+    if(!riscv->vKernelHostValid) {
+        riscv->vKernelHostFP    = _mm_getcsr() & ~MXCSR_FLAGS;
+        riscv->vKernelHostValid = True;
+    }
+
+    // load rounding mode with exceptions masked and flags clear
+    _mm_setcsr((riscv->vKernelHostFP & ~MXCSR_RC) | MXCSR_MASKS | rounding);
+
+#else
+
+    if(!riscv->vKernelHostValid) {
+        riscv->vKernelHostFP    = fegetround();
+        riscv->vKernelHostValid = True;
+    }
+
+    feclearexcept(FE_ALL_EXCEPT);
+    fesetround(rounding);
+
+#endif
+}
+
+//
+// Leave the kernel floating point environment, returning the exceptions
+// raised by the kernel
+//
+static vmiFPFlags leaveKernelFP(riscvP riscv) {
+
+    vmiFPFlags flags = {bits:0};
+
+#if defined(__x86_64__)
+
+    Uns32 except = _mm_getcsr();
+
+    _mm_setcsr(riscv->vKernelHostFP);
+
+    flags.f.I = (except & MXCSR_IE) && True;
+    flags.f.Z = (except & MXCSR_ZE) && True;
+    flags.f.O = (except & MXCSR_OE) && True;
+    flags.f.U = (except & MXCSR_UE) && True;
+    flags.f.P = (except & MXCSR_PE) && True;
+
+#else
+
+    Int32 except = fetestexcept(FE_ALL_EXCEPT);
+
+    fesetround(riscv->vKernelHostFP);
+
+    flags.f.I = (except & FE_INVALID)   && True;
+    flags.f.Z = (except & FE_DIVBYZERO) && True;
+    flags.f.O = (except & FE_OVERFLOW)  && True;
+    flags.f.U = (except & FE_UNDERFLOW) && True;
+    flags.f.P = (except & FE_INEXACT)   && True;
+
+#endif
+
+    return flags;
+}
+
+//
+// Does the host support the F16C instructions used by half-precision kernels?
+//
+static Bool hostHasF16C(void) {
+
+#if defined(__x86_64__)
+    return __builtin_cpu_supports("f16c");
+#else
+    return False;
+#endif
+}
+
+//
+// Does the host support the AVX2 and FMA instructions used by unmasked
+// kernels?
+//
+static Bool hostHasAVX2(void) {
+
+#if defined(__x86_64__)
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+    return False;
+#endif
+}
+
+#if defined(__x86_64__)
+
+//
+// Attributes for functions using F16C instructions, which are called only if
+// hostHasF16C returns True, and AVX2 and FMA instructions, which are called
+// only if hostHasAVX2 also returns True
+//
+#define KERNEL_F16C __attribute__((target("f16c")))
+#define KERNEL_AVX2 __attribute__((target("avx2,fma,f16c")))
+
+#endif
+
+//
+// Attribute for functions using only baseline host instructions
+//
+#define KERNEL_BASE
+
+
+////////////////////////////////////////////////////////////////////////////////
+// UTILITIES
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Canonical NaN values
+//
+#define KERNEL_QNAN32 0x7fc00000
+#define KERNEL_QNAN64 0x7ff8000000000000ULL
+
+//
+// Is the Flt16 value a denormal or a NaN?
+//
+inline static Bool isSpecial16(Uns16 value) {
+
+    Uns16 abs = value & 0x7fff;
+
+    return (abs && (abs<0x0400)) || (abs>0x7c00);
+}
+
+//
+// Is the Flt32 value a denormal or a NaN?
+//
+inline static Bool isSpecial32(Uns32 value) {
+
+    Uns32 abs = value & 0x7fffffff;
+
+    return (abs && (abs<0x00800000)) || (abs>0x7f800000);
+}
+
+//
+// Is the Flt64 value a denormal or a NaN?
+//
+inline static Bool isSpecial64(Uns64 value) {
+
+    Uns64 abs = value & 0x7fffffffffffffffULL;
+
+    return (abs && (abs<0x0010000000000000ULL)) || (abs>0x7ff0000000000000ULL);
+}
+
+//
+// Return the host value of a Flt32 element
+//
+inline static float toHost32(Uns32 value) {
+    union {Uns32 u; float f;} u = {value};
+    return u.f;
+}
+
+//
+// Return the host value of a Flt64 element
+//
+inline static double toHost64(Uns64 value) {
+    union {Uns64 u; double f;} u = {value};
+    return u.f;
+}
+
+//
+// Return the Flt32 element for a host value, replacing a NaN with the
+// canonical NaN
+//
+inline static Uns32 fromHost32(float value) {
+    union {float f; Uns32 u;} u = {value};
+    return isnan(value) ? KERNEL_QNAN32 : u.u;
+}
+
+//
+// Return the Flt64 element for a host value, replacing a NaN with the
+// canonical NaN
+//
+inline static Uns64 fromHost64(double value) {
+    union {double f; Uns64 u;} u = {value};
+    return isnan(value) ? KERNEL_QNAN64 : u.u;
+}
+
+#if defined(__x86_64__)
+
+//
+// Return the host value of a Flt16 element (exact)
+//
+KERNEL_F16C inline static float toHost16(Uns16 value) {
+    return _cvtsh_ss(value);
+}
+
+//
+// Return the Flt16 element for a host value, rounded using the current
+// rounding mode, replacing a NaN with the canonical NaN (the canonical Flt32
+// NaN converts to the canonical Flt16 NaN)
+//
+KERNEL_F16C inline static Uns16 fromHost16(float value) {
+
+    if(isnan(value)) {
+        value = toHost32(KERNEL_QNAN32);
+    }
+
+    return _cvtss_sh(value, _MM_FROUND_CUR_DIRECTION);
+}
+
+#endif
+
+//
+// Return the indexed vector register
+//
+inline static void *getVReg(riscvP riscv, Uns32 index) {
+    return &riscv->v[index*(riscv->configInfo.VLEN/32)];
+}
+
+//
+// Is the indexed element active (selected by the mask, if any)?
+//
+inline static Bool isActive(riscvP riscv, riscvVKernelKey key, Uns32 i) {
+
+    Uns8  *mask = (Uns8 *)riscv->v;
+    Uns32  bit  = i*key.f.MLEN;
+
+    return !key.f.masked || ((mask[bit/8]>>(bit%8)) & 1);
+}
+
+//
+// Write the indexed mask element of a mask register (the least-significant
+// bit of the MLEN-bit field holds the value and other bits are zeroed)
+//
+static void setMaskElement(Uns8 *md, Uns32 MLEN, Uns32 i, Bool value) {
+
+    Uns32 bit = i*MLEN;
+
+    if(MLEN>=8) {
+        memset(&md[bit/8], 0, MLEN/8);
+        md[bit/8] = value;
+    } else {
+        Uns8 field = ((1<<MLEN)-1) << (bit%8);
+        md[bit/8]  = (md[bit/8] & ~field) | (value << (bit%8));
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// FLOATING POINT KERNELS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// Host floating point operations, giving the result for operands _A, _B and
+// _C (the destination element), using fused multiply-add function _F. For
+// vfmin/vfmax, operands are not NaNs, so the only case needing care is equal
+// zeros of opposite sign, for which -0.0 is less than +0.0. Compare results
+// are 0.0 or 1.0, written to the kernel buffer in place of a floating point
+// result (only whether the result is nonzero is used).
+//
+#define FLT_FADD(_F, _A, _B, _C)    ((_A) + (_B))
+#define FLT_FSUB(_F, _A, _B, _C)    ((_A) - (_B))
+#define FLT_FMUL(_F, _A, _B, _C)    ((_A) * (_B))
+#define FLT_FDIV(_F, _A, _B, _C)    ((_A) / (_B))
+#define FLT_FMACC(_F, _A, _B, _C)   _F( (_A), (_B),  (_C))
+#define FLT_FNMACC(_F, _A, _B, _C)  _F(-(_A), (_B), -(_C))
+#define FLT_FMSAC(_F, _A, _B, _C)   _F( (_A), (_B), -(_C))
+#define FLT_FNMSAC(_F, _A, _B, _C)  _F(-(_A), (_B),  (_C))
+#define FLT_FMIN(_F, _A, _B, _C) \
+    ((((_A)<(_B)) || (((_A)==(_B)) && signbit(_A))) ? (_A) : (_B))
+#define FLT_FMAX(_F, _A, _B, _C) \
+    ((((_A)>(_B)) || (((_A)==(_B)) && !signbit(_A))) ? (_A) : (_B))
+#define FLT_FEQ(_F, _A, _B, _C)     ((_A) == (_B))
+#define FLT_FLT(_F, _A, _B, _C)     ((_A) < (_B))
+
+//
+// Generate a floating point kernel for one operation and element size, with
+// the host result given by operation _OP (see above). Results are written to
+// the kernel buffer, not to the destination, so that no state is changed if
+// the kernel fails. The kernel fails if an operand of an active element is
+// denormal (the host may be treating denormals as zero, which RISC-V does not
+// allow) or a NaN (NaN propagation, and the signalling behavior of compares,
+// min/max and fused multiply-add, differ between the host and RISC-V). NaN
+// results are replaced with the canonical NaN. This kernel tests the mask and
+// operands element by element; it is used for masked operations, for hosts
+// without AVX2 and for the elements after the last whole AVX2 vector.
+//
+// Flt16 elements are converted to Flt32 for the operation and the result is
+// rounded to Flt16. For add, subtract, multiply and divide the Flt32 result
+// has at least 2p+2 bits (p being the Flt16 precision), so rounding twice
+// gives the correctly-rounded Flt16 result in every rounding mode; Flt16
+// operands are never denormal as Flt32, so host flush-to-zero modes do not
+// apply. This argument does not hold for fused multiply-add, which is not
+// implemented for Flt16.
+//
+#define FLT_KERNEL_FN(_NAME, _ATTR, _BITS, _FTYPE, _FMA, _USEC, _OP) \
+_ATTR static Bool _NAME(                                                    \
+    riscvP          riscv,                                                  \
+    riscvVKernelKey key,                                                    \
+    Uns32           vstart,                                                 \
+    Uns32           vl                                                      \
+) {                                                                         \
+    Uns##_BITS *s1 = getVReg(riscv, key.f.vA);                              \
+    Uns##_BITS *s2 = getVReg(riscv, key.f.vB);                              \
+    Uns##_BITS *s3 = getVReg(riscv, key.f.vd);                              \
+    Uns##_BITS *d  = (Uns##_BITS *)riscv->vKernelBuffer;                    \
+    Uns32       i;                                                          \
+                                                                            \
+    for(i=vstart; i<vl; i++) {                                              \
+                                                                            \
+        if(isActive(riscv, key, i)) {                                       \
+                                                                            \
+            Uns##_BITS ua = s1[i];                                          \
+            Uns##_BITS ub = s2[i];                                          \
+            Uns##_BITS uc = _USEC ? s3[i] : 0;                              \
+            _FTYPE     a  = toHost##_BITS(ua);                              \
+            _FTYPE     b  = toHost##_BITS(ub);                              \
+                                                                            \
+            if(                                                             \
+                isSpecial##_BITS(ua) ||                                     \
+                isSpecial##_BITS(ub) ||                                     \
+                isSpecial##_BITS(uc)                                        \
+            ) {                                                             \
+                return False;                                               \
+            }                                                               \
+                                                                            \
+            d[i] = fromHost##_BITS(_OP(_FMA, a, b, toHost##_BITS(uc)));     \
+        }                                                                   \
+    }                                                                       \
+                                                                            \
+    return True;                                                            \
+}
+
+//
+// Generate kernels for all unfused operations with the given element size
+//
+#define FLT_KERNEL_FNS(_A, _B, _T) \
+    FLT_KERNEL_FN(fadd##_B,   _A, _B, _T, 0, 0, FLT_FADD)                   \
+    FLT_KERNEL_FN(fsub##_B,   _A, _B, _T, 0, 0, FLT_FSUB)                   \
+    FLT_KERNEL_FN(fmul##_B,   _A, _B, _T, 0, 0, FLT_FMUL)                   \
+    FLT_KERNEL_FN(fdiv##_B,   _A, _B, _T, 0, 0, FLT_FDIV)                   \
+    FLT_KERNEL_FN(fmin##_B,   _A, _B, _T, 0, 0, FLT_FMIN)                   \
+    FLT_KERNEL_FN(fmax##_B,   _A, _B, _T, 0, 0, FLT_FMAX)                   \
+    FLT_KERNEL_FN(feq##_B,    _A, _B, _T, 0, 0, FLT_FEQ)                    \
+    FLT_KERNEL_FN(flt##_B,    _A, _B, _T, 0, 0, FLT_FLT)
+
+//
+// Generate kernels for all fused multiply-add operations with the given
+// element size
+//
+#define FLT_FUSED_KERNEL_FNS(_A, _B, _T, _FMA) \
+    FLT_KERNEL_FN(fmacc##_B,  _A, _B, _T, _FMA, 1, FLT_FMACC)               \
+    FLT_KERNEL_FN(fnmacc##_B, _A, _B, _T, _FMA, 1, FLT_FNMACC)              \
+    FLT_KERNEL_FN(fmsac##_B,  _A, _B, _T, _FMA, 1, FLT_FMSAC)               \
+    FLT_KERNEL_FN(fnmsac##_B, _A, _B, _T, _FMA, 1, FLT_FNMSAC)
+
+#if defined(__x86_64__)
+FLT_KERNEL_FNS(KERNEL_F16C, 16, float)
+#endif
+
+FLT_KERNEL_FNS(KERNEL_BASE, 32, float)
+FLT_KERNEL_FNS(KERNEL_BASE, 64, double)
+FLT_FUSED_KERNEL_FNS(KERNEL_BASE, 32, float,  fmaf)
+FLT_FUSED_KERNEL_FNS(KERNEL_BASE, 64, double, fma)
+
+#if defined(__x86_64__)
+
+//
+// Load eight Flt16 elements as Flt32 values, accumulating a mask of denormal
+// or NaN elements
+//
+KERNEL_AVX2 inline static __m256 avxLoad16(const Uns16 *p, __m256i *special) {
+
+    __m128i u    = _mm_loadu_si128((const __m128i *)p);
+    __m128i abs  = _mm_and_si128(u, _mm_set1_epi16(0x7fff));
+    __m128i zero = _mm_cmpeq_epi16(abs, _mm_setzero_si128());
+    __m128i den  = _mm_cmpgt_epi16(_mm_set1_epi16(0x0400), abs);
+    __m128i nan  = _mm_cmpgt_epi16(abs, _mm_set1_epi16(0x7c00));
+    __m128i bad  = _mm_or_si128(_mm_andnot_si128(zero, den), nan);
+
+    *special = _mm256_or_si256(*special, _mm256_cvtepi16_epi32(bad));
+
+    return _mm256_cvtph_ps(u);
+}
+
+//
+// Load eight Flt32 elements, accumulating a mask of denormal or NaN elements
+//
+KERNEL_AVX2 inline static __m256 avxLoad32(const Uns32 *p, __m256i *special) {
+
+    __m256i u    = _mm256_loadu_si256((const __m256i *)p);
+    __m256i abs  = _mm256_and_si256(u, _mm256_set1_epi32(0x7fffffff));
+    __m256i zero = _mm256_cmpeq_epi32(abs, _mm256_setzero_si256());
+    __m256i den  = _mm256_cmpgt_epi32(_mm256_set1_epi32(0x00800000), abs);
+    __m256i nan  = _mm256_cmpgt_epi32(abs, _mm256_set1_epi32(0x7f800000));
+
+    *special = _mm256_or_si256(*special, _mm256_andnot_si256(zero, den));
+    *special = _mm256_or_si256(*special, nan);
+
+    return _mm256_castsi256_ps(u);
+}
+
+//
+// Load four Flt64 elements, accumulating a mask of denormal or NaN elements
+//
+KERNEL_AVX2 inline static __m256d avxLoad64(const Uns64 *p, __m256i *special) {
+
+    __m256i u    = _mm256_loadu_si256((const __m256i *)p);
+    __m256i mag  = _mm256_set1_epi64x(0x7fffffffffffffffLL);
+    __m256i min  = _mm256_set1_epi64x(0x0010000000000000LL);
+    __m256i inf  = _mm256_set1_epi64x(0x7ff0000000000000LL);
+    __m256i abs  = _mm256_and_si256(u, mag);
+    __m256i zero = _mm256_cmpeq_epi64(abs, _mm256_setzero_si256());
+    __m256i den  = _mm256_cmpgt_epi64(min, abs);
+    __m256i nan  = _mm256_cmpgt_epi64(abs, inf);
+
+    *special = _mm256_or_si256(*special, _mm256_andnot_si256(zero, den));
+    *special = _mm256_or_si256(*special, nan);
+
+    return _mm256_castsi256_pd(u);
+}
+
+//
+// Store eight Flt32 results as Flt16 values rounded using the current rounding
+// mode, replacing NaNs with the canonical NaN
+//
+KERNEL_AVX2 inline static void avxStore16(Uns16 *p, __m256 r) {
+
+    __m256 qnan = _mm256_castsi256_ps(_mm256_set1_epi32(KERNEL_QNAN32));
+    __m256 nan  = _mm256_cmp_ps(r, r, _CMP_UNORD_Q);
+
+    r = _mm256_blendv_ps(r, qnan, nan);
+
+    _mm_storeu_si128(
+        (__m128i *)p, _mm256_cvtps_ph(r, _MM_FROUND_CUR_DIRECTION)
+    );
+}
+
+//
+// Store eight Flt32 results, replacing NaNs with the canonical NaN
+//
+KERNEL_AVX2 inline static void avxStore32(Uns32 *p, __m256 r) {
+
+    __m256 qnan = _mm256_castsi256_ps(_mm256_set1_epi32(KERNEL_QNAN32));
+    __m256 nan  = _mm256_cmp_ps(r, r, _CMP_UNORD_Q);
+
+    _mm256_storeu_ps((float *)p, _mm256_blendv_ps(r, qnan, nan));
+}
+
+//
+// Store four Flt64 results, replacing NaNs with the canonical NaN
+//
+KERNEL_AVX2 inline static void avxStore64(Uns64 *p, __m256d r) {
+
+    __m256d qnan = _mm256_castsi256_pd(_mm256_set1_epi64x(KERNEL_QNAN64));
+    __m256d nan  = _mm256_cmp_pd(r, r, _CMP_UNORD_Q);
+
+    _mm256_storeu_pd((double *)p, _mm256_blendv_pd(r, qnan, nan));
+}
+
+//
+// AVX2 operations on vectors of type _S (ps or pd), giving the result for
+// operand vectors _A, _B and _C (as for FLT_FADD etc). vfmin/vfmax select _A
+// if it is less (greater) than _B, or if the operands are equal and _A is
+// negative (positive). Compare results are all-ones masks, which are stored as
+// canonical NaNs (only whether the result is nonzero is used).
+//
+#define AVX_FADD(_S, _A, _B, _C)    _mm256_add_##_S(_A, _B)
+#define AVX_FSUB(_S, _A, _B, _C)    _mm256_sub_##_S(_A, _B)
+#define AVX_FMUL(_S, _A, _B, _C)    _mm256_mul_##_S(_A, _B)
+#define AVX_FDIV(_S, _A, _B, _C)    _mm256_div_##_S(_A, _B)
+#define AVX_FMACC(_S, _A, _B, _C)   _mm256_fmadd_##_S(_A, _B, _C)
+#define AVX_FNMACC(_S, _A, _B, _C)  _mm256_fnmsub_##_S(_A, _B, _C)
+#define AVX_FMSAC(_S, _A, _B, _C)   _mm256_fmsub_##_S(_A, _B, _C)
+#define AVX_FNMSAC(_S, _A, _B, _C)  _mm256_fnmadd_##_S(_A, _B, _C)
+#define AVX_FMIN(_S, _A, _B, _C) _mm256_blendv_##_S(_B, _A, _mm256_or_##_S( \
+    _mm256_cmp_##_S(_A, _B, _CMP_LT_OQ),                                    \
+    _mm256_and_##_S(_mm256_cmp_##_S(_A, _B, _CMP_EQ_OQ), _A)                \
+))
+#define AVX_FMAX(_S, _A, _B, _C) _mm256_blendv_##_S(_B, _A, _mm256_or_##_S( \
+    _mm256_cmp_##_S(_A, _B, _CMP_GT_OQ),                                    \
+    _mm256_andnot_##_S(_A, _mm256_cmp_##_S(_A, _B, _CMP_EQ_OQ))             \
+))
+#define AVX_FEQ(_S, _A, _B, _C)     _mm256_cmp_##_S(_A, _B, _CMP_EQ_OQ)
+#define AVX_FLT(_S, _A, _B, _C)     _mm256_cmp_##_S(_A, _B, _CMP_LT_OQ)
+
+//
+// Generate an AVX2 kernel for an unmasked operation, with the result given by
+// operation _OP on vectors of _LANES elements. Whole vectors are processed with
+// no per-element tests: denormal and NaN operands are accumulated in a mask
+// that is tested once at the end. Remaining elements are processed by the
+// scalar kernel _SCALAR.
+//
+#define AVX_KERNEL_FN(_NAME, _SCALAR, _BITS, _LANES, _VTYPE, _S, _OP) \
+KERNEL_AVX2 static Bool _NAME(                                              \
+    riscvP          riscv,                                                  \
+    riscvVKernelKey key,                                                    \
+    Uns32           vstart,                                                 \
+    Uns32           vl                                                      \
+) {                                                                         \
+    Uns##_BITS *s1      = getVReg(riscv, key.f.vA);                         \
+    Uns##_BITS *s2      = getVReg(riscv, key.f.vB);                         \
+    Uns##_BITS *d       = (Uns##_BITS *)riscv->vKernelBuffer;               \
+    __m256i     special = _mm256_setzero_si256();                           \
+    Uns32       i;                                                          \
+    Bool        ok;                                                         \
+                                                                            \
+    for(i=vstart; (i+_LANES)<=vl; i+=_LANES) {                              \
+                                                                            \
+        _VTYPE a = avxLoad##_BITS(&s1[i], &special);                        \
+        _VTYPE b = avxLoad##_BITS(&s2[i], &special);                        \
+                                                                            \
+        /* the destination is loaded only by operations that use it */      \
+        avxStore##_BITS(&d[i], _OP(_S, a, b, avxLoad##_BITS(                \
+            (Uns##_BITS *)getVReg(riscv, key.f.vd)+i, &special              \
+        )));                                                                \
+    }                                                                       \
+                                                                            \
+    ok = _mm256_testz_si256(special, special);                              \
+                                                                            \
+    /* avoid AVX to SSE transition penalties in the scalar kernel */        \
+    _mm256_zeroupper();                                                     \
+                                                                            \
+    return ok && _SCALAR(riscv, key, i, vl);                                \
+}
+
+//
+// Generate AVX2 kernels for all unfused operations with the given element size
+//
+#define AVX_KERNEL_FNS(_B, _L, _V, _S) \
+    AVX_KERNEL_FN(avxFadd##_B,   fadd##_B,   _B, _L, _V, _S, AVX_FADD)      \
+    AVX_KERNEL_FN(avxFsub##_B,   fsub##_B,   _B, _L, _V, _S, AVX_FSUB)      \
+    AVX_KERNEL_FN(avxFmul##_B,   fmul##_B,   _B, _L, _V, _S, AVX_FMUL)      \
+    AVX_KERNEL_FN(avxFdiv##_B,   fdiv##_B,   _B, _L, _V, _S, AVX_FDIV)      \
+    AVX_KERNEL_FN(avxFmin##_B,   fmin##_B,   _B, _L, _V, _S, AVX_FMIN)      \
+    AVX_KERNEL_FN(avxFmax##_B,   fmax##_B,   _B, _L, _V, _S, AVX_FMAX)      \
+    AVX_KERNEL_FN(avxFeq##_B,    feq##_B,    _B, _L, _V, _S, AVX_FEQ)       \
+    AVX_KERNEL_FN(avxFlt##_B,    flt##_B,    _B, _L, _V, _S, AVX_FLT)
+
+//
+// Generate AVX2 kernels for all fused multiply-add operations with the given
+// element size
+//
+#define AVX_FUSED_KERNEL_FNS(_B, _L, _V, _S) \
+    AVX_KERNEL_FN(avxFmacc##_B,  fmacc##_B,  _B, _L, _V, _S, AVX_FMACC)     \
+    AVX_KERNEL_FN(avxFnmacc##_B, fnmacc##_B, _B, _L, _V, _S, AVX_FNMACC)    \
+    AVX_KERNEL_FN(avxFmsac##_B,  fmsac##_B,  _B, _L, _V, _S, AVX_FMSAC)     \
+    AVX_KERNEL_FN(avxFnmsac##_B, fnmsac##_B, _B, _L, _V, _S, AVX_FNMSAC)
+
+AVX_KERNEL_FNS(16, 8, __m256,  ps)
+AVX_KERNEL_FNS(32, 8, __m256,  ps)
+AVX_KERNEL_FNS(64, 4, __m256d, pd)
+AVX_FUSED_KERNEL_FNS(32, 8, __m256,  ps)
+AVX_FUSED_KERNEL_FNS(64, 4, __m256d, pd)
+
+//
+// Table entries for kernels of all element sizes and of Flt32 and Flt64 only
+//
+#define FLT_KERNEL_ENTRY(_NAME)       {_NAME##16, _NAME##32, _NAME##64}
+#define FLT_FUSED_KERNEL_ENTRY(_NAME) {0,         _NAME##32, _NAME##64}
+#define AVX_KERNEL_ENTRY(_NAME)       {_NAME##16, _NAME##32, _NAME##64}
+#define AVX_FUSED_KERNEL_ENTRY(_NAME) {0,         _NAME##32, _NAME##64}
+
+#else
+
+//
+// Flt16 and AVX2 kernels are not available on this host
+//
+#define FLT_KERNEL_ENTRY(_NAME)       {0, _NAME##32, _NAME##64}
+#define FLT_FUSED_KERNEL_ENTRY(_NAME) {0, _NAME##32, _NAME##64}
+#define AVX_KERNEL_ENTRY(_NAME)       {0, 0, 0}
+#define AVX_FUSED_KERNEL_ENTRY(_NAME) {0, 0, 0}
+
+#endif
+
+//
+// Type of floating point kernel function
+//
+typedef Bool (*fltKernelFn)(
+    riscvP          riscv,
+    riscvVKernelKey key,
+    Uns32           vstart,
+    Uns32           vl
+);
+
+//
+// Floating point kernels, indexed by operation and by log2(SEW/16)
+//
+static const fltKernelFn fltKernels[RVVK_LAST][3] = {
+    [RVVK_FADD]   = FLT_KERNEL_ENTRY(fadd),
+    [RVVK_FSUB]   = FLT_KERNEL_ENTRY(fsub),
+    [RVVK_FMUL]   = FLT_KERNEL_ENTRY(fmul),
+    [RVVK_FDIV]   = FLT_KERNEL_ENTRY(fdiv),
+    [RVVK_FMACC]  = FLT_FUSED_KERNEL_ENTRY(fmacc),
+    [RVVK_FNMACC] = FLT_FUSED_KERNEL_ENTRY(fnmacc),
+    [RVVK_FMSAC]  = FLT_FUSED_KERNEL_ENTRY(fmsac),
+    [RVVK_FNMSAC] = FLT_FUSED_KERNEL_ENTRY(fnmsac),
+    [RVVK_FMIN]   = FLT_KERNEL_ENTRY(fmin),
+    [RVVK_FMAX]   = FLT_KERNEL_ENTRY(fmax),
+    [RVVK_FEQ]    = FLT_KERNEL_ENTRY(feq),
+    [RVVK_FLT]    = FLT_KERNEL_ENTRY(flt),
+};
+
+//
+// AVX2 kernels for unmasked operations, indexed by operation and by
+// log2(SEW/16)
+//
+static const fltKernelFn avxKernels[RVVK_LAST][3] = {
+    [RVVK_FADD]   = AVX_KERNEL_ENTRY(avxFadd),
+    [RVVK_FSUB]   = AVX_KERNEL_ENTRY(avxFsub),
+    [RVVK_FMUL]   = AVX_KERNEL_ENTRY(avxFmul),
+    [RVVK_FDIV]   = AVX_KERNEL_ENTRY(avxFdiv),
+    [RVVK_FMACC]  = AVX_FUSED_KERNEL_ENTRY(avxFmacc),
+    [RVVK_FNMACC] = AVX_FUSED_KERNEL_ENTRY(avxFnmacc),
+    [RVVK_FMSAC]  = AVX_FUSED_KERNEL_ENTRY(avxFmsac),
+    [RVVK_FNMSAC] = AVX_FUSED_KERNEL_ENTRY(avxFnmsac),
+    [RVVK_FMIN]   = AVX_KERNEL_ENTRY(avxFmin),
+    [RVVK_FMAX]   = AVX_KERNEL_ENTRY(avxFmax),
+    [RVVK_FEQ]    = AVX_KERNEL_ENTRY(avxFeq),
+    [RVVK_FLT]    = AVX_KERNEL_ENTRY(avxFlt),
+};
+
+//
+// Return the kernel for a floating point operation, or NULL if there is none
+// (Flt16 kernels require F16C conversions)
+//
+static fltKernelFn getFltKernel(riscvVKernelKey key) {
+
+    Uns32       index  = key.f.SEWShift-1;
+    fltKernelFn result = 0;
+
+    if(!key.f.SEWShift) {
+        // no action
+    } else if(!index && !hostHasF16C()) {
+        // no action
+    } else if(!key.f.masked && hostHasAVX2() && avxKernels[key.f.op][index]) {
+        result = avxKernels[key.f.op][index];
+    } else {
+        result = fltKernels[key.f.op][index];
+    }
+
+    return result;
+}
+
+//
+// Is the operation a compare with a mask register result?
+//
+inline static Bool isCompare(riscvVKernelKey key) {
+    return (key.f.op==RVVK_FEQ) || (key.f.op==RVVK_FLT);
+}
+
+//
+// Is the buffered kernel result nonzero?
+//
+static Bool isNonZero(const Uns8 *result, Uns32 bytes) {
+
+    Uns8  value = 0;
+    Uns32 i;
+
+    for(i=0; i<bytes; i++) {
+        value |= result[i];
+    }
+
+    return value && True;
+}
+
+//
+// Implement a floating point operation using a whole-register kernel
+//
+static Bool doFltKernel(riscvP riscv, riscvVKernelKey key) {
+
+    Int32       rounding = getHostRounding(riscv);
+    Uns32       vstart   = RD_CSR(riscv, vstart);
+    Uns32       vl       = RD_CSR(riscv, vl);
+    Uns32       bytes    = 1<<key.f.SEWShift;
+    fltKernelFn kernel   = getFltKernel(key);
+    Bool        ok       = False;
+    vmiFPFlags  except   = {bits:0};
+
+    if(kernel && (rounding!=-1)) {
+
+        // run the kernel with host exceptions cleared and rounding mode set
+        enterKernelFP(riscv, rounding);
+        ok     = kernel(riscv, key, vstart, vl);
+        except = leaveKernelFP(riscv);
+
+        // a tiny result may have been flushed to zero by the host, so use the
+        // element-by-element implementation for exact underflow behavior
+        ok = ok && !except.f.U;
+    }
+
+    if(!ok) {
+
+        // no action
+
+    } else if(isCompare(key)) {
+
+        Uns32  words = riscv->configInfo.VLEN/32;
+        Uns8  *md    = (Uns8 *)&riscv->v[key.f.vd*words];
+        Uns8  *buf   = riscv->vKernelBuffer;
+        Uns32  i;
+
+        // commit active mask results (compares raise no exceptions when no
+        // operand is a NaN)
+        for(i=vstart; i<vl; i++) {
+            if(isActive(riscv, key, i)) {
+                setMaskElement(
+                    md, key.f.MLEN, i, isNonZero(&buf[i*bytes], bytes)
+                );
+            }
+        }
+
+    } else {
+
+        Uns32       words = riscv->configInfo.VLEN/32;
+        Uns8       *fd    = (Uns8 *)&riscv->v[key.f.vd*words];
+        Uns8       *buf   = riscv->vKernelBuffer;
+        vmiFPFlags  flags = {bits:riscv->fpFlagsMT};
+        Uns32       i;
+
+        // commit active results (all results are active if unmasked)
+        if(key.f.masked) {
+            for(i=vstart; i<vl; i++) {
+                if(isActive(riscv, key, i)) {
+                    memcpy(&fd[i*bytes], &buf[i*bytes], bytes);
+                }
+            }
+        } else if(vl>vstart) {
+            memcpy(&fd[vstart*bytes], &buf[vstart*bytes], (vl-vstart)*bytes);
+        }
+
+        // accumulate exceptions for the whole instruction
+        flags.f.I |= except.f.I;
+        flags.f.Z |= except.f.Z;
+        flags.f.O |= except.f.O;
+        flags.f.P |= except.f.P;
+
+        riscv->fpFlagsMT = flags.bits;
+    }
+
+    return ok;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// MULTIPLY-ACCUMULATE KERNELS
+////////////////////////////////////////////////////////////////////////////////
+
+//
+// First operand of a multiply-accumulate kernel: a vector element (.vv) or the
+// scalar operand (.vx), which is already extended to 64 bits
+//
+#define MAC_VV(_TA) (((_TA *)getVReg(riscv, key.f.vA))[i])
+#define MAC_VX(_TA) ((_TA)scalar)
+
+//
+// Return the product of multiply-accumulate operands. Operands are converted to
+// the unsigned multiply type _TM (at least 32 bits, to avoid promotion to int)
+// so that the product is correct modulo the accumulator size for any
+// combination of operand signedness.
+//
+#define MAC_PRODUCT(_TD, _TM, _A, _B) \
+    ((_TD)((_TM)(_TD)(_A) * (_TM)(_TD)(_B)))
+
+//
+// Generate a widening integer multiply-accumulate kernel with first operand
+// given by _OPA. Unmasked operations use a loop with no per-element tests that
+// the compiler can vectorise.
+//
+#define MAC_KERNEL_FN(_NAME, _TA, _TB, _TD, _TM, _OPA) \
+static void _NAME(                                                          \
+    riscvP          riscv,                                                  \
+    riscvVKernelKey key,                                                    \
+    Uns64           scalar,                                                 \
+    Uns32           vstart,                                                 \
+    Uns32           vl                                                      \
+) {                                                                         \
+    _TB   *b = getVReg(riscv, key.f.vB);                                    \
+    _TD   *d = getVReg(riscv, key.f.vd);                                    \
+    Uns32  i;                                                               \
+                                                                            \
+    if(key.f.masked) {                                                      \
+        for(i=vstart; i<vl; i++) {                                          \
+            if(isActive(riscv, key, i)) {                                   \
+                d[i] += MAC_PRODUCT(_TD, _TM, _OPA(_TA), b[i]);             \
+            }                                                               \
+        }                                                                   \
+    } else {                                                                \
+        for(i=vstart; i<vl; i++) {                                          \
+            d[i] += MAC_PRODUCT(_TD, _TM, _OPA(_TA), b[i]);                 \
+        }                                                                   \
+    }                                                                       \
+}
+
+//
+// Generate .vv and .vx forms of a multiply-accumulate kernel
+//
+#define MAC_KERNEL_FNS(_NAME, _TA, _TB, _TD, _TM) \
+    MAC_KERNEL_FN(macVV##_NAME, _TA, _TB, _TD, _TM, MAC_VV)                 \
+    MAC_KERNEL_FN(macVX##_NAME, _TA, _TB, _TD, _TM, MAC_VX)
+
+//
+// Generate all signedness variants of a multiply-accumulate kernel
+//
+#define MAC_KERNEL_SHAPE(_SB, _DB, _TM) \
+    MAC_KERNEL_FNS(_SB##_##_DB##UU, Uns##_SB, Uns##_SB, Uns##_DB, _TM)      \
+    MAC_KERNEL_FNS(_SB##_##_DB##US, Uns##_SB, Int##_SB, Uns##_DB, _TM)      \
+    MAC_KERNEL_FNS(_SB##_##_DB##SU, Int##_SB, Uns##_SB, Uns##_DB, _TM)      \
+    MAC_KERNEL_FNS(_SB##_##_DB##SS, Int##_SB, Int##_SB, Uns##_DB, _TM)
+
+MAC_KERNEL_SHAPE( 8, 16, Uns32)
+MAC_KERNEL_SHAPE(16, 32, Uns32)
+MAC_KERNEL_SHAPE(32, 64, Uns64)
+MAC_KERNEL_SHAPE( 8, 32, Uns32)
+MAC_KERNEL_SHAPE(16, 64, Uns64)
+
+//
+// Table entries for .vv and .vx forms and all signedness variants of a
+// multiply-accumulate kernel
+//
+#define MAC_KERNEL_ENTRY_VX(_P, _S) { \
+    {_P##VV##_S##UU, _P##VV##_S##US},                                       \
+    {_P##VV##_S##SU, _P##VV##_S##SS}                                        \
+}, {                                                                        \
+    {_P##VX##_S##UU, _P##VX##_S##US},                                       \
+    {_P##VX##_S##SU, _P##VX##_S##SS}                                        \
+}
+#define MAC_KERNEL_ENTRY(_SB, _DB) {MAC_KERNEL_ENTRY_VX(mac, _SB##_##_DB)}
+
+#if defined(__x86_64__)
+
+//
+// Return an AVX2 vector of extended source elements of a multiply-accumulate
+// kernel, where _E is i (signed) or u (unsigned) and _LOAD loads the 128 or 64
+// bits that fill the vector when extended
+//
+#define AVX_MAC_EXTEND(_E, _SB, _DB, _LOAD, _P) \
+    _mm256_cvtep##_E##_SB##_epi##_DB(_LOAD((const __m128i *)(_P)))
+
+//
+// First operand of an AVX2 multiply-accumulate kernel: vector elements (.vv)
+// or the broadcast scalar operand (.vx)
+//
+#define AVX_MAC_VV(_E, _SB, _DB, _LOAD) \
+    AVX_MAC_EXTEND(_E, _SB, _DB, _LOAD, (Uns##_SB *)getVReg(riscv, key.f.vA)+i)
+#define AVX_MAC_VX(_E, _SB, _DB, _LOAD) \
+    avxBroadcast##_DB(scalar)
+
+//
+// Broadcast a scalar operand to all elements of an AVX2 vector
+//
+KERNEL_AVX2 inline static __m256i avxBroadcast16(Uns64 scalar) {
+    return _mm256_set1_epi16((Uns16)scalar);
+}
+KERNEL_AVX2 inline static __m256i avxBroadcast32(Uns64 scalar) {
+    return _mm256_set1_epi32((Uns32)scalar);
+}
+KERNEL_AVX2 inline static __m256i avxBroadcast64(Uns64 scalar) {
+    return _mm256_set1_epi64x(scalar);
+}
+
+//
+// Return the low half of the products of AVX2 vector elements
+//
+KERNEL_AVX2 inline static __m256i avxMullo16(__m256i a, __m256i b) {
+    return _mm256_mullo_epi16(a, b);
+}
+KERNEL_AVX2 inline static __m256i avxMullo32(__m256i a, __m256i b) {
+    return _mm256_mullo_epi32(a, b);
+}
+
+//
+// Return the low half of the products of 64-bit AVX2 vector elements (there
+// is no AVX2 instruction for this, so it is composed of 32x32 multiplies: the
+// product of the high halves does not contribute to the result)
+//
+KERNEL_AVX2 static __m256i avxMullo64(__m256i a, __m256i b) {
+
+    __m256i lo     = _mm256_mul_epu32(a, b);
+    __m256i crossA = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+    __m256i crossB = _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32));
+    __m256i cross  = _mm256_add_epi64(crossA, crossB);
+
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+}
+
+//
+// Generate an AVX2 kernel for an unmasked widening integer multiply-accumulate
+// with first operand given by _OPA. Source elements are extended to the
+// accumulator size before multiplication, because RISC-V multiply-accumulate
+// operations are elementwise (instructions such as pmaddubsw and vpdpbusd sum
+// adjacent products, so they do not apply). Remaining elements are processed
+// by the scalar kernel _SCALAR.
+//
+#define AVX_MAC_KERNEL_FN(_NAME, _SCALAR, _SB, _DB, _LOAD, _EA, _EB, _OPA) \
+KERNEL_AVX2 static void _NAME(                                              \
+    riscvP          riscv,                                                  \
+    riscvVKernelKey key,                                                    \
+    Uns64           scalar,                                                 \
+    Uns32           vstart,                                                 \
+    Uns32           vl                                                      \
+) {                                                                         \
+    Uns##_SB *b = getVReg(riscv, key.f.vB);                                 \
+    Uns##_DB *d = getVReg(riscv, key.f.vd);                                 \
+    Uns32     i;                                                            \
+                                                                            \
+    for(i=vstart; (i+256/_DB)<=vl; i+=256/_DB) {                            \
+                                                                            \
+        __m256i *pd = (__m256i *)&d[i];                                     \
+        __m256i  va = _OPA(_EA, _SB, _DB, _LOAD);                           \
+        __m256i  vb = AVX_MAC_EXTEND(_EB, _SB, _DB, _LOAD, &b[i]);          \
+        __m256i  vd = _mm256_loadu_si256(pd);                               \
+                                                                            \
+        vd = _mm256_add_epi##_DB(vd, avxMullo##_DB(va, vb));                \
+        _mm256_storeu_si256(pd, vd);                                        \
+    }                                                                       \
+                                                                            \
+    /* avoid AVX to SSE transition penalties in the scalar kernel */        \
+    _mm256_zeroupper();                                                     \
+                                                                            \
+    _SCALAR(riscv, key, scalar, i, vl);                                     \
+}
+
+//
+// Generate .vv and .vx forms of an AVX2 multiply-accumulate kernel
+//
+#define AVX_MAC_KERNEL_FNS(_NAME, _SB, _DB, _LOAD, _EA, _EB) \
+    AVX_MAC_KERNEL_FN(                                                      \
+        avxMacVV##_NAME, macVV##_NAME, _SB, _DB, _LOAD, _EA, _EB, AVX_MAC_VV \
+    )                                                                       \
+    AVX_MAC_KERNEL_FN(                                                      \
+        avxMacVX##_NAME, macVX##_NAME, _SB, _DB, _LOAD, _EA, _EB, AVX_MAC_VX \
+    )
+
+//
+// Generate all signedness variants of an AVX2 multiply-accumulate kernel
+//
+#define AVX_MAC_KERNEL_SHAPE(_SB, _DB, _LOAD) \
+    AVX_MAC_KERNEL_FNS(_SB##_##_DB##UU, _SB, _DB, _LOAD, u, u)              \
+    AVX_MAC_KERNEL_FNS(_SB##_##_DB##US, _SB, _DB, _LOAD, u, i)              \
+    AVX_MAC_KERNEL_FNS(_SB##_##_DB##SU, _SB, _DB, _LOAD, i, u)              \
+    AVX_MAC_KERNEL_FNS(_SB##_##_DB##SS, _SB, _DB, _LOAD, i, i)
+
+AVX_MAC_KERNEL_SHAPE( 8, 16, _mm_loadu_si128)
+AVX_MAC_KERNEL_SHAPE(16, 32, _mm_loadu_si128)
+AVX_MAC_KERNEL_SHAPE(32, 64, _mm_loadu_si128)
+AVX_MAC_KERNEL_SHAPE( 8, 32, _mm_loadl_epi64)
+AVX_MAC_KERNEL_SHAPE(16, 64, _mm_loadl_epi64)
+
+//
+// Table entry for all AVX2 multiply-accumulate kernel variants
+//
+#define AVX_MAC_KERNEL_ENTRY(_SB, _DB) { \
+    MAC_KERNEL_ENTRY_VX(avxMac, _SB##_##_DB)                                \
+}
+
+#else
+
+//
+// AVX2 kernels are not available on this host
+//
+#define AVX_MAC_KERNEL_ENTRY(_SB, _DB) {}
+
+#endif
+
+//
+// Type of multiply-accumulate kernel function
+//
+typedef void (*macKernelFn)(
+    riscvP          riscv,
+    riscvVKernelKey key,
+    Uns64           scalar,
+    Uns32           vstart,
+    Uns32           vl
+);
+
+//
+// Multiply-accumulate kernels, indexed by log2(SEW/8) of source and
+// destination, by whether the first operand is scalar and by signedness of
+// first and second operands
+//
+static const macKernelFn macKernels[4][4][2][2][2] = {
+    [0][1] = MAC_KERNEL_ENTRY( 8, 16),
+    [1][2] = MAC_KERNEL_ENTRY(16, 32),
+    [2][3] = MAC_KERNEL_ENTRY(32, 64),
+    [0][2] = MAC_KERNEL_ENTRY( 8, 32),
+    [1][3] = MAC_KERNEL_ENTRY(16, 64),
+};
+
+//
+// AVX2 multiply-accumulate kernels for unmasked operations, indexed as
+// macKernels
+//
+static const macKernelFn avxMacKernels[4][4][2][2][2] = {
+    [0][1] = AVX_MAC_KERNEL_ENTRY( 8, 16),
+    [1][2] = AVX_MAC_KERNEL_ENTRY(16, 32),
+    [2][3] = AVX_MAC_KERNEL_ENTRY(32, 64),
+    [0][2] = AVX_MAC_KERNEL_ENTRY( 8, 32),
+    [1][3] = AVX_MAC_KERNEL_ENTRY(16, 64),
+};
+
+//
+// Is the operation a widening integer multiply-accumulate?
+//
+inline static Bool isMAC(riscvVKernelKey key) {
+    return (key.f.op==RVVK_WMACC) || (key.f.op==RVVK_QMACC);
+}
+
+//
+// Return the kernel for a widening integer multiply-accumulate, or NULL if
+// there is none
+//
+static macKernelFn getMACKernel(riscvVKernelKey key) {
+
+    Uns32       srcShift = key.f.SEWShift;
+    Uns32       dstShift = srcShift + ((key.f.op==RVVK_QMACC) ? 2 : 1);
+    Uns32       sA       = key.f.signA;
+    Uns32       sB       = key.f.signB;
+    Uns32       vx       = key.f.scalarA;
+    macKernelFn result   = 0;
+
+    if(dstShift>=4) {
+        // no action
+    } else if(
+        !key.f.masked &&
+        hostHasAVX2() &&
+        avxMacKernels[srcShift][dstShift][vx][sA][sB]
+    ) {
+        result = avxMacKernels[srcShift][dstShift][vx][sA][sB];
+    } else {
+        result = macKernels[srcShift][dstShift][vx][sA][sB];
+    }
+
+    return result;
+}
+
+//
+// Implement a widening integer multiply-accumulate using a whole-register
+// kernel
+//
+static Bool doMACKernel(riscvP riscv, riscvVKernelKey key, Uns64 scalar) {
+
+    macKernelFn kernel = getMACKernel(key);
+
+    if(kernel) {
+        kernel(riscv, key, scalar, RD_CSR(riscv, vstart), RD_CSR(riscv, vl));
+    }
+
+    return kernel && True;
+}
+
+//
+// Is there a whole-register kernel for the operation on this host?
+//
+Bool riscvVectorKernelSupported(Uns32 keyBits) {
+
+    riscvVKernelKey key = {u32:keyBits};
+
+    if(isMAC(key)) {
+        return getMACKernel(key) && True;
+    } else {
+        return getFltKernel(key) && True;
+    }
+}
+
+//
+// Implement a vector operation on elements vstart to vl-1 using a whole-register
+// kernel, returning False with no state changed if the operation must instead
+// be performed element by element (called from JIT code). Argument scalar is
+// the extended first operand of .vx forms.
+//
+Bool riscvVectorKernel(riscvP riscv, Uns32 keyBits, Uns64 scalar) {
+
+    riscvVKernelKey key = {u32:keyBits};
+    Bool            ok  = False;
+
+    if(isMAC(key)) {
+        ok = doMACKernel(riscv, key, scalar);
+    } else {
+        ok = doFltKernel(riscv, key);
+    }
+
+    // indicate that all elements have been processed
+    if(ok) {
+        WR_CSR(riscv, vstart, RD_CSR(riscv, vl));
+    }
+
+    return ok;
+}
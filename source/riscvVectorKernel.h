@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2005-2020 Imperas Software Ltd., www.imperas.com
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ *
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#pragma once
+
+// basic types
+#include "hostapi/impTypes.h"
+
+// model header files
+#include "riscvTypeRefs.h"
+
+//
+// This enumerates operations implemented by whole-register kernels
+//
+typedef enum riscvVKernelOpE {
+    RVVK_NONE,          // no kernel
+    RVVK_FADD,          // vfadd.vv
+    RVVK_FSUB,          // vfsub.vv
+    RVVK_FMUL,          // vfmul.vv
+    RVVK_FDIV,          // vfdiv.vv
+    RVVK_WMACC,         // vwmacc*.vv/.vx (2*SEW accumulator)
+    RVVK_QMACC,         // vqmacc*.vv/.vx (4*SEW accumulator)
+    RVVK_FMACC,         // vfmacc.vv
+    RVVK_FNMACC,        // vfnmacc.vv
+    RVVK_FMSAC,         // vfmsac.vv
+    RVVK_FNMSAC,        // vfnmsac.vv
+    RVVK_FMIN,          // vfmin.vv
+    RVVK_FMAX,          // vfmax.vv
+    RVVK_FEQ,           // vmfeq.vv
+    RVVK_FLT,           // vmflt.vv
+    RVVK_LAST           // KEEP LAST: for sizing
+} riscvVKernelOp;
+
+//
+// Kernel operation and arguments, packed into a single JIT call argument
+//
+typedef union riscvVKernelKeyU {
+    Uns32 u32;
+    struct {
+        Uns32 op       : 4; // operation (riscvVKernelOp)
+        Uns32 SEWShift : 2; // log2(SEW/8) of source operands
+        Uns32 vd       : 5; // destination register
+        Uns32 vA       : 5; // first operand register
+        Uns32 vB       : 5; // second operand register
+        Uns32 MLEN     : 7; // mask element stride
+        Uns32 signA    : 1; // whether first operand is signed (integer)
+        Uns32 signB    : 1; // whether second operand is signed (integer)
+        Uns32 masked   : 1; // whether operation is masked
+        Uns32 scalarA  : 1; // whether first operand is scalar (integer .vx)
+    } f;
+} riscvVKernelKey;
+
+//
+// Is there a whole-register kernel for the operation on this host?
+//
+Bool riscvVectorKernelSupported(Uns32 key);
+
+//
+// Implement a vector operation on elements vstart to vl-1 using a whole-register
+// kernel, returning False with no state changed if the operation must instead
+// be performed element by element (called from JIT code). Argument scalar is
+// the extended first operand of .vx forms.
+//
+Bool riscvVectorKernel(riscvP riscv, Uns32 key, Uns64 scalar);
+